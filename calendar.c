@@ -0,0 +1,373 @@
+#include <stdlib.h>
+#include <string.h>
+
+// include the user library "clinic" for the Date/Time types and the slot grid
+#include "clinic.h"
+// include the user library "calendar" where the function prototypes are declared
+#include "calendar.h"
+
+//////////////////////////////////////
+// Internal macro's
+//////////////////////////////////////
+
+#define SLOTS_PER_HOUR (60 / MINUTE_INTERVAL)
+#define SLOTS_PER_DAY ((END_HOUR - START_HOUR) * SLOTS_PER_HOUR + 1)
+#define FULL_DAY_MASK ((1u << SLOTS_PER_DAY) - 1)
+
+//////////////////////////////////////
+// DAY TABLE
+//////////////////////////////////////
+
+// Find a day's entry (returns NULL if the day has never been booked)
+static struct DaySlots *findDay(const struct Calendar *cal, int day)
+{
+    int b;
+
+    if (cal->days == NULL)
+    {
+        return NULL;
+    }
+    for (b = (int)((unsigned int)day * 2654435761u) & cal->dayMask; cal->days[b].used;
+         b = (b + 1) & cal->dayMask)
+    {
+        if (cal->days[b].day == day)
+        {
+            return &cal->days[b];
+        }
+    }
+    return NULL;
+}
+
+// Find or add a day's entry (returns NULL on allocation failure)
+static struct DaySlots *addDay(struct Calendar *cal, int day)
+{
+    struct DaySlots *entry = findDay(cal, day);
+    int b;
+
+    if (entry != NULL)
+    {
+        return entry;
+    }
+
+    // Keep the table at most 3/4 full
+    if (cal->days == NULL || (cal->dayCount + 1) * 4 > (cal->dayMask + 1) * 3)
+    {
+        struct DaySlots *old = cal->days;
+        int oldSize = old ? cal->dayMask + 1 : 0;
+        int size = oldSize ? oldSize * 2 : 64;
+        int i;
+
+        cal->days = calloc(size, sizeof(struct DaySlots));
+        if (cal->days == NULL)
+        {
+            cal->days = old;
+            return NULL;
+        }
+        cal->dayMask = size - 1;
+        for (i = 0; i < oldSize; i++)
+        {
+            if (old[i].used)
+            {
+                for (b = (int)((unsigned int)old[i].day * 2654435761u) & cal->dayMask;
+                     cal->days[b].used; b = (b + 1) & cal->dayMask)
+                {
+                    ; // linear probe
+                }
+                cal->days[b] = old[i];
+            }
+        }
+        free(old);
+    }
+
+    for (b = (int)((unsigned int)day * 2654435761u) & cal->dayMask; cal->days[b].used;
+         b = (b + 1) & cal->dayMask)
+    {
+        ; // linear probe
+    }
+    memset(&cal->days[b], 0, sizeof(cal->days[b]));
+    cal->days[b].day = day;
+    cal->days[b].used = 1;
+    cal->dayCount++;
+    return &cal->days[b];
+}
+
+//////////////////////////////////////
+// FULL-DAY BITMAP
+//////////////////////////////////////
+
+// Set or clear a day's "full" bit, growing the bitmap as needed
+static void markFull(struct Calendar *cal, int day, int full)
+{
+    int word = day >> 6, i;
+
+    if (day < 0)
+    {
+        return; // days before 1970 are never skipped, only scanned
+    }
+    if (word >= cal->fullWords)
+    {
+        int words = cal->fullWords ? cal->fullWords : 64;
+        unsigned long long *grown, *summary;
+
+        if (!full)
+        {
+            return;
+        }
+        while (words <= word)
+        {
+            words *= 2;
+        }
+        grown = realloc(cal->full, sizeof(*grown) * words);
+        if (grown == NULL)
+        {
+            return;
+        }
+        cal->full = grown;
+        summary = realloc(cal->summary, sizeof(*summary) * ((words + 63) / 64));
+        if (summary == NULL)
+        {
+            return;
+        }
+        cal->summary = summary;
+        for (i = cal->fullWords; i < words; i++)
+        {
+            cal->full[i] = 0;
+        }
+        for (i = (cal->fullWords + 63) / 64; i < (words + 63) / 64; i++)
+        {
+            cal->summary[i] = 0;
+        }
+        cal->fullWords = words;
+    }
+
+    if (full)
+    {
+        cal->full[word] |= 1ULL << (day & 63);
+    }
+    else
+    {
+        cal->full[word] &= ~(1ULL << (day & 63));
+    }
+    if (cal->full[word] == ~0ULL)
+    {
+        cal->summary[word >> 6] |= 1ULL << (word & 63);
+    }
+    else
+    {
+        cal->summary[word >> 6] &= ~(1ULL << (word & 63));
+    }
+}
+
+// First day at or after "day" that is not completely booked
+static int nextOpenDay(const struct Calendar *cal, int day)
+{
+    unsigned long long bits;
+    int word;
+
+    if (day < 0 || (day >> 6) >= cal->fullWords)
+    {
+        return day;
+    }
+
+    word = day >> 6;
+    bits = ~cal->full[word] & (~0ULL << (day & 63));
+    if (bits)
+    {
+        return (word << 6) + __builtin_ctzll(bits);
+    }
+
+    // Skip runs of completely booked 64-day words through the summary level
+    for (word++; word < cal->fullWords;)
+    {
+        bits = ~cal->summary[word >> 6] & (~0ULL << (word & 63));
+        if (bits == 0)
+        {
+            word = ((word >> 6) + 1) << 6;
+            continue;
+        }
+        word = ((word >> 6) << 6) + __builtin_ctzll(bits);
+        if (word >= cal->fullWords)
+        {
+            break;
+        }
+        return (word << 6) + __builtin_ctzll(~cal->full[word]);
+    }
+    return cal->fullWords << 6;
+}
+
+//////////////////////////////////////
+// CALENDAR FUNCTIONS
+//////////////////////////////////////
+
+// Number of bookable slots per day
+int calendarSlotsPerDay(void)
+{
+    return SLOTS_PER_DAY;
+}
+
+// Grid slot of a time (returns -1 if not a bookable START_HOUR..END_HOUR slot)
+int calendarSlot(const struct Time *time)
+{
+    if (!isValidAppointmentTime(time))
+    {
+        return -1;
+    }
+    return (time->hour - START_HOUR) * SLOTS_PER_HOUR + time->min / MINUTE_INTERVAL;
+}
+
+// Set the number of resources per slot (call before booking anything)
+void calendarSetCapacity(struct Calendar *cal, int capacity)
+{
+    cal->capacity = capacity < 1 ? 1 : capacity;
+}
+
+// Add "delta" resource bookings to "slots" grid slots from date/time
+static void adjustSlots(struct Calendar *cal, const struct Date *date, const struct Time *time,
+                        int slots, int delta)
+{
+    struct DaySlots *entry;
+    int first = calendarSlot(time), capacity = cal->capacity ? cal->capacity : 1;
+    int slot, wasFull;
+
+    if (first == -1)
+    {
+        return;
+    }
+    entry = delta > 0 ? addDay(cal, dateToDay(date)) : findDay(cal, dateToDay(date));
+    if (entry == NULL)
+    {
+        return;
+    }
+
+    wasFull = entry->mask == FULL_DAY_MASK;
+    for (slot = first; slot < first + slots && slot < SLOTS_PER_DAY; slot++)
+    {
+        if (delta < 0 && entry->booked[slot] == 0)
+        {
+            continue;
+        }
+        entry->booked[slot] = (unsigned char)(entry->booked[slot] + delta);
+        if (entry->booked[slot] >= capacity)
+        {
+            entry->mask |= 1u << slot;
+        }
+        else
+        {
+            entry->mask &= ~(1u << slot);
+        }
+    }
+    if (wasFull != (entry->mask == FULL_DAY_MASK))
+    {
+        markFull(cal, entry->day, !wasFull);
+    }
+}
+
+// Count one resource booked for "slots" grid slots from date/time (off-grid parts are ignored)
+void calendarBook(struct Calendar *cal, const struct Date *date, const struct Time *time,
+                  int slots)
+{
+    adjustSlots(cal, date, time, slots, 1);
+}
+
+// Release one resource for "slots" grid slots from date/time (off-grid parts are ignored)
+void calendarRelease(struct Calendar *cal, const struct Date *date, const struct Time *time,
+                     int slots)
+{
+    adjustSlots(cal, date, time, slots, -1);
+}
+
+// Check if an on-grid date/time is booked on every resource (returns 1 if booked)
+int calendarIsBooked(const struct Calendar *cal, const struct Date *date,
+                     const struct Time *time)
+{
+    const struct DaySlots *entry;
+    int slot = calendarSlot(time);
+
+    if (slot == -1)
+    {
+        return 0;
+    }
+    entry = findDay(cal, dateToDay(date));
+    return entry != NULL && (entry->mask >> slot & 1u);
+}
+
+// Earliest start of "count" consecutive slots with a resource free at or after date/time
+// (returns 1 and fills foundDate/foundTime, or 0 if none within the horizon)
+int calendarNextFree(const struct Calendar *cal, const struct Date *date,
+                     const struct Time *time, int count,
+                     struct Date *foundDate, struct Time *foundTime)
+{
+    const struct DaySlots *entry;
+    unsigned int freeSlots, runs;
+    int day, first, last, k, slot;
+
+    if (count < 1 || count > SLOTS_PER_DAY || !isValidDate(date) ||
+        date->year > CALENDAR_MAX_YEAR || time->hour < MIN_TIME || time->hour > MAX_HOUR ||
+        time->min < MIN_TIME || time->min > MAX_MINUTE)
+    {
+        return 0;
+    }
+
+    // First grid slot at or after the requested time
+    day = dateToDay(date);
+    first = ((time->hour - START_HOUR) * 60 + time->min + MINUTE_INTERVAL - 1) / MINUTE_INTERVAL;
+    if (time->hour < START_HOUR)
+    {
+        first = 0;
+    }
+    if (first > SLOTS_PER_DAY - count)
+    {
+        day++;
+        first = 0;
+    }
+    last = day + CALENDAR_MAX_SEARCH_DAYS;
+
+    while (day < last)
+    {
+        // Fully booked days are skipped through the bitmap; a single-slot
+        // request is always satisfied by the first open day
+        if (first == 0)
+        {
+            day = nextOpenDay(cal, day);
+            if (day >= last)
+            {
+                break;
+            }
+        }
+
+        entry = findDay(cal, day);
+        freeSlots = FULL_DAY_MASK & ~(entry != NULL ? entry->mask : 0u);
+
+        // Bit n of runs is set when slots n..n+count-1 are all free
+        runs = freeSlots;
+        for (k = 1; k < count; k++)
+        {
+            runs &= freeSlots >> k;
+        }
+        runs &= ~((1u << first) - 1) & ((1u << (SLOTS_PER_DAY - count + 1)) - 1);
+
+        if (runs)
+        {
+            slot = __builtin_ctz(runs);
+            dayToDate(day, foundDate);
+            foundTime->hour = START_HOUR + slot / SLOTS_PER_HOUR;
+            foundTime->min = slot % SLOTS_PER_HOUR * MINUTE_INTERVAL;
+            return 1;
+        }
+        day++;
+        first = 0;
+    }
+    return 0;
+}
+
+// Release the calendar's tables
+void calendarFree(struct Calendar *cal)
+{
+    int capacity = cal->capacity;
+
+    free(cal->days);
+    free(cal->full);
+    free(cal->summary);
+    memset(cal, 0, sizeof(*cal));
+    cal->capacity = capacity;
+}
@@ -0,0 +1,84 @@
+// SAFE-GUARD:
+// It is good practice to apply safe-guards to header files
+// Safe-guard's ensures only 1 copy of the header file is used in the project build
+// The macro name should be mirroring the file name with _ for spaces, dots, etc.
+#ifndef CALENDAR_H
+#define CALENDAR_H
+
+struct Date;
+struct Time;
+
+//////////////////////////////////////
+// Module macro's (usable by any file that includes this header)
+//////////////////////////////////////
+
+// Search horizon for the next free slot (days)
+#define CALENDAR_MAX_SEARCH_DAYS (366 * 100)
+
+// Latest year a search may start in (its horizon must still fit a day number)
+#define CALENDAR_MAX_YEAR 5000000
+
+// Upper bound on grid slots per day
+#define CALENDAR_MAX_SLOTS 32
+
+//////////////////////////////////////
+// Structures
+//////////////////////////////////////
+
+// Data type: occupancy of one day's START_HOUR..END_HOUR slot grid
+struct DaySlots
+{
+    int day;           // day number (days since 1970-01-01)
+    unsigned int mask; // bit n set: slot n is booked on every resource
+    int used;
+    unsigned char booked[CALENDAR_MAX_SLOTS]; // resources booked per slot
+};
+
+// Data type: per-day occupancy bitmaps plus a two-level "day is full" bitmap
+struct Calendar
+{
+    struct DaySlots *days; // open-addressing table keyed by day number
+    int dayMask;
+    int dayCount;
+    unsigned long long *full;    // bit per day since 1970-01-01: every slot booked
+    unsigned long long *summary; // bit per "full" word: all 64 days full
+    int fullWords;
+    int capacity; // resources per slot (a slot is full at this many bookings)
+};
+
+//////////////////////////////////////
+// CALENDAR FUNCTIONS
+//////////////////////////////////////
+
+// Number of bookable slots per day
+int calendarSlotsPerDay(void);
+
+// Grid slot of a time (returns -1 if not a bookable START_HOUR..END_HOUR slot)
+int calendarSlot(const struct Time *time);
+
+// Set the number of resources per slot (call before booking anything)
+void calendarSetCapacity(struct Calendar *cal, int capacity);
+
+// Count one resource booked for "slots" grid slots from date/time (off-grid parts are ignored)
+void calendarBook(struct Calendar *cal, const struct Date *date, const struct Time *time,
+                  int slots);
+
+// Release one resource for "slots" grid slots from date/time (off-grid parts are ignored)
+void calendarRelease(struct Calendar *cal, const struct Date *date, const struct Time *time,
+                     int slots);
+
+// Check if an on-grid date/time is booked on every resource (returns 1 if booked)
+int calendarIsBooked(const struct Calendar *cal, const struct Date *date,
+                     const struct Time *time);
+
+// Earliest start of "count" consecutive slots with a resource free at or after date/time
+// (returns 1 and fills foundDate/foundTime, or 0 if none within the horizon or
+// the start is not a real date and time of day)
+int calendarNextFree(const struct Calendar *cal, const struct Date *date,
+                     const struct Time *time, int count,
+                     struct Date *foundDate, struct Time *foundTime);
+
+// Release the calendar's tables
+void calendarFree(struct Calendar *cal);
+
+#endif // !CALENDAR_H
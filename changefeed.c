@@ -0,0 +1,720 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+// include the user library "clinic" where the store functions are declared
+#include "clinic.h"
+// include the user library "strpool" to intern decoded names
+#include "strpool.h"
+// include the user library "loader" for the parallel import
+#include "loader.h"
+// include the user library "changefeed" where the function prototypes are declared
+#include "changefeed.h"
+
+static volatile sig_atomic_t stopRequested = 0;
+
+//////////////////////////////////////
+// ENCODING HELPERS
+//////////////////////////////////////
+
+// Append an unsigned little-endian integer of "bytes" bytes
+static unsigned char *putUnsigned(unsigned char *out, unsigned long long value, int bytes)
+{
+    int i;
+
+    for (i = 0; i < bytes; i++)
+    {
+        *out++ = (unsigned char)(value >> (8 * i));
+    }
+    return out;
+}
+
+// Read an unsigned little-endian integer of "bytes" bytes
+static unsigned long long getUnsigned(const unsigned char **in, int bytes)
+{
+    unsigned long long value = 0;
+    int i;
+
+    for (i = 0; i < bytes; i++)
+    {
+        value |= (unsigned long long)(*in)[i] << (8 * i);
+    }
+    *in += bytes;
+    return value;
+}
+
+// Append a date
+static unsigned char *putDate(unsigned char *out, const struct Date *date)
+{
+    out = putUnsigned(out, date->year, 2);
+    out = putUnsigned(out, date->month, 1);
+    return putUnsigned(out, date->day, 1);
+}
+
+// Read a date
+static void getDate(const unsigned char **in, struct Date *date)
+{
+    date->year = (int)getUnsigned(in, 2);
+    date->month = (int)getUnsigned(in, 1);
+    date->day = (int)getUnsigned(in, 1);
+}
+
+// Append a time
+static unsigned char *putTime(unsigned char *out, const struct Time *time)
+{
+    out = putUnsigned(out, time->hour, 1);
+    return putUnsigned(out, time->min, 1);
+}
+
+// Read a time
+static void getTime(const unsigned char **in, struct Time *time)
+{
+    time->hour = (int)getUnsigned(in, 1);
+    time->min = (int)getUnsigned(in, 1);
+}
+
+// Encode a change as one frame (returns its length)
+static int encodeChange(const struct ChangeRecord *change, unsigned char *frame)
+{
+    const struct Series *rule = &change->series;
+    const struct Appointment *appoint = &change->appointment;
+    unsigned char *out = frame + 2;
+    const char *name;
+    size_t nameLen;
+
+    out = putUnsigned(out, change->sequence, 8);
+    out = putUnsigned(out, change->kind, 1);
+    switch (change->kind)
+    {
+    case CHANGE_PATIENT_PUT:
+        name = patientName(&change->patient);
+        nameLen = strlen(name) < 255 ? strlen(name) : 255;
+        out = putUnsigned(out, (unsigned int)change->patient.patientNumber, 4);
+        out = putUnsigned(out, change->patient.phone, 8);
+        out = putUnsigned(out, nameLen, 1);
+        memcpy(out, name, nameLen);
+        out += nameLen;
+        break;
+    case CHANGE_PATIENT_REMOVE:
+        out = putUnsigned(out, (unsigned int)change->patient.patientNumber, 4);
+        break;
+    case CHANGE_APPOINTMENT_ADD:
+    case CHANGE_APPOINTMENT_REMOVE:
+        out = putUnsigned(out, (unsigned int)appoint->patientNumber, 4);
+        out = putDate(out, &appoint->date);
+        out = putTime(out, &appoint->time);
+        out = putUnsigned(out, appoint->resource, 1);
+        out = putUnsigned(out, appoint->duration, 2);
+        break;
+    default:
+        out = putUnsigned(out, (unsigned int)rule->patientNumber, 4);
+        out = putDate(out, &rule->start);
+        out = putTime(out, &rule->time);
+        out = putUnsigned(out, rule->resource, 1);
+        out = putUnsigned(out, rule->duration, 2);
+        out = putUnsigned(out, rule->everyDays, 2);
+        out = putUnsigned(out, rule->count, 2);
+        out = putDate(out, &rule->until);
+        break;
+    }
+    putUnsigned(frame, out - frame - 2, 2);
+    return (int)(out - frame);
+}
+
+// Decode the frame body following its length (returns 0 if it is malformed)
+static int decodeChange(const unsigned char *in, int length, struct ChangeRecord *change)
+{
+    const unsigned char *end = in + length;
+    struct Series *rule = &change->series;
+    struct Appointment *appoint = &change->appointment;
+    char name[256];
+    int nameLen;
+
+    memset(change, 0, sizeof(*change));
+    if (length < 9)
+    {
+        return 0;
+    }
+    change->sequence = getUnsigned(&in, 8);
+    change->kind = (int)getUnsigned(&in, 1);
+    switch (change->kind)
+    {
+    case CHANGE_PATIENT_PUT:
+        if (end - in < 13 || end - in != 13 + in[12])
+        {
+            return 0;
+        }
+        change->patient.patientNumber = (int)getUnsigned(&in, 4);
+        change->patient.phone = getUnsigned(&in, 8);
+        nameLen = (int)getUnsigned(&in, 1);
+        memcpy(name, in, nameLen);
+        name[nameLen] = '\0';
+        change->patient.name = internString(name);
+        return 1;
+    case CHANGE_PATIENT_REMOVE:
+        if (end - in != 4)
+        {
+            return 0;
+        }
+        change->patient.patientNumber = (int)getUnsigned(&in, 4);
+        return 1;
+    case CHANGE_APPOINTMENT_ADD:
+    case CHANGE_APPOINTMENT_REMOVE:
+        if (end - in != 13)
+        {
+            return 0;
+        }
+        appoint->patientNumber = (int)getUnsigned(&in, 4);
+        getDate(&in, &appoint->date);
+        getTime(&in, &appoint->time);
+        appoint->resource = (int)getUnsigned(&in, 1);
+        appoint->duration = (int)getUnsigned(&in, 2);
+        return 1;
+    case CHANGE_SERIES_ADD:
+    case CHANGE_SERIES_CANCEL:
+        if (end - in != 21)
+        {
+            return 0;
+        }
+        rule->patientNumber = (int)getUnsigned(&in, 4);
+        getDate(&in, &rule->start);
+        getTime(&in, &rule->time);
+        rule->resource = (int)getUnsigned(&in, 1);
+        rule->duration = (int)getUnsigned(&in, 2);
+        rule->everyDays = (int)getUnsigned(&in, 2);
+        rule->count = (int)getUnsigned(&in, 2);
+        getDate(&in, &rule->until);
+        return 1;
+    }
+    return 0;
+}
+
+// Write all of a buffer (returns 0 on failure)
+static int writeAll(int fd, const void *data, size_t size)
+{
+    const char *at = data;
+    ssize_t n;
+
+    while (size > 0)
+    {
+        n = send(fd, at, size, MSG_NOSIGNAL);
+        if (n == -1 && errno == ENOTSOCK)
+        {
+            n = write(fd, at, size);
+        }
+        if (n == -1 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n <= 0)
+        {
+            return 0;
+        }
+        at += n;
+        size -= n;
+    }
+    return 1;
+}
+
+// Frame at the tail's read position: sets *length to the frame body length
+// (returns 1 if a whole frame is buffered, 0 if more bytes are needed,
+// -1 if the length cannot be a change)
+static int bufferedFrame(const struct ChangeTail *tail, int *length)
+{
+    const unsigned char *at = tail->buffer + tail->pos;
+
+    if (tail->len - tail->pos < 2)
+    {
+        return 0;
+    }
+    *length = (int)getUnsigned(&at, 2);
+    if (*length + 2 > CHANGEFEED_MAX_RECORD)
+    {
+        return -1;
+    }
+    return tail->len - tail->pos >= 2 + *length;
+}
+
+// Refill the tail's buffer from its descriptor
+// (returns the bytes read, 0 at the end of what is there, -1 on error)
+static int fillTail(struct ChangeTail *tail)
+{
+    ssize_t n;
+
+    memmove(tail->buffer, tail->buffer + tail->pos, tail->len - tail->pos);
+    tail->len -= tail->pos;
+    tail->pos = 0;
+    n = read(tail->fd, tail->buffer + tail->len, sizeof(tail->buffer) - tail->len);
+    if (n > 0)
+    {
+        tail->len += (int)n;
+    }
+    return (int)n;
+}
+
+// Check the feed's opening bytes (returns 1 once read and valid, 0 if more are
+// needed, -1 if the feed is something else)
+static int readMagic(struct ChangeTail *tail)
+{
+    if (tail->magicRead)
+    {
+        return 1;
+    }
+    if (tail->len - tail->pos < CHANGEFEED_MAGIC_LEN)
+    {
+        return 0;
+    }
+    if (memcmp(tail->buffer + tail->pos, CHANGEFEED_MAGIC, CHANGEFEED_MAGIC_LEN) != 0)
+    {
+        return -1;
+    }
+    tail->pos += CHANGEFEED_MAGIC_LEN;
+    tail->magicRead = 1;
+    return 1;
+}
+
+// Find the last sequence of a feed file and cut off a change left half written
+// (returns 0 if it is not a feed)
+static int resumeFeedFile(struct ChangeFeed *feed)
+{
+    struct ChangeTail *scan = calloc(1, sizeof(*scan));
+    const unsigned char *at;
+    long long readTotal = 0;
+    int length, magic, frame, n, valid = 1;
+
+    if (scan == NULL)
+    {
+        return 0;
+    }
+    scan->fd = feed->fd;
+    scan->listenFd = -1;
+    for (;;)
+    {
+        magic = readMagic(scan);
+        frame = magic == 1 ? bufferedFrame(scan, &length) : 0;
+        if (magic == -1 || frame == -1)
+        {
+            valid = 0;
+            break;
+        }
+        if (frame == 1)
+        {
+            at = scan->buffer + scan->pos + 2;
+            feed->sequence = getUnsigned(&at, 8);
+            scan->pos += 2 + length;
+            continue;
+        }
+        n = fillTail(scan);
+        if (n <= 0)
+        {
+            break;
+        }
+        readTotal += n;
+    }
+
+    // A file too short for the magic is not a feed unless it is empty
+    if (valid && !scan->magicRead && readTotal > 0)
+    {
+        valid = 0;
+    }
+    if (valid && scan->magicRead && scan->len > scan->pos)
+    {
+        valid = ftruncate(feed->fd, readTotal - (scan->len - scan->pos)) == 0;
+    }
+    free(scan);
+    return valid;
+}
+
+//////////////////////////////////////
+// PRODUCER FUNCTIONS
+//////////////////////////////////////
+
+// Journal callback of a file feed: changes up to "ticket" are on disk
+static void feedDurable(void *context, unsigned long long ticket, int error)
+{
+    struct ChangeFeed *feed = context;
+
+    if (error == 0)
+    {
+        __atomic_store_n(&feed->durable, feed->journalBase + ticket, __ATOMIC_RELEASE);
+    }
+}
+
+// Open a feed: connect if "target" is a listening Unix socket, else append to it as
+// a file, continuing its sequence (returns 0 if it cannot be opened or is not a feed)
+int changeFeedOpen(struct ChangeFeed *feed, const char *target)
+{
+    struct sockaddr_un addr = {0};
+    struct stat info;
+    off_t end;
+
+    feed->fd = -1;
+    feed->sequence = 0;
+    feed->journal = NULL;
+    feed->durable = 0;
+    if (stat(target, &info) == 0 && S_ISSOCK(info.st_mode))
+    {
+        if (strlen(target) >= sizeof(addr.sun_path))
+        {
+            return 0;
+        }
+        addr.sun_family = AF_UNIX;
+        strcpy(addr.sun_path, target);
+        feed->fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (feed->fd == -1 || connect(feed->fd, (struct sockaddr *)&addr, sizeof(addr)) == -1)
+        {
+            changeFeedClose(feed);
+            return 0;
+        }
+
+        // A new connection starts with the magic
+        if (!writeAll(feed->fd, CHANGEFEED_MAGIC, CHANGEFEED_MAGIC_LEN))
+        {
+            changeFeedClose(feed);
+            return 0;
+        }
+        return 1;
+    }
+
+    // Files are written at explicit offsets by the journal, so no O_APPEND
+    feed->fd = open(target, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (feed->fd == -1 || !resumeFeedFile(feed))
+    {
+        changeFeedClose(feed);
+        return 0;
+    }
+    end = lseek(feed->fd, 0, SEEK_END);
+    if (end == 0 &&
+        pwrite(feed->fd, CHANGEFEED_MAGIC, CHANGEFEED_MAGIC_LEN, 0) == CHANGEFEED_MAGIC_LEN)
+    {
+        end = CHANGEFEED_MAGIC_LEN;
+    }
+    feed->journalBase = feed->sequence;
+    feed->durable = feed->sequence;
+    feed->journal = malloc(sizeof(*feed->journal));
+    if (end < CHANGEFEED_MAGIC_LEN || feed->journal == NULL ||
+        !journalOpen(feed->journal, feed->fd, end, JOURNAL_BACKEND_AUTO, feedDurable, feed))
+    {
+        free(feed->journal);
+        feed->journal = NULL;
+        changeFeedClose(feed);
+        return 0;
+    }
+    return 1;
+}
+
+// Number and write one change (returns its sequence, 0 if the feed is closed or broke)
+unsigned long long changeFeedWrite(struct ChangeFeed *feed, struct ChangeRecord *change)
+{
+    unsigned char frame[CHANGEFEED_MAX_RECORD];
+    int length;
+
+    if (feed->fd == -1)
+    {
+        return 0;
+    }
+    change->sequence = feed->sequence + 1;
+    length = encodeChange(change, frame);
+
+    // One write per change so a tailing reader never sees frames interleaved; a
+    // file feed hands the frame to the journal instead of waiting for the disk
+    if (feed->journal != NULL ? journalAppend(feed->journal, frame, length) == 0
+                              : !writeAll(feed->fd, frame, length))
+    {
+        changeFeedClose(feed);
+        return 0;
+    }
+    feed->sequence = change->sequence;
+    return feed->sequence;
+}
+
+// Close the feed, waiting for queued changes to reach the disk
+void changeFeedClose(struct ChangeFeed *feed)
+{
+    if (feed->journal != NULL)
+    {
+        if (!journalClose(feed->journal))
+        {
+            printf("ERROR: The change feed could not be written (%s)\n",
+                   strerror(feed->journal->error));
+        }
+        free(feed->journal);
+        feed->journal = NULL;
+    }
+    if (feed->fd != -1)
+    {
+        close(feed->fd);
+    }
+    feed->fd = -1;
+}
+
+//////////////////////////////////////
+// CONSUMER FUNCTIONS
+//////////////////////////////////////
+
+// Tail a feed: follow "source" if it is a file, else listen on it as a Unix socket
+// and wait for a producer to connect (returns 0 on failure)
+int changeTailOpen(struct ChangeTail *tail, const char *source)
+{
+    struct sockaddr_un addr = {0};
+    struct stat info;
+
+    memset(tail, 0, sizeof(*tail));
+    tail->fd = -1;
+    tail->listenFd = -1;
+    if (stat(source, &info) == 0 && S_ISREG(info.st_mode))
+    {
+        tail->fd = open(source, O_RDONLY | O_CLOEXEC);
+        return tail->fd != -1;
+    }
+
+    // Anything else at the path is replaced by the socket (a stale one from a past run)
+    if (strlen(source) >= sizeof(addr.sun_path) ||
+        (stat(source, &info) == 0 && !S_ISSOCK(info.st_mode)))
+    {
+        return 0;
+    }
+    unlink(source);
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, source);
+    tail->listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (tail->listenFd == -1 || bind(tail->listenFd, (struct sockaddr *)&addr, sizeof(addr)) ||
+        listen(tail->listenFd, 1))
+    {
+        changeTailClose(tail);
+        return 0;
+    }
+    return 1;
+}
+
+// Read the next change (returns 1, or CHANGE_TAIL_WAIT / CHANGE_TAIL_CLOSED / CHANGE_TAIL_BAD)
+int changeTailNext(struct ChangeTail *tail, struct ChangeRecord *change)
+{
+    int length, magic, frame, n;
+
+    if (tail->fd == -1)
+    {
+        return tail->listenFd == -1 ? CHANGE_TAIL_BAD : CHANGE_TAIL_CLOSED;
+    }
+    for (;;)
+    {
+        magic = readMagic(tail);
+        frame = magic == 1 ? bufferedFrame(tail, &length) : 0;
+        if (magic == -1 || frame == -1)
+        {
+            return CHANGE_TAIL_BAD;
+        }
+        if (frame == 1)
+        {
+            if (!decodeChange(tail->buffer + tail->pos + 2, length, change))
+            {
+                return CHANGE_TAIL_BAD;
+            }
+            tail->pos += 2 + length;
+            return 1;
+        }
+
+        n = fillTail(tail);
+        if (n == 0)
+        {
+            // A file may still grow; a socket at its end has lost its producer
+            return tail->listenFd == -1 ? CHANGE_TAIL_WAIT : CHANGE_TAIL_CLOSED;
+        }
+        if (n == -1)
+        {
+            return errno == EINTR ? CHANGE_TAIL_WAIT : CHANGE_TAIL_CLOSED;
+        }
+    }
+}
+
+// Wait for the next producer after CHANGE_TAIL_CLOSED (returns 0 on failure)
+int changeTailAccept(struct ChangeTail *tail)
+{
+    if (tail->listenFd == -1)
+    {
+        return 0;
+    }
+    if (tail->fd != -1)
+    {
+        close(tail->fd);
+    }
+
+    // Each connection numbers its changes from 1
+    tail->len = 0;
+    tail->pos = 0;
+    tail->magicRead = 0;
+    tail->sequence = 0;
+    tail->fd = accept4(tail->listenFd, NULL, NULL, SOCK_CLOEXEC);
+    return tail->fd != -1;
+}
+
+// Stop tailing
+void changeTailClose(struct ChangeTail *tail)
+{
+    struct sockaddr_un addr;
+    socklen_t size = sizeof(addr);
+
+    if (tail->fd != -1)
+    {
+        close(tail->fd);
+    }
+    if (tail->listenFd != -1)
+    {
+        if (getsockname(tail->listenFd, (struct sockaddr *)&addr, &size) == 0 &&
+            addr.sun_path[0] != '\0')
+        {
+            unlink(addr.sun_path);
+        }
+        close(tail->listenFd);
+    }
+    tail->fd = -1;
+    tail->listenFd = -1;
+}
+
+//////////////////////////////////////
+// REPLICA FUNCTIONS
+//////////////////////////////////////
+
+// Signal handler: ask the replica to stop
+static void onStopSignal(int sig)
+{
+    (void)sig;
+    stopRequested = 1;
+}
+
+// Print what a change did
+static void displayChange(const struct ChangeRecord *change, int applied)
+{
+    const struct Appointment *appoint = &change->appointment;
+    const struct Series *rule = &change->series;
+
+    printf("#%llu ", change->sequence);
+    switch (change->kind)
+    {
+    case CHANGE_PATIENT_PUT:
+        printf("Patient %05d saved (%s)", change->patient.patientNumber,
+               patientName(&change->patient));
+        break;
+    case CHANGE_PATIENT_REMOVE:
+        printf("Patient %05d removed", change->patient.patientNumber);
+        break;
+    case CHANGE_APPOINTMENT_ADD:
+    case CHANGE_APPOINTMENT_REMOVE:
+        printf("Appointment %05d %04d-%02d-%02d %02d:%02d %s", appoint->patientNumber,
+               appoint->date.year, appoint->date.month, appoint->date.day,
+               appoint->time.hour, appoint->time.min,
+               change->kind == CHANGE_APPOINTMENT_ADD ? "booked" : "cancelled");
+        break;
+    default:
+        printf("Series %05d from %04d-%02d-%02d %s", rule->patientNumber, rule->start.year,
+               rule->start.month, rule->start.day,
+               change->kind == CHANGE_SERIES_ADD ? "booked" : "cancelled");
+        break;
+    }
+    printf("%s\n", applied ? "" : " - NOT APPLIED (replica out of step)");
+    fflush(stdout);
+}
+
+// Replica: import the data files, then apply the feed's changes as they arrive
+// until SIGINT/SIGTERM, one line per change (returns 0 on clean exit)
+int runReplica(const char *source, const char *patientFile, const char *appointmentFile)
+{
+    struct ClinicData data;
+    struct ChangeTail *tail;
+    struct ChangeRecord change;
+    struct sigaction sa = {0};
+    struct timespec poll = {0, CHANGEFEED_POLL_MS * 1000000L};
+    int patientCount, appointCount, status, applied = 0, skipped = 0;
+
+    patientCount = countDataRecords(patientFile);
+    appointCount = countDataRecords(appointmentFile);
+    if (patientCount < 0 || appointCount < 0)
+    {
+        printf("ERROR: Unable to open the data files\n");
+        return 1;
+    }
+    tail = malloc(sizeof(*tail));
+    if (tail == NULL || !createClinic(&data, patientCount + CHANGEFEED_REPLICA_ROOM,
+                                      appointCount + CHANGEFEED_REPLICA_ROOM))
+    {
+        printf("ERROR: Out of memory\n");
+        free(tail);
+        return 1;
+    }
+    patientCount = importPatientsParallel(patientFile, data.patients, data.maxPatient, 0);
+    appointCount = importAppointmentsParallel(appointmentFile, data.appointments,
+                                              data.maxAppointments, 0);
+    syncClinicIndexes(&data);
+    printf("Imported %d patient and %d appointment records...\n", patientCount, appointCount);
+
+    if (!changeTailOpen(tail, source))
+    {
+        printf("ERROR: Unable to follow %s (%s)\n", source, strerror(errno));
+        destroyClinic(&data);
+        free(tail);
+        return 1;
+    }
+
+    // No SA_RESTART: a signal must break a blocking read or accept
+    sa.sa_handler = onStopSignal;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    printf("Following %s...\n\n", source);
+    fflush(stdout);
+
+    status = tail->listenFd == -1 ? CHANGE_TAIL_WAIT : CHANGE_TAIL_CLOSED;
+    while (!stopRequested && status != CHANGE_TAIL_BAD)
+    {
+        if (status == CHANGE_TAIL_CLOSED)
+        {
+            changeTailAccept(tail);
+        }
+        else if (status == CHANGE_TAIL_WAIT)
+        {
+            nanosleep(&poll, NULL);
+        }
+        while (!stopRequested && (status = changeTailNext(tail, &change)) == 1)
+        {
+            // A change seen before (e.g. the file re-read) is applied once
+            if (change.sequence <= tail->sequence)
+            {
+                continue;
+            }
+            if (change.sequence != tail->sequence + 1)
+            {
+                printf("WARNING: Changes #%llu to #%llu are missing\n", tail->sequence + 1,
+                       change.sequence - 1);
+            }
+            tail->sequence = change.sequence;
+            if (applyClinicChange(&data, &change))
+            {
+                applied++;
+                displayChange(&change, 1);
+            }
+            else
+            {
+                skipped++;
+                displayChange(&change, 0);
+            }
+        }
+    }
+    if (status == CHANGE_TAIL_BAD)
+    {
+        printf("ERROR: %s is not a change feed or is corrupt\n", source);
+    }
+
+    printf("\nReplica stopped: %d change(s) applied, %d not applied.\n", applied, skipped);
+    changeTailClose(tail);
+    destroyClinic(&data);
+    free(tail);
+    return status == CHANGE_TAIL_BAD;
+}
@@ -0,0 +1,139 @@
+// SAFE-GUARD:
+// It is good practice to apply safe-guards to header files
+// Safe-guard's ensures only 1 copy of the header file is used in the project build
+// The macro name should be mirroring the file name with _ for spaces, dots, etc.
+#ifndef CHANGEFEED_H
+#define CHANGEFEED_H
+
+#include "clinic.h"
+// include the user library "journal" for background file writes
+#include "journal.h"
+
+//////////////////////////////////////
+// Module macro's (usable by any file that includes this header)
+//////////////////////////////////////
+
+// First bytes of every feed file or connection
+#define CHANGEFEED_MAGIC "VCFEED1\n"
+#define CHANGEFEED_MAGIC_LEN 8
+
+// Change kinds
+#define CHANGE_PATIENT_PUT 1         // patient added or edited (the whole record)
+#define CHANGE_PATIENT_REMOVE 2      // patient removed (number only)
+#define CHANGE_APPOINTMENT_ADD 3     // appointment booked (resource and minutes resolved)
+#define CHANGE_APPOINTMENT_REMOVE 4  // appointment cancelled
+#define CHANGE_SERIES_ADD 5          // recurring series booked
+#define CHANGE_SERIES_CANCEL 6       // recurring series cancelled
+
+// Largest encoded change, length prefix included
+#define CHANGEFEED_MAX_RECORD 320
+
+// Bytes read from a feed at a time
+#define CHANGEFEED_READ_CHUNK 4096
+
+// Spare store slots a replica keeps for records the feed adds
+#define CHANGEFEED_REPLICA_ROOM 1024
+
+// How often a tailed file is checked for new changes (milliseconds)
+#define CHANGEFEED_POLL_MS 200
+
+// changeTailNext results besides 1 (a change was read)
+#define CHANGE_TAIL_WAIT 0    // no complete change yet
+#define CHANGE_TAIL_CLOSED -1 // the producer hung up (socket feeds)
+#define CHANGE_TAIL_BAD -2    // not a change feed, or a corrupt change
+
+//////////////////////////////////////
+// Feed format
+//////////////////////////////////////
+//
+// CHANGEFEED_MAGIC, then one frame per change, integers little-endian:
+//   u16 length of the rest of the frame
+//   u64 sequence (1, 2, ... with no gaps; a file feed continues its last one)
+//   u8  kind
+//   CHANGE_PATIENT_PUT        i32 patient#, u64 phone (number << 2 | type),
+//                             u8 name length, name bytes
+//   CHANGE_PATIENT_REMOVE     i32 patient#
+//   CHANGE_APPOINTMENT_*      i32 patient#, date, time, u8 resource, u16 minutes
+//   CHANGE_SERIES_*           i32 patient#, date, time, u8 resource, u16 minutes,
+//                             u16 every days, u16 count, until date
+// where a date is u16 year, u8 month, u8 day and a time u8 hour, u8 minute.
+// Appointments and series are identified by patient# and date (start date
+// for a series), the same keys the menus use.
+
+//////////////////////////////////////
+// Structures
+//////////////////////////////////////
+
+// Data type: one decoded change
+struct ChangeRecord
+{
+    unsigned long long sequence;
+    int kind;
+    struct Patient patient;         // CHANGE_PATIENT_* (name interned on decode)
+    struct Appointment appointment; // CHANGE_APPOINTMENT_*
+    struct Series series;           // CHANGE_SERIES_*
+};
+
+// Data type: the producing side of a feed (a file appended to, or a connected socket)
+struct ChangeFeed
+{
+    int fd; // -1: closed (changes are dropped)
+    unsigned long long sequence; // last sequence written
+    struct Journal *journal;     // file feeds: writes and syncs in the background
+    unsigned long long journalBase; // sequence before the journal's first ticket
+    unsigned long long durable;  // file feeds: last sequence synced to disk
+};
+
+// Data type: the consuming side of a feed
+struct ChangeTail
+{
+    int fd;
+    int listenFd; // socket feeds: where the next producer connects (-1: file feed)
+    unsigned char buffer[CHANGEFEED_READ_CHUNK + CHANGEFEED_MAX_RECORD];
+    int len;
+    int pos;
+    int magicRead;
+    unsigned long long sequence; // last sequence applied
+};
+
+//////////////////////////////////////
+// PRODUCER FUNCTIONS
+//////////////////////////////////////
+
+// Open a feed: connect if "target" is a listening Unix socket, else append to it as
+// a file, continuing its sequence (returns 0 if it cannot be opened or is not a feed)
+int changeFeedOpen(struct ChangeFeed *feed, const char *target);
+
+// Number and write one change; a file feed only queues it for the journal (returns its
+// sequence, 0 if the feed is closed or broke)
+unsigned long long changeFeedWrite(struct ChangeFeed *feed, struct ChangeRecord *change);
+
+// Close the feed, waiting for queued changes to reach the disk
+void changeFeedClose(struct ChangeFeed *feed);
+
+//////////////////////////////////////
+// CONSUMER FUNCTIONS
+//////////////////////////////////////
+
+// Tail a feed: follow "source" if it is a file, else listen on it as a Unix socket
+// and wait for a producer to connect (returns 0 on failure)
+int changeTailOpen(struct ChangeTail *tail, const char *source);
+
+// Read the next change (returns 1, or CHANGE_TAIL_WAIT / CHANGE_TAIL_CLOSED / CHANGE_TAIL_BAD)
+int changeTailNext(struct ChangeTail *tail, struct ChangeRecord *change);
+
+// Wait for the next producer after CHANGE_TAIL_CLOSED (returns 0 on failure)
+int changeTailAccept(struct ChangeTail *tail);
+
+// Stop tailing
+void changeTailClose(struct ChangeTail *tail);
+
+//////////////////////////////////////
+// REPLICA FUNCTIONS
+//////////////////////////////////////
+
+// Replica: import the data files, then apply the feed's changes as they arrive
+// until SIGINT/SIGTERM, one line per change (returns 0 on clean exit)
+int runReplica(const char *source, const char *patientFile, const char *appointmentFile);
+
+#endif // !CHANGEFEED_H
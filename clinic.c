@@ -1,11 +1,58 @@
 #define _CRT_SECURE_NO_WARNINGS
+#include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <limits.h>
 
 // include the user library "core" so we can use those functions
 #include "core.h"
 // include the user library "clinic" where the function prototypes are declared
 #include "clinic.h"
+// include the user library "strpool" where patient names are interned
+#include "strpool.h"
+// include the user library "metrics" for the operation timers
+#include "metrics.h"
+// include the user library "changefeed" for the change log
+#include "changefeed.h"
+
+//////////////////////////////////////
+// Internal structures
+//////////////////////////////////////
+
+// Sort key of an appointment: minutes since 1970-01-01 and its store position
+struct SortKey
+{
+    long long key;
+    int index;
+};
+
+static int keyDay(long long key);
+static int activeSeries(const struct ClinicData *data);
+static int freeResource(const struct ClinicData *data, long long start, long long end);
+static int resourceBusy(const struct ClinicData *data, int resource, long long start,
+                        long long end);
+static void insertByTime(struct Appointment appoints[], int max, int *total,
+                         const struct Appointment *appoint);
+static int compareSlots(const void *a, const void *b);
+static void syncSlotPool(struct SlotPool *pool, const int *firstNumber, size_t size, int count);
+static void rebuildIndexes(struct ClinicData *data);
+static void indexPatient(struct ClinicData *data, int slot);
+static void unindexPatient(struct ClinicData *data, int patientNumber);
+static void groupPatient(struct ClinicData *data, int slot);
+static void publishPatient(struct ClinicData *data, int slot);
+static void publishAppointment(struct ClinicData *data, int slot);
+static void logPatient(struct ClinicData *data, int kind, const struct Patient *patient);
+static void logAppointment(struct ClinicData *data, int kind, const struct Appointment *appoint);
+static void logSeries(struct ClinicData *data, int kind, const struct Series *rule);
+static void dropPatient(struct ClinicData *data, int slot);
+static void dropAppointment(struct ClinicData *data, int slot);
+static void countBooking(struct ClinicData *data, const struct Appointment *appoint, int delta);
+static void dropSeriesDays(struct ClinicData *data, const struct Series *rule);
+static void renderDaySchedule(struct ClinicData *data, const struct Date *date);
+static void reportPromotions(struct ClinicData *data, const struct Date *date);
+static int chooseAppointment(const struct ClinicData *data, int patientNumber,
+                             const struct Date *date);
+static int chooseSeries(const struct ClinicData *data, int patientNumber, const struct Date *date);
 
 //////////////////////////////////////
 // DISPLAY FUNCTIONS
@@ -21,21 +68,24 @@ void displayPatientTableHeader(void)
 // Displays a single patient record in FMT_FORM | FMT_TABLE format
 void displayPatientData(const struct Patient *patient, int fmt)
 {
+    struct Phone phone;
+
+    getPatientPhone(patient, &phone);
     if (fmt == FMT_FORM)
     {
         printf("Name  : %s\n"
                "Number: %05d\n"
                "Phone : ",
-               patient->name, patient->patientNumber);
-        displayFormattedPhone(patient->phone.number);
-        printf(" (%s)\n", patient->phone.description);
+               patientName(patient), patient->patientNumber);
+        displayFormattedPhone(phone.number);
+        printf(" (%s)\n", phone.description);
     }
     else
     {
         printf("%05d %-15s ", patient->patientNumber,
-               patient->name);
-        displayFormattedPhone(patient->phone.number);
-        printf(" (%s)\n", patient->phone.description);
+               patientName(patient));
+        displayFormattedPhone(phone.number);
+        printf(" (%s)\n", phone.description);
     }
 }
 
@@ -63,17 +113,51 @@ void displayScheduleData(const struct Patient *patient,
                          const struct Appointment *appoint,
                          int includeDateField)
 {
+    char row[SCHEDULE_ROW_LEN];
+
+    formatScheduleData(row, sizeof(row), patient, appoint, includeDateField);
+    fputs(row, stdout);
+}
+
+// Format a single appointment record with patient info. as a table row (returns its length)
+int formatScheduleData(char *out, size_t size, const struct Patient *patient,
+                       const struct Appointment *appoint, int includeDateField)
+{
+    struct Phone phone;
+    char formatted[FORMATTED_PHONE_LEN + 1];
+    int length = 0;
+
+    getPatientPhone(patient, &phone);
+    formatPhone(formatted, phone.number);
     if (includeDateField)
     {
-        printf("%04d-%02d-%02d ", appoint->date.year, appoint->date.month,
-               appoint->date.day);
+        length = snprintf(out, size, "%04d-%02d-%02d ", appoint->date.year,
+                          appoint->date.month, appoint->date.day);
     }
-    printf("%02d:%02d %05d %-15s ", appoint->time.hour, appoint->time.min,
-           patient->patientNumber, patient->name);
+    length += snprintf(out + length, size - length, "%02d:%02d %05d %-15s %s (%s)\n",
+                       appoint->time.hour, appoint->time.min, patient->patientNumber,
+                       patientName(patient), formatted, phone.description);
+    return length;
+}
 
-    displayFormattedPhone(patient->phone.number);
+// Display a recurring series rule with patient info. in tabular format
+void displaySeriesData(const struct Patient *patient, const struct Series *series)
+{
+    struct Date last;
+    int lastDay = seriesLastDay(series);
 
-    printf(" (%s)\n", patient->phone.description);
+    printf("%04d-%02d-%02d %02d:%02d %4dd ", series->start.year, series->start.month,
+           series->start.day, series->time.hour, series->time.min, series->everyDays);
+    if (lastDay == SERIES_OPEN_END)
+    {
+        printf("(no end)   ");
+    }
+    else
+    {
+        dayToDate(lastDay, &last);
+        printf("%04d-%02d-%02d ", last.year, last.month, last.day);
+    }
+    printf("%05d %s\n", patient->patientNumber, patientName(patient));
 }
 
 //////////////////////////////////////
@@ -91,11 +175,12 @@ void menuMain(struct ClinicData *data)
                "=========================\n"
                "1) PATIENT     Management\n"
                "2) APPOINTMENT Management\n"
+               "3) ADMIN       Metrics\n"
                "-------------------------\n"
                "0) Exit System\n"
                "-------------------------\n"
                "Selection: ");
-        selection = inputIntRange(0, 2);
+        selection = inputIntRange(0, 3);
         putchar('\n');
         switch (selection)
         {
@@ -109,17 +194,22 @@ void menuMain(struct ClinicData *data)
             }
             break;
         case 1:
-            menuPatient(data->patients, data->maxPatient);
+            menuPatient(data);
             break;
         case 2:
             menuAppointment(data);
             break;
+        case 3:
+            metricsReport(stdout);
+            displayClinicMemory(data);
+            suspend();
+            break;
         }
     } while (selection);
 }
 
 // Menu: Patient Management
-void menuPatient(struct Patient patient[], int max)
+void menuPatient(struct ClinicData *data)
 {
     int selection;
 
@@ -132,39 +222,47 @@ void menuPatient(struct Patient patient[], int max)
                "3) ADD    Patient\n"
                "4) EDIT   Patient\n"
                "5) REMOVE Patient\n"
+               "6) VIEW   Household\n"
                "-------------------------\n"
                "0) Previous menu\n"
                "-------------------------\n"
                "Selection: ");
-        selection = inputIntRange(0, 5);
+        selection = inputIntRange(0, 6);
         putchar('\n');
         switch (selection)
         {
         case 1:
-            displayAllPatients(patient, max, FMT_TABLE);
+            displayAllPatients(data, FMT_TABLE);
             suspend();
             break;
         case 2:
-            searchPatientData(patient, max);
+            searchPatientData(data);
             break;
         case 3:
-            addPatient(patient, max);
+            addPatient(data);
             suspend();
             break;
         case 4:
-            editPatient(patient, max);
+            editPatient(data);
             break;
         case 5:
-            removePatient(patient, max);
+            removePatient(data);
+            suspend();
+            break;
+        case 6:
+            viewHousehold(data);
             suspend();
             break;
         }
     } while (selection);
 }
 
-// Menu: Patient edit
-void menuPatientEdit(struct Patient *patient)
+// Menu: Patient edit (of the patient in store slot "slot")
+void menuPatientEdit(struct ClinicData *data, int slot)
 {
+    struct Patient *patient = &data->patients[slot];
+    char name[NAME_LEN + 1];
+    struct Phone phone;
     int selection;
 
     do
@@ -173,9 +271,10 @@ void menuPatientEdit(struct Patient *patient)
                "=========================\n"
                "1) NAME : %s\n"
                "2) PHONE: ",
-               patient->patientNumber, patient->name);
+               patient->patientNumber, patientName(patient));
 
-        displayFormattedPhone(patient->phone.number);
+        getPatientPhone(patient, &phone);
+        displayFormattedPhone(phone.number);
 
         printf("\n"
                "-------------------------\n"
@@ -188,13 +287,21 @@ void menuPatientEdit(struct Patient *patient)
         if (selection == 1)
         {
             printf("Name  : ");
-            inputCString(patient->name, 1, NAME_LEN);
+            inputCString(name, 1, NAME_LEN);
+            setPatientName(patient, name);
+            groupPatient(data, slot);
+            publishPatient(data, slot);
+            logPatient(data, CHANGE_PATIENT_PUT, patient);
             putchar('\n');
             printf("Patient record updated!\n\n");
         }
         else if (selection == 2)
         {
-            inputPhoneData(&patient->phone);
+            inputPhoneData(&phone);
+            setPatientPhone(patient, &phone);
+            groupPatient(data, slot);
+            publishPatient(data, slot);
+            logPatient(data, CHANGE_PATIENT_PUT, patient);
             printf("Patient record updated!\n\n");
         }
 
@@ -214,11 +321,14 @@ void menuAppointment(struct ClinicData *data)
                "2) VIEW   Appointments by DATE\n"
                "3) ADD    Appointment\n"
                "4) REMOVE Appointment\n"
+               "5) ADD    Recurring appointments\n"
+               "6) VIEW   Statistics\n"
+               "7) ADD    Household appointments\n"
                "------------------------------\n"
                "0) Previous menu\n"
                "------------------------------\n"
                "Selection: ");
-        selection = inputIntRange(0, 4);
+        selection = inputIntRange(0, 7);
         putchar('\n');
         switch (selection)
         {
@@ -231,48 +341,68 @@ void menuAppointment(struct ClinicData *data)
             suspend();
             break;
         case 3:
-            addAppointment(data->appointments, data->maxAppointments,
-                           data->patients, data->maxPatient);
+            addAppointment(data);
             suspend();
             break;
         case 4:
-            removeAppointment(data->appointments, data->maxAppointments,
-                              data->patients, data->maxPatient);
+            removeAppointment(data);
+            suspend();
+            break;
+        case 5:
+            addSeries(data);
+            suspend();
+            break;
+        case 6:
+            displayAppointmentStats(data);
+            suspend();
+            break;
+        case 7:
+            addHouseholdAppointments(data);
             suspend();
             break;
         }
     } while (selection);
 }
 
-// Display's all patient data in the FMT_FORM | FMT_TABLE format
-void displayAllPatients(const struct Patient patient[], int max, int fmt)
+// Display's all patient data in the FMT_FORM | FMT_TABLE format (a page at a time)
+void displayAllPatients(const struct ClinicData *data, int fmt)
 {
-    int i;
+    int slots[DISPLAY_PAGE_SIZE];
+    int i, count, after = 0, more = 1;
     int eligibleRec = 0;
+    METRIC_START(started);
 
     if (fmt == FMT_TABLE)
     {
         displayPatientTableHeader();
     }
 
-    for (i = 0; i < max; i++)
+    // Each page is timed on its own: the wait between pages is the user's
+    while (more && (count = pagePatients(data, after, slots, DISPLAY_PAGE_SIZE)) > 0)
     {
-        if (patient[i].patientNumber != 0)
+        for (i = 0; i < count; i++)
         {
-            displayPatientData(&patient[i], fmt);
-            eligibleRec = 1;
+            displayPatientData(&data->patients[slots[i]], fmt);
         }
+        eligibleRec = 1;
+        after = data->patients[slots[count - 1]].patientNumber;
+        METRIC_STOP(METRIC_VIEW_PATIENTS, started);
+
+        more = count == DISPLAY_PAGE_SIZE && pagePatients(data, after, slots, 1) == 1 &&
+               suspendPage();
+        METRIC_RESTART(started);
     }
 
     if (eligibleRec == 0)
     {
         printf("*** No records found ***\n");
+        METRIC_STOP(METRIC_VIEW_PATIENTS, started);
     }
     putchar('\n');
 }
 
 // Search for a patient record based on patient number or phone number
-void searchPatientData(const struct Patient patient[], int max)
+void searchPatientData(const struct ClinicData *data)
 {
     int selection;
 
@@ -291,11 +421,11 @@ void searchPatientData(const struct Patient patient[], int max)
         switch (selection)
         {
         case 1:
-            searchPatientByPatientNumber(patient, max);
+            searchPatientByPatientNumber(data);
             suspend();
             break;
         case 2:
-            searchPatientByPhoneNumber(patient, max);
+            searchPatientByPhoneNumber(data);
             suspend();
             break;
         }
@@ -303,41 +433,36 @@ void searchPatientData(const struct Patient patient[], int max)
 }
 
 // Add a new patient record to the patient array
-void addPatient(struct Patient patient[], int max)
+void addPatient(struct ClinicData *data)
 {
-    int i = 0, place = 0;
-    int space = 0;
-
-    for (i = 0; i < max; i++)
-    {
-        if (patient[i].patientNumber == 0)
-        {
-            place = i;
-            space = 1;
-            break;
-        }
-    }
+    struct Patient *patient = data->patients;
+    int place = takeSlot(&data->patientSlots);
 
-    if (space == 0)
+    if (place == -1)
     {
         printf("ERROR: Patient listing is FULL!\n\n");
     }
     else
     {
-        patient[place].patientNumber = nextPatientNumber(patient, max);
+        patient[place].patientNumber = nextPatientNumber(data);
         inputPatient(&patient[place]);
+        indexPatient(data, place);
+        groupPatient(data, place);
+        publishPatient(data, place);
+        logPatient(data, CHANGE_PATIENT_PUT, &patient[place]);
+        dayCacheDropPatient(&data->dayCache, patient[place].patientNumber);
         printf("*** New patient record added ***\n\n");
     }
 }
 
 // Edit a patient record from the patient array
-void editPatient(struct Patient patient[], int max)
+void editPatient(struct ClinicData *data)
 {
     int patientNum;
     int findPatient = -1;
     printf("Enter the patient number: ");
     patientNum = inputIntPositive();
-    findPatient = findPatientIndexByPatientNum(patientNum, patient, max);
+    findPatient = findPatientSlot(data, patientNum);
     putchar('\n');
     if (findPatient == -1)
     {
@@ -345,13 +470,15 @@ void editPatient(struct Patient patient[], int max)
     }
     else
     {
-        menuPatientEdit(&patient[findPatient]);
+        menuPatientEdit(data, findPatient);
+        dayCacheDropPatient(&data->dayCache, patientNum);
     }
 }
 
 // Remove a patient record from the patient array
-void removePatient(struct Patient patient[], int max)
+void removePatient(struct ClinicData *data)
 {
+    struct Patient *patient = data->patients;
     int patientNum;
     int findPatient = 0;
     int valid = 0;
@@ -361,7 +488,7 @@ void removePatient(struct Patient patient[], int max)
     patientNum = inputIntPositive();
     printf("\n");
 
-    findPatient = findPatientIndexByPatientNum(patientNum, patient, max);
+    findPatient = findPatientSlot(data, patientNum);
     if (findPatient == -1)
     {
         printf("ERROR: Patient record not found!\n\n");
@@ -374,16 +501,13 @@ void removePatient(struct Patient patient[], int max)
 
         do
         {
-            scanf(" %c%c", &removeProve, &ch);
+            inputCharPair(&removeProve, &ch);
 
             if (ch == '\n')
             {
                 if (removeProve == 'y' || removeProve == 'Y')
                 {
-                    patient[findPatient].patientNumber = 0;
-                    patient[findPatient].name[0] = '\0';
-                    patient[findPatient].phone.description[0] = '\0';
-                    patient[findPatient].phone.number[0] = '\0';
+                    dropPatient(data, findPatient);
                     valid++;
                     printf("Patient record has been removed!\n\n");
                 }
@@ -407,70 +531,141 @@ void removePatient(struct Patient patient[], int max)
     }
 }
 
-// View ALL scheduled appointments
-void viewAllAppointments(const struct ClinicData *data)
+// Display the household (patients sharing a phone number and surname) of a patient
+void viewHousehold(const struct ClinicData *data)
+{
+    int slots[HOUSEHOLD_MAX_MEMBERS];
+    int i, total;
+
+    printf("Enter the patient number: ");
+    total = findPatientHousehold(data, inputIntPositive(), slots, HOUSEHOLD_MAX_MEMBERS);
+    putchar('\n');
+    if (total == 0)
+    {
+        printf("ERROR: Patient record not found!\n\n");
+    }
+    else
+    {
+        displayPatientTableHeader();
+        for (i = 0; i < total && i < HOUSEHOLD_MAX_MEMBERS; i++)
+        {
+            displayPatientData(&data->patients[slots[i]], FMT_TABLE);
+        }
+        if (total > HOUSEHOLD_MAX_MEMBERS)
+        {
+            printf("(%d more not shown)\n", total - HOUSEHOLD_MAX_MEMBERS);
+        }
+        putchar('\n');
+    }
+}
+
+// View ALL scheduled appointments (a page at a time)
+void viewAllAppointments(struct ClinicData *data)
 {
-    int i, j;
-    sortData(data->appointments, data->maxAppointments);
+    struct AppointmentCursor cursor, peek;
+    int slots[DISPLAY_PAGE_SIZE];
+    int *order;
+    int i, j, count, more = 1;
+    METRIC_START(started);
     displayScheduleTableHeader(NULL, 1);
 
-    for (i = 0; i < data->maxAppointments; i++)
+    // Bookings are read in date order from the interval index, so the
+    // store is never sorted and each page costs only its own rows
+    startAppointmentCursor(&cursor);
+    while (more && (count = pageAppointments(data, &cursor, slots, DISPLAY_PAGE_SIZE)) > 0)
     {
-        for (j = 0; j < data->maxPatient; j++)
+        for (i = 0; i < count; i++)
         {
-            if (data->appointments[i].patientNumber && data->patients[j].patientNumber)
+            j = findPatientSlot(data, data->appointments[slots[i]].patientNumber);
+            if (j != -1)
             {
-                if (data->appointments[i].patientNumber == data->patients[j].patientNumber)
-                {
-                    displayScheduleData(&data->patients[j], &data->appointments[i], 1);
-                }
+                displayScheduleData(&data->patients[j], &data->appointments[slots[i]], 1);
             }
         }
+        METRIC_STOP(METRIC_VIEW_ALL, started);
+
+        peek = cursor;
+        more = count == DISPLAY_PAGE_SIZE && pageAppointments(data, &peek, slots, 1) == 1 &&
+               suspendPage();
+        METRIC_RESTART(started);
     }
     putchar('\n');
+
+    // Series are listed as rules: an open-ended series has no "all" occurrences
+    if (activeSeries(data))
+    {
+        printf("Recurring Series\n\n"
+               "First      Time  Every Last       Pat.# Name\n"
+               "---------- ----- ----- ---------- ----- ---------------\n");
+
+        // Listed in store order (cancellations reorder the live list)
+        count = data->seriesSlots.liveCount;
+        order = malloc(sizeof(*order) * count);
+        if (order != NULL)
+        {
+            memcpy(order, data->seriesSlots.liveSlots, sizeof(*order) * count);
+            qsort(order, count, sizeof(*order), compareSlots);
+        }
+        for (i = 0; order != NULL && i < count; i++)
+        {
+            j = findPatientSlot(data, data->series[order[i]].patientNumber);
+            if (j != -1)
+            {
+                displaySeriesData(&data->patients[j], &data->series[order[i]]);
+            }
+        }
+        free(order);
+        putchar('\n');
+    }
 }
 
 // View appointment schedule for the user input date
-void viewAppointmentSchedule(const struct ClinicData *data)
+void viewAppointmentSchedule(struct ClinicData *data)
 {
-    int i, j;
+    const struct DayCacheEntry *cached;
     struct Date date;
+    METRIC_START(started);
     inputDate(&date);
     printf("\n");
-    sortData(data->appointments, data->maxAppointments);
+    METRIC_RESTART(started);
+
+    // Repeat views of a day print the rows rendered the first time
     displayScheduleTableHeader(&date, 0);
-    for (i = 0; i < data->maxAppointments; i++)
+    cached = dayCacheFind(&data->dayCache, dateToDay(&date));
+    if (cached != NULL)
     {
-        for (j = 0; j < data->maxAppointments; j++)
-        {
-            if (data->appointments[i].patientNumber == data->patients[j].patientNumber &&
-                data->appointments[i].date.year == date.year &&
-                data->appointments[i].date.month == date.month &&
-                data->appointments[i].date.day == date.day)
-            {
-                displayScheduleData(&data->patients[j], &data->appointments[i], 0);
-            }
-        }
+        fwrite(cached->text, 1, cached->length, stdout);
+    }
+    else
+    {
+        renderDaySchedule(data, &date);
     }
     printf("\n");
+    METRIC_STOP(METRIC_VIEW_DAY, started);
 }
 
 // Add an appointment record to the appointment array
-void addAppointment(struct Appointment *app, const int maxAppointments, struct Patient *pt, int maxPatients)
+void addAppointment(struct ClinicData *data)
 {
+    struct Appointment appoint = {0};
     int serPatientNum, findPatient = -1;
-    int i, count = 0, slot = 0;
-    struct Date date = {0};
-    struct Time time = {0};
+    int count = 0, waiting;
+    char option;
+    struct Date date = {0}, freeDate;
+    struct Time time = {0}, freeTime;
 
     printf("Patient Number: ");
     serPatientNum = inputIntPositive();
-    findPatient = findPatientIndexByPatientNum(serPatientNum, pt, maxPatients);
+    findPatient = findPatientSlot(data, serPatientNum);
 
     if (findPatient == -1)
     {
         printf("ERROR: Patient record not found!\n\n");
     }
+    else if (nextAvailableSlot(data) == -1)
+    {
+        printf("ERROR: Appointment listing is FULL!\n\n");
+    }
     else
     {
 
@@ -479,57 +674,94 @@ void addAppointment(struct Appointment *app, const int maxAppointments, struct P
             inputDate(&date);
             inputTime(&time);
 
-            for (i = 0; i < maxAppointments; i++)
+            if (!isTimeslotAvailable(data, &date, &time))
             {
-                if (time.min == app[i].time.min &&
-                    time.hour == app[i].time.hour &&
-                    date.day == app[i].date.day &&
-                    date.month == app[i].date.month &&
-                    date.year == app[i].date.year)
+                putchar('\n');
+                printf("ERROR: Appointment timeslot is not available!\n");
+                if (findNextTimeslot(data, &date, &time, 1, &freeDate, &freeTime))
                 {
-                    putchar('\n');
-                    printf("ERROR: Appointment timeslot is not available!\n\n");
-                    count++;
-                    break;
+                    printf("Next available: %04d-%02d-%02d %02d:%02d\n",
+                           freeDate.year, freeDate.month, freeDate.day,
+                           freeTime.hour, freeTime.min);
                 }
-                else
+                putchar('\n');
+                count++;
+
+                // A full day can be waited on: the next cancellation goes to the waitlist
+                if (isValidDate(&date) && isDayFullyBooked(data, &date))
                 {
-                    count = 0;
+                    printf("The day is fully booked. Join the waitlist? (y,n): ");
+                    option = inputCharOption("yYnN");
+                    if (option == 'y' || option == 'Y')
+                    {
+                        count = -1;
+                    }
+                    putchar('\n');
                 }
             }
-        } while (count != 0);
+            else
+            {
+                count = 0;
+            }
+        } while (count > 0);
 
-        if (count == 0)
+        if (count == -1)
         {
-            while ((time.hour < START_HOUR || time.hour > END_HOUR) || (time.hour == END_HOUR && time.min > 0) || (time.min % MINUTE_INTERVAL != 0))
+            printf("Urgency (%d = routine .. %d = urgent): ", WAITLIST_ROUTINE, WAITLIST_URGENT);
+            waiting = joinWaitlist(data, serPatientNum, &date,
+                                   inputIntRange(WAITLIST_ROUTINE, WAITLIST_URGENT));
+            putchar('\n');
+            if (waiting > 0)
+            {
+                printf("*** Added to the waitlist for %04d-%02d-%02d (%d waiting) ***\n\n",
+                       date.year, date.month, date.day, waiting);
+            }
+            else
+            {
+                printf("ERROR: Waitlist is FULL!\n\n");
+            }
+        }
+        else if (count == 0)
+        {
+            while (!isValidAppointmentTime(&time))
             {
                 printf("ERROR: Time must be between %02d:00 and %02d:00 in %02d minute intervals.\n\n", START_HOUR, END_HOUR, MINUTE_INTERVAL);
                 inputTime(&time);
             }
 
-            slot = nextAvailableSlot(app, maxAppointments);
-            app[slot].date = date;
-            app[slot].time = time;
-            app[slot].patientNumber = serPatientNum;
+            appoint.patientNumber = serPatientNum;
+            appoint.date = date;
+            appoint.time = time;
+            appoint.resource = RESOURCE_ANY;
             putchar('\n');
-            printf("*** Appointment scheduled! ***\n\n");
+            if (bookAppointment(data, &appoint) == BOOK_OK)
+            {
+                printf("*** Appointment scheduled! ***\n\n");
+            }
+            else
+            {
+                printf("ERROR: Appointment timeslot is not available!\n\n");
+            }
         }
     }
 }
 
 // Remove an appointment record from the appointment array
-void removeAppointment(struct Appointment *app, const int maxAppointments, struct Patient *pt, int maxPatients)
+void removeAppointment(struct ClinicData *data)
 {
+    struct Patient *pt = data->patients;
     int serPatientNum, findPatient = -1;
-    int findApp = -1;
+    int findApp = -1, findSeries = -1;
     char removeProve, ch;
     int valid = 0;
     char option[10] = "yn";
     struct Date date = {0};
+    struct Series rule;
+    int *days, i, n;
 
     printf("Patient Number: ");
     serPatientNum = inputIntPositive();
-    findPatient = findPatientIndexByPatientNum(serPatientNum, pt, maxPatients);
+    findPatient = findPatientSlot(data, serPatientNum);
 
     if (findPatient == -1)
     {
@@ -538,9 +770,13 @@ void removeAppointment(struct Appointment *app, const int maxAppointments, struc
     else
     {
         inputDate(&date);
-        findApp = checkAppointment(serPatientNum, date, app, maxAppointments);
-
+        findApp = chooseAppointment(data, serPatientNum, &date);
         if (findApp == -1)
+        {
+            findSeries = chooseSeries(data, serPatientNum, &date);
+        }
+
+        if (findApp == -1 && findSeries == -1)
         {
             printf("ERROR: No appointment for this date!\n\n");
         }
@@ -548,25 +784,44 @@ void removeAppointment(struct Appointment *app, const int maxAppointments, struc
         {
             putchar('\n');
             displayPatientData(&pt[findPatient], FMT_FORM);
-            printf("Are you sure you want to remove this appointment (y,n): ");
+            printf("Are you sure you want to remove this %s (y,n): ",
+                   findApp != -1 ? "appointment" : "recurring series");
 
             do
             {
-                scanf(" %c%c", &removeProve, &ch);
+                inputCharPair(&removeProve, &ch);
 
                 if (ch == '\n')
                 {
-                    if (removeProve == 'y' || removeProve == 'Y')
+                    if ((removeProve == 'y' || removeProve == 'Y') && findApp == -1)
+                    {
+                        rule = data->series[findSeries];
+                        cancelSeries(data, findSeries);
+                        valid++;
+                        putchar('\n');
+                        printf("Recurring series has been removed!\n\n");
+
+                        // Only days someone waits on need a look
+                        n = waitlistDays(&data->waitlist, NULL, 0);
+                        days = n ? malloc(sizeof(*days) * n) : NULL;
+                        n = days != NULL ? waitlistDays(&data->waitlist, days, n) : 0;
+                        for (i = 0; i < n; i++)
+                        {
+                            if (seriesOccursOn(&rule, days[i]))
+                            {
+                                dayToDate(days[i], &date);
+                                reportPromotions(data, &date);
+                            }
+                        }
+                        free(days);
+                    }
+                    else if (removeProve == 'y' || removeProve == 'Y')
                     {
-                        app[findApp].patientNumber = 0;
-                        app[findApp].date.year = 0;
-                        app[findApp].date.month = 0;
-                        app[findApp].date.day = 0;
-                        app[findApp].time.hour = 0;
-                        app[findApp].time.min = 0;
+                        dropAppointment(data, findApp);
                         valid++;
                         putchar('\n');
                         printf("Appointment record has been removed!\n\n");
+                        reportPromotions(data, &date);
                     }
                     else if (removeProve == 'n' || removeProve == 'N')
                     {
@@ -591,12 +846,244 @@ void removeAppointment(struct Appointment *app, const int maxAppointments, struc
     }
 }
 
+// Pick the patient's appointment on the date, asking which one when there are
+// several (returns its store slot, -1 if there is none)
+static int chooseAppointment(const struct ClinicData *data, int patientNumber,
+                             const struct Date *date)
+{
+    const struct Appointment *app;
+    int *slots, total, slot, i;
+
+    total = findPatientAppointments(data, patientNumber, date, NULL, 0);
+    slots = total ? malloc(sizeof(*slots) * total) : NULL;
+    if (slots == NULL)
+    {
+        return total ? findPatientAppointment(data, patientNumber, date) : -1;
+    }
+    findPatientAppointments(data, patientNumber, date, slots, total);
+    slot = slots[0];
+    if (total > 1)
+    {
+        printf("\nThe patient has %d appointments on this date:\n", total);
+        for (i = 0; i < total; i++)
+        {
+            app = &data->appointments[slots[i]];
+            printf("%d) %02d:%02d for %d minutes (resource %d)\n", i + 1, app->time.hour,
+                   app->time.min, app->duration, app->resource);
+        }
+        printf("Appointment to remove: ");
+        slot = slots[inputIntRange(1, total) - 1];
+    }
+    free(slots);
+    return slot;
+}
+
+// Pick the patient's series with an occurrence on the date, asking which one when
+// there are several (returns its store slot, -1 if there is none)
+static int chooseSeries(const struct ClinicData *data, int patientNumber, const struct Date *date)
+{
+    const struct Series *rule;
+    int *slots, total, slot, i;
+
+    total = findPatientSeriesOn(data, patientNumber, date, NULL, 0);
+    slots = total ? malloc(sizeof(*slots) * total) : NULL;
+    if (slots == NULL)
+    {
+        return total ? findPatientSeries(data, patientNumber, date) : -1;
+    }
+    findPatientSeriesOn(data, patientNumber, date, slots, total);
+    slot = slots[0];
+    if (total > 1)
+    {
+        printf("\nThe patient has %d recurring series on this date:\n", total);
+        for (i = 0; i < total; i++)
+        {
+            rule = &data->series[slots[i]];
+            printf("%d) every %d day(s) from %04d-%02d-%02d at %02d:%02d (resource %d)\n",
+                   i + 1, rule->everyDays, rule->start.year, rule->start.month,
+                   rule->start.day, rule->time.hour, rule->time.min, rule->resource);
+        }
+        printf("Series to remove: ");
+        slot = slots[inputIntRange(1, total) - 1];
+    }
+    free(slots);
+    return slot;
+}
+
+// Add a recurring appointment series
+void addSeries(struct ClinicData *data)
+{
+    struct Series rule = {0};
+
+    printf("Patient Number: ");
+    rule.patientNumber = inputIntPositive();
+
+    if (findPatientSlot(data, rule.patientNumber) == -1)
+    {
+        printf("ERROR: Patient record not found!\n\n");
+    }
+    else if (peekSlot(&data->seriesSlots) == -1)
+    {
+        printf("ERROR: Recurring series listing is FULL!\n\n");
+    }
+    else
+    {
+        printf("First appointment\n");
+        inputDate(&rule.start);
+        inputTime(&rule.time);
+        while (!isValidAppointmentTime(&rule.time))
+        {
+            printf("ERROR: Time must be between %02d:00 and %02d:00 in %02d minute intervals.\n\n", START_HOUR, END_HOUR, MINUTE_INTERVAL);
+            inputTime(&rule.time);
+        }
+        printf("Repeat every (days, 7 = weekly): ");
+        rule.everyDays = inputIntRange(1, SERIES_MAX_EVERY);
+        printf("Occurrences (0 = until a date) : ");
+        rule.count = inputIntRange(0, SERIES_MAX_COUNT);
+        if (rule.count == 0)
+        {
+            printf("Last date\n");
+            inputDate(&rule.until);
+        }
+        rule.resource = RESOURCE_ANY;
+        putchar('\n');
+
+        switch (bookSeries(data, &rule))
+        {
+        case BOOK_OK:
+            printf("*** Recurring appointments scheduled! ***\n\n");
+            break;
+        case BOOK_BAD_DATE:
+            printf("ERROR: Last date is before the first appointment!\n\n");
+            break;
+        case BOOK_SLOT_TAKEN:
+            printf("ERROR: An occurrence's timeslot is not available!\n\n");
+            break;
+        default:
+            printf("ERROR: Recurring series listing is FULL!\n\n");
+            break;
+        }
+    }
+}
+
+// Add back-to-back appointments for every patient in a household
+void addHouseholdAppointments(struct ClinicData *data)
+{
+    struct Date date = {0};
+    struct Time time = {0};
+    int patientNumber;
+
+    printf("Patient Number: ");
+    patientNumber = inputIntPositive();
+
+    if (findPatientSlot(data, patientNumber) == -1)
+    {
+        printf("ERROR: Patient record not found!\n\n");
+    }
+    else
+    {
+        printf("First appointment\n");
+        inputDate(&date);
+        inputTime(&time);
+        while (!isValidAppointmentTime(&time))
+        {
+            printf("ERROR: Time must be between %02d:00 and %02d:00 in %02d minute intervals.\n\n", START_HOUR, END_HOUR, MINUTE_INTERVAL);
+            inputTime(&time);
+        }
+        putchar('\n');
+
+        switch (bookHousehold(data, patientNumber, &date, &time))
+        {
+        case BOOK_OK:
+            printf("*** Household appointments scheduled! ***\n\n");
+            break;
+        case BOOK_BAD_DATE:
+            printf("ERROR: Invalid date!\n\n");
+            break;
+        case BOOK_BAD_TIME:
+            printf("ERROR: The appointments run past %02d:00!\n\n", END_HOUR);
+            break;
+        case BOOK_SLOT_TAKEN:
+            printf("ERROR: Appointment timeslots are not available!\n\n");
+            break;
+        default:
+            printf("ERROR: Appointment listing is FULL!\n\n");
+            break;
+        }
+    }
+}
+
+// Display the appointment statistics report
+void displayAppointmentStats(const struct ClinicData *data)
+{
+    const struct ClinicStats *stats = &data->stats;
+    struct Date date;
+    int days[STATS_TOP_DAYS], counts[STATS_TOP_DAYS];
+    int *months, *monthCounts;
+    int i, n, slot, minutes;
+    long long capacity = (long long)stats->busyDays * data->resourceCount;
+
+    printf("Appointment Statistics\n"
+           "==============================\n");
+    printf("Bookings         : %lld on %d day(s)\n", stats->bookings, stats->busyDays);
+    printf("Recurring series : %d (not counted)\n",
+           data->seriesSlots.liveCount);
+    printf("Resources        : %d\n\n", data->resourceCount);
+
+    printf("Busiest Days\n"
+           "Date       Bookings\n"
+           "---------- --------\n");
+    n = statsTopDays(stats, days, counts, STATS_TOP_DAYS);
+    for (i = 0; i < n; i++)
+    {
+        dayToDate(days[i], &date);
+        printf("%04d-%02d-%02d %8d\n", date.year, date.month, date.day, counts[i]);
+    }
+    if (n == 0)
+    {
+        printf("*** No records found ***\n");
+    }
+    putchar('\n');
+
+    printf("Bookings by Month\n"
+           "Month   Bookings\n"
+           "------- --------\n");
+    months = malloc(sizeof(*months) * (stats->months.used ? stats->months.used : 1));
+    monthCounts = malloc(sizeof(*monthCounts) * (stats->months.used ? stats->months.used : 1));
+    n = months != NULL && monthCounts != NULL
+            ? statsMonths(stats, months, monthCounts, stats->months.used)
+            : 0;
+    for (i = 0; i < n; i++)
+    {
+        printf("%04d-%02d %8d\n", months[i] / 12, months[i] % 12 + 1, monthCounts[i]);
+    }
+    if (n == 0)
+    {
+        printf("*** No records found ***\n");
+    }
+    free(months);
+    free(monthCounts);
+    putchar('\n');
+
+    // A slot's utilization is its share of every resource on every booked day
+    printf("Slot Utilization\n"
+           "Time  Bookings Used\n"
+           "----- -------- ----\n");
+    for (slot = 0; slot < calendarSlotsPerDay(); slot++)
+    {
+        minutes = START_HOUR * 60 + slot * MINUTE_INTERVAL;
+        printf("%02d:%02d %8lld %3lld%%\n", minutes / 60, minutes % 60, stats->slotBookings[slot],
+               capacity ? stats->slotBookings[slot] * 100 / capacity : 0);
+    }
+    putchar('\n');
+}
+
 //////////////////////////////////////
 // UTILITY FUNCTIONS
 //////////////////////////////////////
 
 // Search and display patient record by patient number (form)
-void searchPatientByPatientNumber(const struct Patient patient[], int max)
+void searchPatientByPatientNumber(const struct ClinicData *data)
 {
     int serPatientNum;
     int findIndex = 0;
@@ -604,34 +1091,41 @@ void searchPatientByPatientNumber(const struct Patient patient[], int max)
     serPatientNum = inputIntPositive();
     // clearInputBuffer();
     printf("\n");
-    findIndex = findPatientIndexByPatientNum(serPatientNum, patient, max);
+    findIndex = findPatientSlot(data, serPatientNum);
     if (findIndex == -1)
     {
         printf("*** No records found ***\n");
     }
     else
     {
-        displayPatientData(&patient[findIndex], FMT_FORM);
+        displayPatientData(&data->patients[findIndex], FMT_FORM);
     }
 
     putchar('\n');
 }
 
 // Search and display patient records by phone number (tabular)
-void searchPatientByPhoneNumber(const struct Patient patient[], int max)
+void searchPatientByPhoneNumber(const struct ClinicData *data)
 {
+    const struct Patient *patient;
     char serPhoneNum[PHONE_LEN + 1] = {0};
+    unsigned long long number;
     int i;
     int match = 0;
+    METRIC_START(started);
     printf("Search by phone number: ");
     inputCString(serPhoneNum, PHONE_LEN, PHONE_LEN);
     putchar('\n');
+    METRIC_RESTART(started);
     displayPatientTableHeader();
-    for (i = 0; i < max; i++)
+    number = parsePhoneNumber(serPhoneNum);
+    // Only live patients are visited, in patient number order
+    for (i = 0; i < data->patientCount && number != PHONE_NO_NUMBER; i++)
     {
-        if (strcmp(patient[i].phone.number, serPhoneNum) == 0)
+        patient = &data->patients[data->patientOrder[i].slot];
+        if (patientPhoneNumber(patient) == number)
         {
-            displayPatientData(&patient[i], FMT_TABLE);
+            displayPatientData(patient, FMT_TABLE);
             match = 1;
         }
     }
@@ -642,24 +1136,14 @@ void searchPatientByPhoneNumber(const struct Patient patient[], int max)
         printf("*** No records found ***\n");
     }
     putchar('\n');
+    METRIC_STOP(METRIC_PHONE_SEARCH, started);
 }
 
 // Get the next highest patient number
-int nextPatientNumber(const struct Patient patient[], int max)
+int nextPatientNumber(const struct ClinicData *data)
 {
-    int i;
-    int patientNumLast = 0;
-    int patientNumNext = 0;
-    for (i = 0; i < max; i++)
-    {
-        if (patientNumLast < patient[i].patientNumber)
-        {
-            patientNumLast = patient[i].patientNumber;
-        }
-    }
-
-    patientNumNext = patientNumLast + 1;
-    return patientNumNext;
+    // The number index ends with the highest number in use
+    return data->patientCount ? data->patientOrder[data->patientCount - 1].patientNumber + 1 : 1;
 }
 
 // Find the patient array index by patient number (returns -1 if not found)
@@ -677,95 +1161,1545 @@ int findPatientIndexByPatientNum(int patientNumber, const struct Patient patient
     return -1;
 }
 
-// Sort the data by date (using bubble sort)
-void sortData(struct Appointment appoints[], int max)
+// First position in the number index at or above a patient number
+static int patientOrderBound(const struct ClinicData *data, int patientNumber)
 {
-    int i, j;
-    struct Appointment temp;
+    int low = 0, high = data->patientCount, mid;
 
-    for (i = max - 1; i > 0; i--)
+    while (low < high)
     {
-        for (j = 0; j < i; j++)
+        mid = low + (high - low) / 2;
+        if (data->patientOrder[mid].patientNumber < patientNumber)
         {
-            if (appoints[j].date.year != appoints[j + 1].date.year)
-            {
-                if (appoints[j].date.year > appoints[j + 1].date.year)
-                {
-                    temp = appoints[j];
-                    appoints[j] = appoints[j + 1];
-                    appoints[j + 1] = temp;
-                }
-            }
-            else if (appoints[j].date.month != appoints[j + 1].date.month)
-            {
-                if (appoints[j].date.month > appoints[j + 1].date.month)
-                {
-                    temp = appoints[j];
-                    appoints[j] = appoints[j + 1];
-                    appoints[j + 1] = temp;
-                }
-            }
-            else if (appoints[j].date.day != appoints[j + 1].date.day)
-            {
-                if (appoints[j].date.day > appoints[j + 1].date.day)
-                {
-                    temp = appoints[j];
-                    appoints[j] = appoints[j + 1];
-                    appoints[j + 1] = temp;
-                }
-            }
-            else if (appoints[j].time.hour != appoints[j + 1].time.hour)
-            {
-                if (appoints[j].time.hour > appoints[j + 1].time.hour)
-                {
-                    temp = appoints[j];
-                    appoints[j] = appoints[j + 1];
-                    appoints[j + 1] = temp;
-                }
-            }
-            else if (appoints[j].time.min != appoints[j + 1].time.min)
-            {
-                if (appoints[j].time.min > appoints[j + 1].time.min)
-                {
-                    temp = appoints[j];
-                    appoints[j] = appoints[j + 1];
-                    appoints[j + 1] = temp;
-                }
-            }
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
         }
     }
+    return low;
 }
 
-// Check the next available slot for appointment
-int nextAvailableSlot(struct Appointment appoints[], int max)
+// Find the patient store slot of a patient number through the number index
+// (returns -1 if not found)
+int findPatientSlot(const struct ClinicData *data, int patientNumber)
 {
-    int i;
-    int slot = 0;
-    for (i = 0; i < max; i++)
+    int at, found = -1;
+    METRIC_START(started);
+
+    at = patientOrderBound(data, patientNumber);
+    if (patientNumber > 0 && at < data->patientCount &&
+        data->patientOrder[at].patientNumber == patientNumber)
     {
-        if (appoints[i].patientNumber < 1)
-        {
-            slot = i;
-        }
+        found = data->patientOrder[at].slot;
     }
-    return slot;
+    METRIC_STOP(METRIC_FIND_PATIENT, started);
+    return found;
 }
 
-// Check if the appointment exists
-int checkAppointment(int patientNumber, struct Date date, struct Appointment *app, int max)
+// Order of two sort keys (date and time, then store order so the sort is stable)
+static int compareSortKeys(const void *a, const void *b)
 {
-    int i;
+    const struct SortKey *x = a, *y = b;
 
-    for (i = 0; i < max; i++)
+    if (x->key != y->key)
     {
-        if (patientNumber == app[i].patientNumber && date.year == app[i].date.year && date.month == app[i].date.month && date.day == app[i].date.day)
-        {
+        return x->key < y->key ? -1 : 1;
+    }
+    return (x->index > y->index) - (x->index < y->index);
+}
+
+// Sort the live appointments by date and time to the front of the array, the empty
+// records after them (stable; returns the live count, -1 and unchanged if out of memory)
+int sortData(struct Appointment appoints[], int max)
+{
+    struct SortKey *keys;
+    struct Appointment *live;
+    int *days;
+    int i, count = 0;
+    METRIC_START(started);
+
+    keys = malloc(sizeof(*keys) * (max ? max : 1));
+    live = malloc(sizeof(*live) * (max ? max : 1));
+    days = malloc(sizeof(*days) * (max ? max : 1));
+    if (keys != NULL && live != NULL && days != NULL)
+    {
+        // Empty records are dropped before keying: they only fill the tail
+        for (i = 0; i < max; i++)
+        {
+            if (appoints[i].patientNumber > 0)
+            {
+                live[count++] = appoints[i];
+            }
+        }
+
+        // One day-number key per record replaces the year/month/day/hour/minute
+        // comparisons
+        datesToDays(&live[0].date, sizeof(*live), days, count);
+        for (i = 0; i < count; i++)
+        {
+            keys[i].key = (long long)days[i] * MINUTES_PER_DAY +
+                          live[i].time.hour * 60 + live[i].time.min;
+            keys[i].index = i;
+        }
+        qsort(keys, count, sizeof(*keys), compareSortKeys);
+        for (i = 0; i < count; i++)
+        {
+            appoints[i] = live[keys[i].index];
+        }
+        memset(&appoints[count], 0, sizeof(*appoints) * (max - count));
+    }
+    else
+    {
+        count = -1;
+    }
+    free(keys);
+    free(live);
+    free(days);
+    METRIC_STOP(METRIC_SORT, started);
+    return count;
+}
+
+// Check the next available slot for appointment (returns -1 if the listing is full)
+int nextAvailableSlot(const struct ClinicData *data)
+{
+    return peekSlot(&data->appointmentSlots);
+}
+
+// Check if the appointment exists
+int checkAppointment(int patientNumber, struct Date date, struct Appointment *app, int max)
+{
+    int i;
+
+    for (i = 0; i < max; i++)
+    {
+        if (patientNumber == app[i].patientNumber && date.year == app[i].date.year && date.month == app[i].date.month && date.day == app[i].date.day)
+        {
             return i;
         }
     }
     return -1;
 }
 
+// Find a patient's appointment on a date through the interval index (returns the
+// lowest matching store slot, -1 if there is none)
+int findPatientAppointment(const struct ClinicData *data, int patientNumber,
+                           const struct Date *date)
+{
+    const struct Interval *item;
+    struct Time midnight = {0, 0};
+    long long from = dateTimeKey(date, &midnight);
+    int resource, slot, found = -1;
+
+    // Only the day's bookings are visited, not every store slot
+    for (resource = 0; resource < data->resourceCount; resource++)
+    {
+        for (item = scheduleFirst(&data->schedule, resource, from);
+             item != NULL && item->start < from + MINUTES_PER_DAY; item = scheduleNext(item))
+        {
+            slot = item->slot;
+            if (data->appointments[slot].patientNumber == patientNumber &&
+                (found == -1 || slot < found))
+            {
+                found = slot;
+            }
+        }
+    }
+    return found;
+}
+
+// Copy up to "max" store slots of a patient's appointments on a date in time order,
+// then resource order (returns the total)
+int findPatientAppointments(const struct ClinicData *data, int patientNumber,
+                            const struct Date *date, int slots[], int max)
+{
+    const struct Appointment *app;
+    const struct Interval *item;
+    struct Time midnight = {0, 0};
+    long long from = dateTimeKey(date, &midnight);
+    int resource, at, total = 0;
+
+    // Resources are walked in order, so each booking goes in after any at its time
+    for (resource = 0; resource < data->resourceCount; resource++)
+    {
+        for (item = scheduleFirst(&data->schedule, resource, from);
+             item != NULL && item->start < from + MINUTES_PER_DAY; item = scheduleNext(item))
+        {
+            if (data->appointments[item->slot].patientNumber != patientNumber)
+            {
+                continue;
+            }
+            if (total < max)
+            {
+                for (at = total; at > 0; at--)
+                {
+                    app = &data->appointments[slots[at - 1]];
+                    if (dateTimeKey(&app->date, &app->time) <= item->start)
+                    {
+                        break;
+                    }
+                    slots[at] = slots[at - 1];
+                }
+                slots[at] = item->slot;
+            }
+            total++;
+        }
+    }
+    return total;
+}
+
+// Find the booking of a patient at the appointment's date, time and resource
+// (returns its store slot, -1 if there is none)
+int findAppointmentAt(const struct ClinicData *data, const struct Appointment *appoint)
+{
+    const struct Interval *item;
+    long long start = dateTimeKey(&appoint->date, &appoint->time);
+
+    for (item = scheduleFirst(&data->schedule, appoint->resource, start);
+         item != NULL && item->start == start; item = scheduleNext(item))
+    {
+        if (data->appointments[item->slot].patientNumber == appoint->patientNumber)
+        {
+            return item->slot;
+        }
+    }
+    return -1;
+}
+
+// Check if the time is within clinic hours on a MINUTE_INTERVAL boundary
+int isValidAppointmentTime(const struct Time *time)
+{
+    return !((time->hour < START_HOUR || time->hour > END_HOUR) ||
+             (time->hour == END_HOUR && time->min > 0) ||
+             (time->min % MINUTE_INTERVAL != 0));
+}
+
+// Check if an appointment of "minutes" starting at time ends within clinic hours
+int isValidAppointmentLength(const struct Time *time, int minutes)
+{
+    return minutes > 0 && minutes % MINUTE_INTERVAL == 0 &&
+           time->hour * 60 + time->min + minutes <= END_HOUR * 60 + MINUTE_INTERVAL;
+}
+
+// Check if the date and time slot is free on some resource (returns 1 if available)
+int isTimeslotAvailable(const struct ClinicData *data, const struct Date *date,
+                        const struct Time *time)
+{
+    // Grid slots are answered by the calendar unless a series might hold
+    // them, anything else by the interval index
+    if (calendarSlot(time) != -1 &&
+        (calendarIsBooked(&data->calendar, date, time) || !activeSeries(data)))
+    {
+        return !calendarIsBooked(&data->calendar, date, time);
+    }
+    return findFreeResource(data, date, time, MINUTE_INTERVAL) != -1;
+}
+
+// Find the lowest resource free for "minutes" from date/time (returns -1 if all are busy)
+int findFreeResource(const struct ClinicData *data, const struct Date *date,
+                     const struct Time *time, int minutes)
+{
+    long long start = dateTimeKey(date, time);
+
+    return freeResource(data, start, start + minutes);
+}
+
+// Copy up to "max" of a resource's bookings on a date in time order (returns the total)
+int resourceDaySchedule(const struct ClinicData *data, int resource, const struct Date *date,
+                        struct Appointment appoints[], int max)
+{
+    const struct Interval *item;
+    const struct Series *rule;
+    struct Appointment occurrence;
+    struct Time midnight = {0, 0};
+    long long from = dateTimeKey(date, &midnight);
+    int i, total = 0, day = dateToDay(date);
+
+    if (resource < 0 || resource >= data->resourceCount)
+    {
+        return 0;
+    }
+    for (item = scheduleFirst(&data->schedule, resource, from);
+         item != NULL && item->start < from + MINUTES_PER_DAY; item = scheduleNext(item))
+    {
+        insertByTime(appoints, max, &total, &data->appointments[item->slot]);
+    }
+    for (i = 0; i < data->seriesSlots.liveCount; i++)
+    {
+        rule = &data->series[data->seriesSlots.liveSlots[i]];
+        if (rule->resource == resource && seriesOccursOn(rule, day))
+        {
+            seriesOccurrence(rule, day, &occurrence);
+            insertByTime(appoints, max, &total, &occurrence);
+        }
+    }
+    return total;
+}
+
+// Copy up to "max" of the date's bookings, series occurrences included, in time order
+// (returns the total)
+int clinicDaySchedule(const struct ClinicData *data, const struct Date *date,
+                      struct Appointment appoints[], int max)
+{
+    const struct Interval *item;
+    const struct Series *rule;
+    struct Appointment occurrence;
+    struct Time midnight = {0, 0};
+    long long from = dateTimeKey(date, &midnight);
+    int resource, i, total = 0, day = dateToDay(date);
+
+    for (resource = 0; resource < data->resourceCount; resource++)
+    {
+        for (item = scheduleFirst(&data->schedule, resource, from);
+             item != NULL && item->start < from + MINUTES_PER_DAY; item = scheduleNext(item))
+        {
+            insertByTime(appoints, max, &total, &data->appointments[item->slot]);
+        }
+    }
+    for (i = 0; i < data->seriesSlots.liveCount; i++)
+    {
+        rule = &data->series[data->seriesSlots.liveSlots[i]];
+        if (seriesOccursOn(rule, day))
+        {
+            seriesOccurrence(rule, day, &occurrence);
+            insertByTime(appoints, max, &total, &occurrence);
+        }
+    }
+    return total;
+}
+
+// Validate and store a booking (returns BOOK_OK or a BOOK_ error code)
+static int placeAppointment(struct ClinicData *data, const struct Appointment *appoint)
+{
+    struct Appointment record = *appoint;
+    long long start;
+    int slot;
+
+    if (findPatientSlot(data, appoint->patientNumber) == -1)
+    {
+        return BOOK_NO_PATIENT;
+    }
+    if (!isValidDate(&appoint->date))
+    {
+        return BOOK_BAD_DATE;
+    }
+    if (record.duration == 0)
+    {
+        record.duration = MINUTE_INTERVAL;
+    }
+    if (!isValidAppointmentTime(&record.time) ||
+        !isValidAppointmentLength(&record.time, record.duration))
+    {
+        return BOOK_BAD_TIME;
+    }
+
+    start = dateTimeKey(&record.date, &record.time);
+    if (record.resource == RESOURCE_ANY)
+    {
+        record.resource = freeResource(data, start, start + record.duration);
+        if (record.resource == -1)
+        {
+            return BOOK_SLOT_TAKEN;
+        }
+    }
+    else if (record.resource < 0 || record.resource >= data->resourceCount)
+    {
+        return BOOK_BAD_RESOURCE;
+    }
+    else if (resourceBusy(data, record.resource, start, start + record.duration))
+    {
+        return BOOK_SLOT_TAKEN;
+    }
+
+    slot = takeSlot(&data->appointmentSlots);
+    if (slot == -1)
+    {
+        return BOOK_FULL;
+    }
+    if (!scheduleInsert(&data->schedule, record.resource, start, start + record.duration, slot))
+    {
+        releaseSlot(&data->appointmentSlots, slot);
+        return BOOK_FULL;
+    }
+    data->appointments[slot] = record;
+    publishAppointment(data, slot);
+    logAppointment(data, CHANGE_APPOINTMENT_ADD, &record);
+    calendarBook(&data->calendar, &record.date, &record.time, record.duration / MINUTE_INTERVAL);
+    countBooking(data, &record, 1);
+    dayCacheDropDay(&data->dayCache, dateToDay(&record.date));
+
+    return BOOK_OK;
+}
+
+// Book an appointment without prompting (returns BOOK_OK or a BOOK_ error code)
+int bookAppointment(struct ClinicData *data, const struct Appointment *appoint)
+{
+    int result;
+    METRIC_START(started);
+
+    result = placeAppointment(data, appoint);
+    METRIC_STOP(METRIC_BOOK_APPOINTMENT, started);
+    return result;
+}
+
+// Check that no booking on the series' resource collides with any of its occurrences
+static int seriesFits(const struct ClinicData *data, const struct Series *rule)
+{
+    const struct Interval *item;
+    const struct Series *other;
+    long long first = (long long)seriesFirstDay(rule) * MINUTES_PER_DAY;
+    long long last = ((long long)seriesLastDay(rule) + 1) * MINUTES_PER_DAY;
+    long long start;
+    int offset = rule->time.hour * 60 + rule->time.min, otherOffset, i, day;
+
+    // One-off bookings within the series' span that fall on an occurrence day
+    for (item = scheduleFirst(&data->schedule, rule->resource, first);
+         item != NULL && item->start < last; item = scheduleNext(item))
+    {
+        day = keyDay(item->start);
+        start = (long long)day * MINUTES_PER_DAY + offset;
+        if (seriesOccursOn(rule, day) && item->start < start + rule->duration &&
+            item->end > start)
+        {
+            return 0;
+        }
+    }
+
+    // Other series on the resource that overlap in time and share a day
+    for (i = 0; i < data->seriesSlots.liveCount; i++)
+    {
+        other = &data->series[data->seriesSlots.liveSlots[i]];
+        otherOffset = other->time.hour * 60 + other->time.min;
+        if (other->resource == rule->resource &&
+            offset < otherOffset + other->duration && otherOffset < offset + rule->duration &&
+            seriesCommonDay(rule, other) != -1)
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// Book a recurring series whose every occurrence is free (returns BOOK_OK or a BOOK_ error code)
+int bookSeries(struct ClinicData *data, const struct Series *series)
+{
+    struct Series rule = *series;
+    int slot;
+
+    if (findPatientSlot(data, rule.patientNumber) == -1)
+    {
+        return BOOK_NO_PATIENT;
+    }
+    if (!isValidDate(&rule.start) || rule.everyDays < 1 ||
+        rule.everyDays > SERIES_MAX_EVERY || rule.count < 0 || rule.count > SERIES_MAX_COUNT ||
+        (rule.count == 0 && rule.until.year > 0 &&
+         (!isValidDate(&rule.until) || seriesLastDay(&rule) < seriesFirstDay(&rule))))
+    {
+        return BOOK_BAD_DATE;
+    }
+    if (rule.duration == 0)
+    {
+        rule.duration = MINUTE_INTERVAL;
+    }
+    if (!isValidAppointmentTime(&rule.time) ||
+        !isValidAppointmentLength(&rule.time, rule.duration))
+    {
+        return BOOK_BAD_TIME;
+    }
+
+    if (rule.resource == RESOURCE_ANY)
+    {
+        for (rule.resource = 0; rule.resource < data->resourceCount; rule.resource++)
+        {
+            if (seriesFits(data, &rule))
+            {
+                break;
+            }
+        }
+        if (rule.resource == data->resourceCount)
+        {
+            return BOOK_SLOT_TAKEN;
+        }
+    }
+    else if (rule.resource < 0 || rule.resource >= data->resourceCount)
+    {
+        return BOOK_BAD_RESOURCE;
+    }
+    else if (!seriesFits(data, &rule))
+    {
+        return BOOK_SLOT_TAKEN;
+    }
+
+    slot = takeSlot(&data->seriesSlots);
+    if (slot == -1)
+    {
+        return BOOK_FULL;
+    }
+    data->series[slot] = rule;
+    dropSeriesDays(data, &rule);
+    logSeries(data, CHANGE_SERIES_ADD, &rule);
+
+    return BOOK_OK;
+}
+
+// Find a patient's series with an occurrence on the date (returns -1 if not found)
+int findPatientSeries(const struct ClinicData *data, int patientNumber, const struct Date *date)
+{
+    int i, slot, found = -1, day = dateToDay(date);
+
+    // The lowest matching slot, as a store scan would find
+    for (i = 0; i < data->seriesSlots.liveCount; i++)
+    {
+        slot = data->seriesSlots.liveSlots[i];
+        if ((found == -1 || slot < found) && data->series[slot].patientNumber == patientNumber &&
+            seriesOccursOn(&data->series[slot], day))
+        {
+            found = slot;
+        }
+    }
+    return found;
+}
+
+// Copy up to "max" store slots of a patient's series with an occurrence on the date,
+// in slot order (returns the total)
+int findPatientSeriesOn(const struct ClinicData *data, int patientNumber,
+                        const struct Date *date, int slots[], int max)
+{
+    int i, slot, at, total = 0, day = dateToDay(date);
+
+    for (i = 0; i < data->seriesSlots.liveCount; i++)
+    {
+        slot = data->seriesSlots.liveSlots[i];
+        if (data->series[slot].patientNumber != patientNumber ||
+            !seriesOccursOn(&data->series[slot], day))
+        {
+            continue;
+        }
+        if (total < max)
+        {
+            for (at = total; at > 0 && slots[at - 1] > slot; at--)
+            {
+                slots[at] = slots[at - 1];
+            }
+            slots[at] = slot;
+        }
+        total++;
+    }
+    return total;
+}
+
+// Find a patient's series by its first occurrence, time and resource
+// (returns its store slot, -1 if there is none)
+int findSeriesAt(const struct ClinicData *data, const struct Series *rule)
+{
+    const struct Series *other;
+    int i, slot;
+
+    for (i = 0; i < data->seriesSlots.liveCount; i++)
+    {
+        slot = data->seriesSlots.liveSlots[i];
+        other = &data->series[slot];
+        if (other->patientNumber == rule->patientNumber && other->resource == rule->resource &&
+            dateToDay(&other->start) == dateToDay(&rule->start) &&
+            other->time.hour == rule->time.hour && other->time.min == rule->time.min)
+        {
+            return slot;
+        }
+    }
+    return -1;
+}
+
+// Cancel a recurring series (every occurrence)
+void cancelSeries(struct ClinicData *data, int index)
+{
+    logSeries(data, CHANGE_SERIES_CANCEL, &data->series[index]);
+    dropSeriesDays(data, &data->series[index]);
+    memset(&data->series[index], 0, sizeof(data->series[index]));
+    releaseSlot(&data->seriesSlots, index);
+}
+
+// Apply a change read from another clinic's feed (returns 1 if it applied,
+// 0 if this clinic is out of step with the feed, e.g. the record is missing)
+int applyClinicChange(struct ClinicData *data, const struct ChangeRecord *change)
+{
+    int slot, isNew;
+
+    switch (change->kind)
+    {
+    case CHANGE_PATIENT_PUT:
+        slot = findPatientSlot(data, change->patient.patientNumber);
+        isNew = slot == -1;
+        if (isNew)
+        {
+            slot = takeSlot(&data->patientSlots);
+            if (slot == -1)
+            {
+                return 0;
+            }
+        }
+        data->patients[slot] = change->patient;
+        if (isNew)
+        {
+            indexPatient(data, slot);
+        }
+        groupPatient(data, slot);
+        publishPatient(data, slot);
+        logPatient(data, CHANGE_PATIENT_PUT, &data->patients[slot]);
+        dayCacheDropPatient(&data->dayCache, change->patient.patientNumber);
+        return 1;
+    case CHANGE_PATIENT_REMOVE:
+        slot = findPatientSlot(data, change->patient.patientNumber);
+        if (slot != -1)
+        {
+            dropPatient(data, slot);
+        }
+        return slot != -1;
+    case CHANGE_APPOINTMENT_ADD:
+        return bookAppointment(data, &change->appointment) == BOOK_OK;
+    case CHANGE_APPOINTMENT_REMOVE:
+        // Only the very booking cancelled at the source; a miss means the replica diverged
+        slot = findAppointmentAt(data, &change->appointment);
+        if (slot != -1)
+        {
+            dropAppointment(data, slot);
+        }
+        return slot != -1;
+    case CHANGE_SERIES_ADD:
+        return bookSeries(data, &change->series) == BOOK_OK;
+    case CHANGE_SERIES_CANCEL:
+        slot = findSeriesAt(data, &change->series);
+        if (slot != -1)
+        {
+            cancelSeries(data, slot);
+        }
+        return slot != -1;
+    }
+    return 0;
+}
+
+// Copy up to "max" store slots of a patient's household in patient number order
+// (a patient without a phone number is a household of one; returns the total,
+// 0 if the patient is not found)
+int findPatientHousehold(const struct ClinicData *data, int patientNumber, int slots[], int max)
+{
+    int slot = findPatientSlot(data, patientNumber);
+    int household = slot == -1 ? -1 : householdOf(&data->households, slot);
+
+    if (household != -1)
+    {
+        return householdMembers(&data->households, household, slots, max);
+    }
+    if (slot != -1 && max > 0)
+    {
+        slots[0] = slot;
+    }
+    return slot != -1;
+}
+
+// Check if a date has no free slot left on any resource
+int isDayFullyBooked(const struct ClinicData *data, const struct Date *date)
+{
+    struct Time opening = {START_HOUR, 0}, freeTime;
+    struct Date freeDate;
+
+    return !findNextTimeslot(data, date, &opening, 1, &freeDate, &freeTime) ||
+           dateToDay(&freeDate) != dateToDay(date);
+}
+
+// Queue a patient for a date's next free slot (returns the number now waiting
+// for the date, 0 if the patient is not found or out of memory)
+int joinWaitlist(struct ClinicData *data, int patientNumber, const struct Date *date,
+                 int urgency)
+{
+    if (findPatientSlot(data, patientNumber) == -1)
+    {
+        return 0;
+    }
+    return waitlistAdd(&data->waitlist, dateToDay(date), patientNumber, urgency);
+}
+
+// Book a date's waiters, most urgent and then earliest first, into its free slots and copy
+// up to "max" of the bookings made (stops at "max"; returns the number copied)
+int promoteWaitlist(struct ClinicData *data, const struct Date *date,
+                    struct Appointment promoted[], int max)
+{
+    struct Appointment appoint = {0};
+    struct Time opening = {START_HOUR, 0};
+    struct Waiter waiter;
+    int day = dateToDay(date), count = 0;
+
+    // Each promotion is a heap pop: the day's other waiters are never scanned
+    while (count < max && waitlistPeek(&data->waitlist, day, &waiter))
+    {
+        if (findPatientSlot(data, waiter.patientNumber) == -1)
+        {
+            // The patient was removed while waiting
+            waitlistPop(&data->waitlist, day, &waiter);
+            continue;
+        }
+        if (!findNextTimeslot(data, date, &opening, 1, &appoint.date, &appoint.time) ||
+            dateToDay(&appoint.date) != day)
+        {
+            break;
+        }
+        appoint.patientNumber = waiter.patientNumber;
+        appoint.resource = RESOURCE_ANY;
+        appoint.duration = 0;
+        if (placeAppointment(data, &appoint) != BOOK_OK)
+        {
+            break;
+        }
+        waitlistPop(&data->waitlist, day, &waiter);
+        promoted[count++] = appoint;
+    }
+    return count;
+}
+
+// Book back-to-back appointments on one resource for every patient in a household,
+// in patient number order from date/time (returns BOOK_OK or a BOOK_ error code;
+// nothing is booked unless every appointment fits)
+int bookHousehold(struct ClinicData *data, int patientNumber, const struct Date *date,
+                  const struct Time *time)
+{
+    struct Appointment appoint = {0};
+    int slots[HOUSEHOLD_MAX_MEMBERS];
+    int i, total, minutes;
+    long long start;
+
+    total = findPatientHousehold(data, patientNumber, slots, HOUSEHOLD_MAX_MEMBERS);
+    if (total == 0)
+    {
+        return BOOK_NO_PATIENT;
+    }
+    if (!isValidDate(date))
+    {
+        return BOOK_BAD_DATE;
+    }
+    if (total > HOUSEHOLD_MAX_MEMBERS || !isValidAppointmentTime(time) ||
+        !isValidAppointmentLength(time, total * MINUTE_INTERVAL))
+    {
+        return BOOK_BAD_TIME;
+    }
+
+    // The whole run is checked first so a household is booked all or nothing
+    start = dateTimeKey(date, time);
+    appoint.resource = freeResource(data, start, start + (long long)total * MINUTE_INTERVAL);
+    if (appoint.resource == -1)
+    {
+        return BOOK_SLOT_TAKEN;
+    }
+    if (data->appointmentSlots.freeCount < total)
+    {
+        return BOOK_FULL;
+    }
+
+    appoint.date = *date;
+    appoint.duration = MINUTE_INTERVAL;
+    for (i = 0; i < total; i++)
+    {
+        minutes = time->hour * 60 + time->min + i * MINUTE_INTERVAL;
+        appoint.patientNumber = data->patients[slots[i]].patientNumber;
+        appoint.time.hour = minutes / 60;
+        appoint.time.min = minutes % 60;
+        if (placeAppointment(data, &appoint) != BOOK_OK)
+        {
+            // Only an interval index allocation failure gets here
+            return BOOK_FULL;
+        }
+    }
+    return BOOK_OK;
+}
+
+// Find the earliest start of "count" consecutive slots free on one resource at or after date/time
+// (returns 1 and fills foundDate/foundTime, or 0 if none is open)
+int findNextTimeslot(const struct ClinicData *data, const struct Date *date,
+                     const struct Time *time, int count,
+                     struct Date *foundDate, struct Time *foundTime)
+{
+    struct Date from = *date;
+    struct Time at = *time;
+
+    // The calendar only knows how many one-off bookings hold each slot, so
+    // a candidate is confirmed on the interval index and the series (one
+    // resource must be free for the whole run) and the search resumes past
+    // misses
+    while (calendarNextFree(&data->calendar, &from, &at, count, foundDate, foundTime))
+    {
+        if ((count == 1 && !activeSeries(data)) ||
+            findFreeResource(data, foundDate, foundTime, count * MINUTE_INTERVAL) != -1)
+        {
+            return 1;
+        }
+        from = *foundDate;
+        at.hour = foundTime->hour;
+        at.min = foundTime->min + 1;
+    }
+    return 0;
+}
+
+//////////////////////////////////////
+// CURSOR FUNCTIONS
+//////////////////////////////////////
+
+// Minutes since 1970-01-01 00:00 of a date and time (the appointment listing order)
+long long dateTimeKey(const struct Date *date, const struct Time *time)
+{
+    return (long long)dateToDay(date) * MINUTES_PER_DAY + time->hour * 60 + time->min;
+}
+
+// Copy the store slots of up to "max" patients numbered above "after", in number order
+// (after 0 starts at the first patient; returns the number of slots copied)
+int pagePatients(const struct ClinicData *data, int after, int slots[], int max)
+{
+    int at, copied = 0;
+
+    // No patient number follows INT_MAX
+    if (after == INT_MAX)
+    {
+        return 0;
+    }
+    at = patientOrderBound(data, after + 1);
+    while (copied < max && at < data->patientCount)
+    {
+        slots[copied++] = data->patientOrder[at++].slot;
+    }
+    return copied;
+}
+
+// Position a cursor before the first appointment
+void startAppointmentCursor(struct AppointmentCursor *cursor)
+{
+    cursor->start = LLONG_MIN;
+    cursor->resource = -1;
+    cursor->slot = -1;
+}
+
+// Position a cursor before the first appointment starting at or after "start" (see dateTimeKey)
+void seekAppointmentCursor(struct AppointmentCursor *cursor, long long start)
+{
+    cursor->start = start - 1;
+    cursor->resource = INT_MAX;
+    cursor->slot = INT_MAX;
+}
+
+// Copy the store slots of up to "max" appointments following the cursor in date order
+// and advance the cursor past them (recurring series are not expanded; returns the
+// number of slots copied)
+int pageAppointments(const struct ClinicData *data, struct AppointmentCursor *cursor,
+                     int slots[], int max)
+{
+    const struct Schedule *schedule = &data->schedule;
+    const struct Interval *item, *at[MAX_RESOURCES];
+    int resource, best, copied = 0;
+
+    // Each resource's tree resumes at its first booking past the cursor
+    // (the order is start, then resource, then slot)
+    for (resource = 0; resource < schedule->resourceCount; resource++)
+    {
+        at[resource] = scheduleFirst(schedule, resource, cursor->start);
+        while (at[resource] != NULL && at[resource]->start == cursor->start &&
+               (resource < cursor->resource ||
+                (resource == cursor->resource && at[resource]->slot <= cursor->slot)))
+        {
+            at[resource] = scheduleNext(at[resource]);
+        }
+    }
+
+    // Merge the lists: the earliest head is next, the lowest resource on a tie
+    while (copied < max)
+    {
+        item = NULL;
+        best = -1;
+        for (resource = 0; resource < schedule->resourceCount; resource++)
+        {
+            if (at[resource] != NULL && (item == NULL || at[resource]->start < item->start))
+            {
+                item = at[resource];
+                best = resource;
+            }
+        }
+        if (item == NULL)
+        {
+            break;
+        }
+        at[best] = scheduleNext(item);
+        slots[copied++] = item->slot;
+        cursor->start = item->start;
+        cursor->resource = best;
+        cursor->slot = item->slot;
+    }
+    return copied;
+}
+
+//////////////////////////////////////
+// RECORD FUNCTIONS
+//////////////////////////////////////
+
+// Get the patient's name
+const char *patientName(const struct Patient *patient)
+{
+    return internedString(patient->name);
+}
+
+// Set the patient's name (the text is interned)
+void setPatientName(struct Patient *patient, const char *name)
+{
+    patient->name = internString(name);
+}
+
+// Get the patient's contact type (PHONE_CELL .. PHONE_TBD)
+int patientPhoneType(const struct Patient *patient)
+{
+    return (int)(patient->phone & ((1u << PHONE_TYPE_BITS) - 1));
+}
+
+// Get the patient's phone number as an integer (PHONE_NO_NUMBER if none)
+unsigned long long patientPhoneNumber(const struct Patient *patient)
+{
+    return patient->phone >> PHONE_TYPE_BITS;
+}
+
+// Unpack the patient's phone into its text form
+void getPatientPhone(const struct Patient *patient, struct Phone *phone)
+{
+    unsigned long long number = patientPhoneNumber(patient);
+    int i;
+
+    strcpy(phone->description, phoneTypeName(patientPhoneType(patient)));
+    if (number == PHONE_NO_NUMBER)
+    {
+        phone->number[0] = '\0';
+    }
+    else
+    {
+        for (i = PHONE_LEN - 1; i >= 0; i--)
+        {
+            phone->number[i] = (char)('0' + number % 10);
+            number /= 10;
+        }
+        phone->number[PHONE_LEN] = '\0';
+    }
+}
+
+// Pack a text form phone into the patient record
+void setPatientPhone(struct Patient *patient, const struct Phone *phone)
+{
+    patient->phone = parsePhoneNumber(phone->number) << PHONE_TYPE_BITS |
+                     (unsigned long long)parsePhoneType(phone->description);
+}
+
+// Convert a 10-digit phone string to an integer (PHONE_NO_NUMBER if not 10 digits)
+unsigned long long parsePhoneNumber(const char *number)
+{
+    unsigned long long value = 0;
+    int i;
+
+    for (i = 0; i < PHONE_LEN; i++)
+    {
+        if (number[i] < '0' || number[i] > '9')
+        {
+            return PHONE_NO_NUMBER;
+        }
+        value = value * 10 + (unsigned long long)(number[i] - '0');
+    }
+    return number[PHONE_LEN] == '\0' ? value : PHONE_NO_NUMBER;
+}
+
+// Convert a phone description (CELL/HOME/WORK/TBD) to a contact type
+int parsePhoneType(const char *description)
+{
+    int type;
+
+    for (type = PHONE_CELL; type < PHONE_TBD; type++)
+    {
+        if (strcmp(description, phoneTypeName(type)) == 0)
+        {
+            return type;
+        }
+    }
+    return PHONE_TBD;
+}
+
+// Get the description of a contact type
+const char *phoneTypeName(int type)
+{
+    static const char *const names[] = {"CELL", "HOME", "WORK", "TBD"};
+
+    return names[type & ((1 << PHONE_TYPE_BITS) - 1)];
+}
+
+//////////////////////////////////////
+// STORE FUNCTIONS
+//////////////////////////////////////
+
+// Day number of an interval index key
+static int keyDay(long long key)
+{
+    return (int)((key < 0 ? key - (MINUTES_PER_DAY - 1) : key) / MINUTES_PER_DAY);
+}
+
+// Check if any recurring series is booked
+static int activeSeries(const struct ClinicData *data)
+{
+    return data->seriesSlots.liveCount > 0;
+}
+
+// Check if a resource is held by a booking or series occurrence within [start, end)
+static int resourceBusy(const struct ClinicData *data, int resource, long long start,
+                        long long end)
+{
+    const struct Series *rule;
+    long long occurrence;
+    int i, day = keyDay(start);
+
+    if (scheduleConflict(&data->schedule, resource, start, end) != -1)
+    {
+        return 1;
+    }
+    for (i = 0; i < data->seriesSlots.liveCount; i++)
+    {
+        rule = &data->series[data->seriesSlots.liveSlots[i]];
+        if (rule->resource == resource && seriesOccursOn(rule, day))
+        {
+            occurrence = (long long)day * MINUTES_PER_DAY + rule->time.hour * 60 + rule->time.min;
+            if (start < occurrence + rule->duration && end > occurrence)
+            {
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+// Lowest resource free within [start, end) (returns -1 if every resource is busy)
+static int freeResource(const struct ClinicData *data, long long start, long long end)
+{
+    int resource;
+
+    if (!activeSeries(data))
+    {
+        return scheduleFreeResource(&data->schedule, start, end);
+    }
+    for (resource = 0; resource < data->resourceCount; resource++)
+    {
+        if (!resourceBusy(data, resource, start, end))
+        {
+            return resource;
+        }
+    }
+    return -1;
+}
+
+// Order of a booking within its day (time, then resource)
+static int dayOrder(const struct Appointment *appoint)
+{
+    return (appoint->time.hour * 60 + appoint->time.min) * (MAX_RESOURCES + 1) + appoint->resource;
+}
+
+// Insert a booking into a time ordered list keeping the first "max" (counts every booking)
+static void insertByTime(struct Appointment appoints[], int max, int *total,
+                         const struct Appointment *appoint)
+{
+    int k = *total < max ? *total : max, key = dayOrder(appoint);
+
+    (*total)++;
+    if (k == max)
+    {
+        // Full: the latest kept booking makes way if this one is earlier
+        if (k == 0 || dayOrder(&appoints[k - 1]) <= key)
+        {
+            return;
+        }
+        k--;
+    }
+    for (; k > 0 && dayOrder(&appoints[k - 1]) > key; k--)
+    {
+        appoints[k] = appoints[k - 1];
+    }
+    appoints[k] = *appoint;
+}
+
+// Add (delta 1) or remove (delta -1) a booking from the statistics
+static void countBooking(struct ClinicData *data, const struct Appointment *appoint, int delta)
+{
+    int day = dateToDay(&appoint->date);
+    int month = STATS_MONTH(appoint->date.year, appoint->date.month);
+    int slot = calendarSlot(&appoint->time), slots = appoint->duration / MINUTE_INTERVAL;
+
+    if (delta > 0)
+    {
+        statsAdd(&data->stats, appoint->patientNumber, day, month, slot, slots);
+    }
+    else
+    {
+        statsRemove(&data->stats, appoint->patientNumber, day, month, slot, slots);
+    }
+}
+
+// Invalidate the cached days on which a series has an occurrence
+static void dropSeriesDays(struct ClinicData *data, const struct Series *rule)
+{
+    int i;
+
+    for (i = 0; i < DAYCACHE_SLOTS; i++)
+    {
+        if (data->dayCache.entries[i].used &&
+            seriesOccursOn(rule, data->dayCache.entries[i].day))
+        {
+            dayCacheDropEntry(&data->dayCache, &data->dayCache.entries[i]);
+        }
+    }
+}
+
+// Render a day's schedule rows, print them and keep them in the day cache
+static void renderDaySchedule(struct ClinicData *data, const struct Date *date)
+{
+    struct Appointment *day;
+    int *patients;
+    char *text;
+    int i, j, total, length = 0;
+
+    // Only the day's bookings are read, recurring occurrences materialized
+    total = clinicDaySchedule(data, date, NULL, 0);
+    day = malloc(sizeof(*day) * (total ? total : 1));
+    patients = malloc(sizeof(*patients) * (total ? total : 1));
+    text = malloc((size_t)SCHEDULE_ROW_LEN * total + 1);
+    if (day != NULL && patients != NULL && text != NULL)
+    {
+        total = clinicDaySchedule(data, date, day, total);
+        for (i = 0; i < total; i++)
+        {
+            patients[i] = day[i].patientNumber;
+            j = findPatientSlot(data, day[i].patientNumber);
+            if (j != -1)
+            {
+                length += formatScheduleData(text + length, SCHEDULE_ROW_LEN,
+                                             &data->patients[j], &day[i], 0);
+            }
+        }
+        fwrite(text, 1, length, stdout);
+        dayCacheStore(&data->dayCache, dateToDay(date), text, length, patients, total);
+    }
+    free(day);
+    free(patients);
+    free(text);
+}
+
+// Book a date's waiters into its freed slots and report each promotion
+static void reportPromotions(struct ClinicData *data, const struct Date *date)
+{
+    struct Appointment promoted[DISPLAY_PAGE_SIZE];
+    int i, n;
+
+    do
+    {
+        n = promoteWaitlist(data, date, promoted, DISPLAY_PAGE_SIZE);
+        for (i = 0; i < n; i++)
+        {
+            printf("*** Waitlisted patient %05d booked on %04d-%02d-%02d at %02d:%02d ***\n",
+                   promoted[i].patientNumber, promoted[i].date.year, promoted[i].date.month,
+                   promoted[i].date.day, promoted[i].time.hour, promoted[i].time.min);
+        }
+        if (n > 0)
+        {
+            putchar('\n');
+        }
+    } while (n == DISPLAY_PAGE_SIZE);
+}
+
+// Allocate empty patient and appointment stores from the clinic's arena (returns 1 on success)
+int createClinic(struct ClinicData *data, int maxPatient, int maxAppointments)
+{
+    memset(data, 0, sizeof(*data));
+    data->patients = arenaAlloc(&data->arena, sizeof(struct Patient) * maxPatient);
+    data->appointments = arenaAlloc(&data->arena, sizeof(struct Appointment) * maxAppointments);
+    data->series = arenaAlloc(&data->arena, sizeof(struct Series) * maxAppointments);
+    data->patientOrder = arenaAlloc(&data->arena, sizeof(struct PatientKey) * maxPatient);
+    if (data->patients == NULL || data->appointments == NULL || data->series == NULL ||
+        data->patientOrder == NULL ||
+        !initSlotPool(&data->patientSlots, &data->arena, maxPatient) ||
+        !initSlotPool(&data->appointmentSlots, &data->arena, maxAppointments) ||
+        !initSlotPool(&data->seriesSlots, &data->arena, maxAppointments))
+    {
+        destroyClinic(data);
+        return 0;
+    }
+    initNodePool(&data->intervalNodes, &data->arena, sizeof(struct IntervalNode));
+    data->maxPatient = maxPatient;
+    data->maxAppointments = maxAppointments;
+    data->maxSeries = maxAppointments;
+    data->resourceCount = CLINIC_RESOURCES;
+    syncClinicIndexes(data);
+    return 1;
+}
+
+// Release the stores and everything else allocated from the clinic's arena
+void destroyClinic(struct ClinicData *data)
+{
+    calendarFree(&data->calendar);
+    scheduleFree(&data->schedule);
+    dayCacheClear(&data->dayCache);
+    statsFree(&data->stats);
+    householdFree(&data->households);
+    waitlistFree(&data->waitlist);
+    arenaRelease(&data->arena);
+    memset(&data->intervalNodes, 0, sizeof(data->intervalNodes));
+    data->snapshots = NULL;
+    data->feed = NULL;
+    data->patients = NULL;
+    data->appointments = NULL;
+    data->series = NULL;
+    data->patientOrder = NULL;
+    data->patientCount = 0;
+    data->maxPatient = 0;
+    data->maxAppointments = 0;
+    data->maxSeries = 0;
+    memset(&data->patientSlots, 0, sizeof(data->patientSlots));
+    memset(&data->appointmentSlots, 0, sizeof(data->appointmentSlots));
+    memset(&data->seriesSlots, 0, sizeof(data->seriesSlots));
+}
+
+// Rebuild a store's slot lists from the patient number of each of its "count" records,
+// "size" bytes apart (a number below 1 marks an empty record)
+static void syncSlotPool(struct SlotPool *pool, const int *firstNumber, size_t size, int count)
+{
+    const char *at = (const char *)firstNumber;
+    int i;
+
+    resetSlotPool(pool);
+
+    // Vacant slots are pushed highest first so the lowest is handed out first
+    for (i = count - 1; i >= 0; i--)
+    {
+        if (*(const int *)(at + (size_t)i * size) < 1)
+        {
+            addFreeSlot(pool, i);
+        }
+    }
+    for (i = 0; i < count; i++)
+    {
+        if (*(const int *)(at + (size_t)i * size) > 0)
+        {
+            addLiveSlot(pool, i);
+        }
+    }
+}
+
+// Rebuild the vacant slot lists after records were moved or written directly
+void syncClinicSlots(struct ClinicData *data)
+{
+    syncSlotPool(&data->patientSlots, &data->patients[0].patientNumber,
+                 sizeof(*data->patients), data->maxPatient);
+    syncSlotPool(&data->appointmentSlots, &data->appointments[0].patientNumber,
+                 sizeof(*data->appointments), data->maxAppointments);
+    syncSlotPool(&data->seriesSlots, &data->series[0].patientNumber,
+                 sizeof(*data->series), data->maxSeries);
+}
+
+// Rebuild the slot lists and every index after records were written directly (e.g. by an import)
+void syncClinicIndexes(struct ClinicData *data)
+{
+    rebuildIndexes(data);
+    dayCacheClear(&data->dayCache);
+    if (data->snapshots != NULL)
+    {
+        snapshotLoad(data->snapshots, data->patients, data->maxPatient, data->appointments,
+                     data->maxAppointments);
+    }
+}
+
+// Keep a snapshot store in step with the patient and appointment stores from now on
+// (publishes the current records; returns 0 when out of memory)
+int attachClinicSnapshots(struct ClinicData *data, struct SnapshotStore *snapshots)
+{
+    data->snapshots = snapshots;
+    return snapshotLoad(snapshots, data->patients, data->maxPatient, data->appointments,
+                        data->maxAppointments);
+}
+
+// Order of two store slots
+static int compareSlots(const void *a, const void *b)
+{
+    const int *x = a, *y = b;
+
+    return (*x > *y) - (*x < *y);
+}
+
+// Order of two patient index entries (number, then slot)
+static int comparePatientKeys(const void *a, const void *b)
+{
+    const struct PatientKey *x = a, *y = b;
+
+    if (x->patientNumber != y->patientNumber)
+    {
+        return x->patientNumber < y->patientNumber ? -1 : 1;
+    }
+    return (x->slot > y->slot) - (x->slot < y->slot);
+}
+
+// Add a patient store slot to the number index
+static void indexPatient(struct ClinicData *data, int slot)
+{
+    int at = patientOrderBound(data, data->patients[slot].patientNumber + 1);
+
+    // New patients take the next highest number, so this is an append
+    memmove(&data->patientOrder[at + 1], &data->patientOrder[at],
+            sizeof(*data->patientOrder) * (data->patientCount - at));
+    data->patientOrder[at].patientNumber = data->patients[slot].patientNumber;
+    data->patientOrder[at].slot = slot;
+    data->patientCount++;
+}
+
+// Remove a patient number from the number index
+static void unindexPatient(struct ClinicData *data, int patientNumber)
+{
+    int at = patientOrderBound(data, patientNumber);
+
+    if (at < data->patientCount && data->patientOrder[at].patientNumber == patientNumber)
+    {
+        memmove(&data->patientOrder[at], &data->patientOrder[at + 1],
+                sizeof(*data->patientOrder) * (data->patientCount - at - 1));
+        data->patientCount--;
+    }
+}
+
+// Put a patient store slot in the household of its phone number and surname
+// (the last word of the name; a patient without a number is in none)
+static void groupPatient(struct ClinicData *data, int slot)
+{
+    const struct Patient *patient = &data->patients[slot];
+    const char *name = patientName(patient), *surname = strrchr(name, ' ');
+
+    if (patientPhoneNumber(patient) == PHONE_NO_NUMBER)
+    {
+        householdRemove(&data->households, slot);
+        return;
+    }
+    householdAdd(&data->households, slot, patient->patientNumber, patientPhoneNumber(patient),
+                 internString(surname != NULL ? surname + 1 : name));
+}
+
+// Publish a rewritten patient slot to the snapshot store, if one is kept
+static void publishPatient(struct ClinicData *data, int slot)
+{
+    if (data->snapshots != NULL)
+    {
+        snapshotSetPatient(data->snapshots, slot, &data->patients[slot]);
+    }
+}
+
+// Publish a rewritten appointment slot to the snapshot store, if one is kept
+static void publishAppointment(struct ClinicData *data, int slot)
+{
+    if (data->snapshots != NULL)
+    {
+        snapshotSetAppointment(data->snapshots, slot, &data->appointments[slot]);
+    }
+}
+
+// Log a patient change to the feed, if one is attached
+static void logPatient(struct ClinicData *data, int kind, const struct Patient *patient)
+{
+    struct ChangeRecord change = {0};
+
+    if (data->feed != NULL)
+    {
+        change.kind = kind;
+        change.patient = *patient;
+        changeFeedWrite(data->feed, &change);
+    }
+}
+
+// Log an appointment change to the feed, if one is attached
+static void logAppointment(struct ClinicData *data, int kind, const struct Appointment *appoint)
+{
+    struct ChangeRecord change = {0};
+
+    if (data->feed != NULL)
+    {
+        change.kind = kind;
+        change.appointment = *appoint;
+        changeFeedWrite(data->feed, &change);
+    }
+}
+
+// Log a series change to the feed, if one is attached
+static void logSeries(struct ClinicData *data, int kind, const struct Series *rule)
+{
+    struct ChangeRecord change = {0};
+
+    if (data->feed != NULL)
+    {
+        change.kind = kind;
+        change.series = *rule;
+        changeFeedWrite(data->feed, &change);
+    }
+}
+
+// Remove a patient store slot's record and take it out of every index
+static void dropPatient(struct ClinicData *data, int slot)
+{
+    struct Patient *patient = &data->patients[slot];
+
+    logPatient(data, CHANGE_PATIENT_REMOVE, patient);
+    dayCacheDropPatient(&data->dayCache, patient->patientNumber);
+    unindexPatient(data, patient->patientNumber);
+    householdRemove(&data->households, slot);
+    patient->patientNumber = 0;
+    patient->name = STRPOOL_EMPTY;
+    patient->phone = 0;
+    publishPatient(data, slot);
+    releaseSlot(&data->patientSlots, slot);
+}
+
+// Remove an appointment store slot's booking and take it out of every index
+static void dropAppointment(struct ClinicData *data, int slot)
+{
+    struct Appointment *app = &data->appointments[slot];
+
+    logAppointment(data, CHANGE_APPOINTMENT_REMOVE, app);
+    calendarRelease(&data->calendar, &app->date, &app->time, app->duration / MINUTE_INTERVAL);
+    countBooking(data, app, -1);
+    scheduleRemove(&data->schedule, app->resource, dateTimeKey(&app->date, &app->time), slot);
+    dayCacheDropDay(&data->dayCache, dateToDay(&app->date));
+    memset(app, 0, sizeof(*app));
+    publishAppointment(data, slot);
+    releaseSlot(&data->appointmentSlots, slot);
+}
+
+// Rebuild the slot lists, the patient number index, the household index, the
+// calendar, the interval index and the statistics from the stores
+static void rebuildIndexes(struct ClinicData *data)
+{
+    struct Appointment *app;
+    long long start;
+    int i, badResource = 0, badDuration = 0;
+
+    syncClinicSlots(data);
+
+    data->patientCount = 0;
+    for (i = 0; i < data->maxPatient; i++)
+    {
+        if (data->patients[i].patientNumber > 0)
+        {
+            data->patientOrder[data->patientCount].patientNumber = data->patients[i].patientNumber;
+            data->patientOrder[data->patientCount++].slot = i;
+        }
+    }
+    qsort(data->patientOrder, data->patientCount, sizeof(*data->patientOrder),
+          comparePatientKeys);
+    householdReset(&data->households, data->maxPatient);
+    for (i = 0; i < data->patientCount; i++)
+    {
+        groupPatient(data, data->patientOrder[i].slot);
+    }
+
+    // Every resource named by a booking exists, even if not configured; records
+    // written directly with no usable resource or length are repaired (once, as
+    // the repair is stored) and reported
+    for (i = 0; i < data->maxAppointments; i++)
+    {
+        app = &data->appointments[i];
+        if (app->patientNumber > 0)
+        {
+            if (app->resource < 0 || app->resource >= MAX_RESOURCES)
+            {
+                app->resource = 0;
+                badResource++;
+            }
+            if (app->duration <= 0)
+            {
+                app->duration = MINUTE_INTERVAL;
+                badDuration++;
+            }
+            if (app->resource >= data->resourceCount)
+            {
+                data->resourceCount = app->resource + 1;
+            }
+        }
+    }
+    for (i = 0; i < data->maxSeries; i++)
+    {
+        if (data->series[i].patientNumber > 0 && data->series[i].resource >= data->resourceCount)
+        {
+            data->resourceCount = data->series[i].resource + 1;
+        }
+    }
+    if (badResource > 0)
+    {
+        printf("WARNING: %d appointment record(s) named no resource between 0 and %d;"
+               " booked on resource 0\n", badResource, MAX_RESOURCES - 1);
+    }
+    if (badDuration > 0)
+    {
+        printf("WARNING: %d appointment record(s) had no length; booked for %d minutes\n",
+               badDuration, MINUTE_INTERVAL);
+    }
+
+    calendarFree(&data->calendar);
+    calendarSetCapacity(&data->calendar, data->resourceCount);
+    scheduleFree(&data->schedule);
+    scheduleInit(&data->schedule, data->resourceCount, &data->intervalNodes);
+    statsFree(&data->stats);
+    for (i = 0; i < data->maxAppointments; i++)
+    {
+        app = &data->appointments[i];
+        if (app->patientNumber > 0)
+        {
+            start = dateTimeKey(&app->date, &app->time);
+            scheduleAppend(&data->schedule, app->resource, start, start + app->duration, i);
+            calendarBook(&data->calendar, &app->date, &app->time,
+                         app->duration / MINUTE_INTERVAL);
+            countBooking(data, app, 1);
+        }
+    }
+    scheduleSort(&data->schedule);
+}
+
+// Set the number of bookable resources (never below the highest one booked; returns 1 on success)
+int setClinicResources(struct ClinicData *data, int count)
+{
+    if (count < 1 || count > MAX_RESOURCES)
+    {
+        return 0;
+    }
+    data->resourceCount = count;
+    syncClinicIndexes(data);
+    return 1;
+}
+
+// Display the store allocation statistics
+void displayClinicMemory(const struct ClinicData *data)
+{
+    unsigned int strings;
+    size_t textBytes;
+
+    printf("Store Memory\n"
+           "==============================\n");
+    printf("Arena blocks     : %d\n", data->arena.blockCount);
+    printf("Arena reserved   : %zu bytes\n", data->arena.reserved);
+    printf("Arena in use     : %zu bytes (%lld allocations)\n",
+           data->arena.requested, data->arena.allocations);
+    printf("Patient slots    : %d of %d vacant (%lld taken, %lld released)\n",
+           data->patientSlots.freeCount, data->maxPatient,
+           data->patientSlots.takes, data->patientSlots.releases);
+    printf("Appointment slots: %d of %d vacant (%lld taken, %lld released)\n",
+           data->appointmentSlots.freeCount, data->maxAppointments,
+           data->appointmentSlots.takes, data->appointmentSlots.releases);
+    printf("Series slots     : %d of %d vacant (%lld taken, %lld released)\n",
+           data->seriesSlots.freeCount, data->maxSeries,
+           data->seriesSlots.takes, data->seriesSlots.releases);
+    printf("Schedule nodes   : %d live (%lld allocations, %lld reused)\n",
+           data->intervalNodes.live, data->intervalNodes.allocations,
+           data->intervalNodes.reuses);
+    printf("Day cache        : %lld hits, %lld misses, %lld invalidated\n",
+           data->dayCache.hits, data->dayCache.misses, data->dayCache.drops);
+    internStats(&strings, &textBytes);
+    printf("Interned names   : %u (%zu bytes, shared by all clinics)\n", strings, textBytes);
+    putchar('\n');
+}
+
 //////////////////////////////////////
 // USER INPUT FUNCTIONS
 //////////////////////////////////////
@@ -773,14 +2707,18 @@ int checkAppointment(int patientNumber, struct Date date, struct Appointment *ap
 // Get user input for a new patient record
 void inputPatient(struct Patient *patient)
 {
+    char name[NAME_LEN + 1];
+    struct Phone phone;
 
     printf("Patient Data Input\n"
            "------------------\n");
     printf("Number: %05d\n", patient->patientNumber);
     printf("Name  : ");
-    inputCString(patient->name, 1, NAME_LEN);
+    inputCString(name, 1, NAME_LEN);
+    setPatientName(patient, name);
     putchar('\n');
-    inputPhoneData(&patient->phone);
+    inputPhoneData(&phone);
+    setPatientPhone(patient, &phone);
 }
 
 // Get user input for phone contact information
@@ -828,7 +2766,7 @@ void inputPhoneData(struct Phone *phone)
 // Get user input for date information
 void inputDate(struct Date *date)
 {
-    int lastDay = 31; // Default lastDay = 31 days
+    int lastDay;
 
     printf("Year        : ");
     date->year = inputIntPositive();
@@ -836,21 +2774,7 @@ void inputDate(struct Date *date)
     printf("Month (%d-%d): ", MIN_MONTH, MAX_MONTH);
     date->month = inputIntRange(MIN_MONTH, MAX_MONTH);
 
-    if (date->month == 4 || date->month == 9 || date->month == 11)
-    {
-        lastDay = 30;
-    }
-    else if (date->month == 2)
-    {
-        if (date->year % 4 == 0)
-        {
-            lastDay = 29;
-        }
-        else
-        {
-            lastDay = 28;
-        }
-    }
+    lastDay = daysInMonth(date->year, date->month);
     printf("Day (1-%d)  : ", lastDay);
     date->day = inputIntRange(MIN_DAY, lastDay);
 }
@@ -873,6 +2797,11 @@ void inputTime(struct Time *time)
 int importPatients(const char *datafile, struct Patient patients[], int max)
 {
     int i = 0;
+    char name[IMPORT_FIELD_LEN + 1];
+    char description[IMPORT_FIELD_LEN + 1];
+    char number[IMPORT_FIELD_LEN + 1];
+    struct Phone phone;
+    METRIC_START(started);
 
     FILE *fp;
     fp = fopen(datafile, "r");
@@ -881,11 +2810,21 @@ int importPatients(const char *datafile, struct Patient patients[], int max)
     {
         for (i = 0; i < max; i++)
         {
-            fscanf(fp, "%d|%[^|]|%[^|]|%[^\n]",
+            name[0] = description[0] = number[0] = '\0';
+            fscanf(fp, "%d|%63[^|]|%63[^|]|%63[^\n]",
                    &patients[i].patientNumber,
-                   patients[i].name,
-                   patients[i].phone.description,
-                   patients[i].phone.number);
+                   name, description, number);
+
+            if (patients[i].patientNumber != 0)
+            {
+                name[NAME_LEN] = '\0';
+                setPatientName(&patients[i], name);
+                strncpy(phone.description, description, PHONE_DESC_LEN);
+                phone.description[PHONE_DESC_LEN] = '\0';
+                strncpy(phone.number, number, PHONE_LEN);
+                phone.number[PHONE_LEN] = '\0';
+                setPatientPhone(&patients[i], &phone);
+            }
         }
         fclose(fp);
     }
@@ -895,35 +2834,52 @@ int importPatients(const char *datafile, struct Patient patients[], int max)
         printf("Error: Fail to open the file\n");
     }
 
+    METRIC_STOP(METRIC_IMPORT_PATIENTS, started);
     return i;
 }
 
 // Import appointment data from file into an Appointment array (returns # of records read)
+// (records are "patient,year,month,day,hour,min[,resource,minutes]")
 int importAppointments(const char *datafile, struct Appointment appoints[], int max)
 {
-    int i, count = 0;
+    int count = 0, fields;
+    char line[IMPORT_LINE_LEN + 1];
     FILE *fp = NULL;
+    METRIC_START(started);
     fp = fopen(datafile, "r");
 
     if (fp != NULL)
     {
-        for (i = 0; i < max; i++)
+        while (count < max && fgets(line, sizeof(line), fp) != NULL)
         {
-            fscanf(fp, "%d,%d,%d,%d,%d,%d",
-                   &appoints[i].patientNumber,
-                   &appoints[i].date.year,
-                   &appoints[i].date.month,
-                   &appoints[i].date.day,
-                   &appoints[i].time.hour,
-                   &appoints[i].time.min);
-
-            if (!feof(fp))
+            struct Appointment *app = &appoints[count];
+
+            fields = sscanf(line, "%d,%d,%d,%d,%d,%d,%d,%d",
+                            &app->patientNumber,
+                            &app->date.year,
+                            &app->date.month,
+                            &app->date.day,
+                            &app->time.hour,
+                            &app->time.min,
+                            &app->resource,
+                            &app->duration);
+
+            if (fields >= 6)
             {
+                if (fields < 7)
+                {
+                    app->resource = 0;
+                }
+                if (fields < 8)
+                {
+                    app->duration = MINUTE_INTERVAL;
+                }
                 count++;
             }
         }
         fclose(fp);
     }
 
+    METRIC_STOP(METRIC_IMPORT_APPOINTMENTS, started);
     return count;
 }
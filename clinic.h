@@ -5,6 +5,20 @@
 #ifndef CLINIC_H
 #define CLINIC_H
 
+#include "pool.h"
+#include "date.h"
+#include "calendar.h"
+#include "schedule.h"
+#include "series.h"
+#include "daycache.h"
+#include "stats.h"
+#include "household.h"
+#include "waitlist.h"
+#include "snapshot.h"
+
+struct ChangeFeed;
+struct ChangeRecord;
+
 //////////////////////////////////////
 // Module macro's (usable by any file that includes this header)
 //////////////////////////////////////
@@ -18,6 +32,19 @@
 #define PHONE_DESC_LEN 4
 #define PHONE_LEN 10
 #define OPTION_LEN 1
+#define IMPORT_FIELD_LEN 63
+#define IMPORT_LINE_LEN 255
+#define SCHEDULE_ROW_LEN 96
+
+// Phone contact types (packed into the low PHONE_TYPE_BITS of Patient.phone)
+#define PHONE_CELL 0
+#define PHONE_HOME 1
+#define PHONE_WORK 2
+#define PHONE_TBD 3
+#define PHONE_TYPE_BITS 2
+
+// Packed phone number value for "no number" (above any 10-digit number)
+#define PHONE_NO_NUMBER 0x3FFFFFFFFULL
 
 #define START_HOUR 10
 #define END_HOUR 14
@@ -29,23 +56,49 @@
 #define MAX_MINUTE 59
 #define MIN_TIME 0
 
+// Bookable resources (vets and exam rooms) per clinic
+#define CLINIC_RESOURCES 1
+#define MAX_RESOURCES 255
+#define RESOURCE_ANY -1
+
+// Minutes per day (interval index keys are minutes since 1970-01-01 00:00)
+#define MINUTES_PER_DAY (24 * 60)
+
+// Rows per page of the patient and appointment listings
+#define DISPLAY_PAGE_SIZE 25
+
+// Busiest days shown by the statistics report
+#define STATS_TOP_DAYS 5
+
+// Most household members listed or booked at once
+#define HOUSEHOLD_MAX_MEMBERS 32
+
+// bookAppointment: result codes
+#define BOOK_OK 0
+#define BOOK_NO_PATIENT 1
+#define BOOK_BAD_TIME 2
+#define BOOK_SLOT_TAKEN 3
+#define BOOK_FULL 4
+#define BOOK_BAD_DATE 5
+#define BOOK_BAD_RESOURCE 6
+
 //////////////////////////////////////
 // Structures
 //////////////////////////////////////
 
-// Data type: Phone
+// Data type: Phone (text form used for input and display)
 struct Phone
 {
     char description[PHONE_DESC_LEN + 1];
     char number[PHONE_LEN + 1];
 };
 
-// Data type: Patient
+// Data type: Patient (packed: 16 bytes)
 struct Patient
 {
     int patientNumber;
-    char name[NAME_LEN + 1];
-    struct Phone phone;
+    unsigned int name;       // interned name id (see patientName)
+    unsigned long long phone; // number << PHONE_TYPE_BITS | contact type
 };
 
 // ------------------- MS#3 -------------------
@@ -70,6 +123,37 @@ struct Appointment
     int patientNumber;
     struct Date date;
     struct Time time;
+    int resource; // vet or exam room (RESOURCE_ANY when booking: first free one)
+    int duration; // minutes, a multiple of MINUTE_INTERVAL (0 when booking: one interval)
+};
+
+// Data type: recurring appointment rule (occurrences are expanded only when read)
+struct Series
+{
+    int patientNumber;
+    struct Date start; // first occurrence
+    struct Time time;
+    int resource;
+    int duration;
+    int everyDays;     // days between occurrences
+    int count;         // number of occurrences (0: until "until")
+    struct Date until; // last possible date when count is 0 (year 0: no end)
+};
+
+// Data type: patient number index entry (kept in patient number order)
+struct PatientKey
+{
+    int patientNumber;
+    int slot; // patient store slot
+};
+
+// Data type: resume point of an appointment listing in date order
+// (the listing continues after the booking at this position)
+struct AppointmentCursor
+{
+    long long start; // minutes since 1970-01-01 00:00 (see dateTimeKey)
+    int resource;
+    int slot;
 };
 
 // ClinicData type: Provided to student
@@ -79,6 +163,24 @@ struct ClinicData
     int maxPatient;
     struct Appointment *appointments;
     int maxAppointments;
+    struct Arena arena;               // backs the stores and their indexes
+    struct SlotPool patientSlots;     // vacant patient slots
+    struct SlotPool appointmentSlots; // vacant appointment slots
+    struct PatientKey *patientOrder;  // patient numbers in ascending order
+    int patientCount;
+    struct Calendar calendar;         // per-day slot occupancy
+    struct Schedule schedule;         // per-resource booking intervals
+    struct NodePool intervalNodes;    // the schedule's tree nodes
+    int resourceCount;
+    struct Series *series;            // recurring appointment rules
+    int maxSeries;
+    struct SlotPool seriesSlots;      // vacant series slots
+    struct DayCache dayCache;         // rendered "by DATE" schedules
+    struct ClinicStats stats;         // booking counts (recurring series excluded)
+    struct HouseholdIndex households; // patients grouped by phone number and surname
+    struct Waitlist waitlist;         // requests for fully booked days (not saved)
+    struct SnapshotStore *snapshots;  // published copies of the stores (NULL: none kept)
+    struct ChangeFeed *feed;          // where every change is logged (NULL: not logged)
 };
 
 //////////////////////////////////////
@@ -99,6 +201,13 @@ void displayScheduleData(const struct Patient *patient,
                          const struct Appointment *appoint,
                          int includeDateField);
 
+// Format a single appointment record with patient info. as a table row (returns its length)
+int formatScheduleData(char *out, size_t size, const struct Patient *patient,
+                       const struct Appointment *appoint, int includeDateField);
+
+// Display a recurring series rule with patient info. in tabular format
+void displaySeriesData(const struct Patient *patient, const struct Series *series);
+
 //////////////////////////////////////
 // MENU & ITEM SELECTION FUNCTIONS
 //////////////////////////////////////
@@ -107,67 +216,258 @@ void displayScheduleData(const struct Patient *patient,
 void menuMain(struct ClinicData *data);
 
 // Menu: Patient Management
-void menuPatient(struct Patient patient[], int max);
+void menuPatient(struct ClinicData *data);
 
-// Menu: Patient edit
-void menuPatientEdit(struct Patient *patient);
+// Menu: Patient edit (of the patient in store slot "slot")
+void menuPatientEdit(struct ClinicData *data, int slot);
 
 // Menu: Appointment Management
 void menuAppointment(struct ClinicData *data);
 
-// Display's all patient data in the FMT_FORM | FMT_TABLE format
-void displayAllPatients(const struct Patient patient[], int max, int fmt);
+// Display's all patient data in the FMT_FORM | FMT_TABLE format (a page at a time)
+void displayAllPatients(const struct ClinicData *data, int fmt);
 
 // Search for a patient record based on patient number or phone number
-void searchPatientData(const struct Patient patient[], int max);
+void searchPatientData(const struct ClinicData *data);
 
 // Add a new patient record to the patient array
-void addPatient(struct Patient patient[], int max);
+void addPatient(struct ClinicData *data);
 
 // Edit a patient record from the patient array
-void editPatient(struct Patient patient[], int max);
+void editPatient(struct ClinicData *data);
 
 // Remove a patient record from the patient array
-void removePatient(struct Patient patient[], int max);
+void removePatient(struct ClinicData *data);
 
-// View ALL scheduled appointments
-void viewAllAppointments(const struct ClinicData *data);
+// Display the household (patients sharing a phone number and surname) of a patient
+void viewHousehold(const struct ClinicData *data);
+
+// View ALL scheduled appointments (a page at a time)
+void viewAllAppointments(struct ClinicData *data);
 
 // View appointment schedule for the user input date
-void viewAppointmentSchedule(const struct ClinicData *data);
+void viewAppointmentSchedule(struct ClinicData *data);
 
 // Add an appointment record to the appointment array
-void addAppointment(struct Appointment *app, const int maxAppointments, struct Patient *pt, int maxPatients);
+void addAppointment(struct ClinicData *data);
 
 // Remove an appointment record from the appointment array
-void removeAppointment(struct Appointment *app, const int maxAppointments, struct Patient *pt, int maxPatients);
+void removeAppointment(struct ClinicData *data);
+
+// Add a recurring appointment series
+void addSeries(struct ClinicData *data);
+
+// Add back-to-back appointments for every patient in a household
+void addHouseholdAppointments(struct ClinicData *data);
+
+// Display the appointment statistics report
+void displayAppointmentStats(const struct ClinicData *data);
 
 //////////////////////////////////////
 // UTILITY FUNCTIONS
 //////////////////////////////////////
 
 // Search and display patient record by patient number (form)
-void searchPatientByPatientNumber(const struct Patient patient[], int max);
+void searchPatientByPatientNumber(const struct ClinicData *data);
 
 // Search and display patient records by phone number (tabular)
-void searchPatientByPhoneNumber(const struct Patient patient[], int max);
+void searchPatientByPhoneNumber(const struct ClinicData *data);
 
 // Get the next highest patient number
-int nextPatientNumber(const struct Patient patient[], int max);
+int nextPatientNumber(const struct ClinicData *data);
 
 // Find the patient array index by patient number (returns -1 if not found)
 int findPatientIndexByPatientNum(int patientNumber,
                                  const struct Patient patient[], int max);
 
-// Sort the data by date (using bubble sort)
-void sortData(struct Appointment appoints[], int max);
+// Find the patient store slot of a patient number through the number index
+// (returns -1 if not found)
+int findPatientSlot(const struct ClinicData *data, int patientNumber);
+
+// Sort the live appointments by date and time to the front of the array, the empty
+// records after them (stable; returns the live count, -1 and unchanged if out of memory)
+int sortData(struct Appointment appoints[], int max);
 
-// Check the next available slot for appointment
-int nextAvailableSlot(struct Appointment appoints[], int max);
+// Check the next available slot for appointment (returns -1 if the listing is full)
+int nextAvailableSlot(const struct ClinicData *data);
 
 // Check if the appointment exists
 int checkAppointment(int patientNumber, struct Date date, struct Appointment *app, int max);
 
+// Find a patient's appointment on a date through the interval index (returns the
+// lowest matching store slot, -1 if there is none)
+int findPatientAppointment(const struct ClinicData *data, int patientNumber,
+                           const struct Date *date);
+
+// Copy up to "max" store slots of a patient's appointments on a date in time order,
+// then resource order (returns the total)
+int findPatientAppointments(const struct ClinicData *data, int patientNumber,
+                            const struct Date *date, int slots[], int max);
+
+// Find the booking of a patient at the appointment's date, time and resource
+// (returns its store slot, -1 if there is none)
+int findAppointmentAt(const struct ClinicData *data, const struct Appointment *appoint);
+
+// Check if the time is within clinic hours on a MINUTE_INTERVAL boundary
+int isValidAppointmentTime(const struct Time *time);
+
+// Check if an appointment of "minutes" starting at time ends within clinic hours
+int isValidAppointmentLength(const struct Time *time, int minutes);
+
+// Check if the date and time slot is free on some resource (returns 1 if available)
+int isTimeslotAvailable(const struct ClinicData *data, const struct Date *date,
+                        const struct Time *time);
+
+// Find the lowest resource free for "minutes" from date/time (returns -1 if all are busy)
+int findFreeResource(const struct ClinicData *data, const struct Date *date,
+                     const struct Time *time, int minutes);
+
+// Copy up to "max" of a resource's bookings on a date in time order (returns the total)
+int resourceDaySchedule(const struct ClinicData *data, int resource, const struct Date *date,
+                        struct Appointment appoints[], int max);
+
+// Copy up to "max" of the date's bookings, series occurrences included, in time order
+// (returns the total)
+int clinicDaySchedule(const struct ClinicData *data, const struct Date *date,
+                      struct Appointment appoints[], int max);
+
+// Find the earliest start of "count" consecutive slots free on one resource at or after date/time
+// (returns 1 and fills foundDate/foundTime, or 0 if none is open)
+int findNextTimeslot(const struct ClinicData *data, const struct Date *date,
+                     const struct Time *time, int count,
+                     struct Date *foundDate, struct Time *foundTime);
+
+// Book an appointment without prompting (returns BOOK_OK or a BOOK_ error code)
+int bookAppointment(struct ClinicData *data, const struct Appointment *appoint);
+
+// Book a recurring series whose every occurrence is free (returns BOOK_OK or a BOOK_ error code)
+int bookSeries(struct ClinicData *data, const struct Series *series);
+
+// Find a patient's series with an occurrence on the date (returns -1 if not found)
+int findPatientSeries(const struct ClinicData *data, int patientNumber, const struct Date *date);
+
+// Copy up to "max" store slots of a patient's series with an occurrence on the date,
+// in slot order (returns the total)
+int findPatientSeriesOn(const struct ClinicData *data, int patientNumber,
+                        const struct Date *date, int slots[], int max);
+
+// Find a patient's series by its first occurrence, time and resource
+// (returns its store slot, -1 if there is none)
+int findSeriesAt(const struct ClinicData *data, const struct Series *rule);
+
+// Cancel a recurring series (every occurrence)
+void cancelSeries(struct ClinicData *data, int index);
+
+// Apply a change read from another clinic's feed (returns 1 if it applied,
+// 0 if this clinic is out of step with the feed, e.g. the record is missing)
+int applyClinicChange(struct ClinicData *data, const struct ChangeRecord *change);
+
+// Copy up to "max" store slots of a patient's household in patient number order
+// (a patient without a phone number is a household of one; returns the total,
+// 0 if the patient is not found)
+int findPatientHousehold(const struct ClinicData *data, int patientNumber, int slots[], int max);
+
+// Check if a date has no free slot left on any resource
+int isDayFullyBooked(const struct ClinicData *data, const struct Date *date);
+
+// Queue a patient for a date's next free slot (returns the number now waiting
+// for the date, 0 if the patient is not found or out of memory)
+int joinWaitlist(struct ClinicData *data, int patientNumber, const struct Date *date,
+                 int urgency);
+
+// Book a date's waiters, most urgent and then earliest first, into its free slots and copy
+// up to "max" of the bookings made (stops at "max"; returns the number copied)
+int promoteWaitlist(struct ClinicData *data, const struct Date *date,
+                    struct Appointment promoted[], int max);
+
+// Book back-to-back appointments on one resource for every patient in a household,
+// in patient number order from date/time (returns BOOK_OK or a BOOK_ error code;
+// nothing is booked unless every appointment fits)
+int bookHousehold(struct ClinicData *data, int patientNumber, const struct Date *date,
+                  const struct Time *time);
+
+//////////////////////////////////////
+// CURSOR FUNCTIONS
+//////////////////////////////////////
+
+// Minutes since 1970-01-01 00:00 of a date and time (the appointment listing order)
+long long dateTimeKey(const struct Date *date, const struct Time *time);
+
+// Copy the store slots of up to "max" patients numbered above "after", in number order
+// (after 0 starts at the first patient; returns the number of slots copied)
+int pagePatients(const struct ClinicData *data, int after, int slots[], int max);
+
+// Position a cursor before the first appointment
+void startAppointmentCursor(struct AppointmentCursor *cursor);
+
+// Position a cursor before the first appointment starting at or after "start" (see dateTimeKey)
+void seekAppointmentCursor(struct AppointmentCursor *cursor, long long start);
+
+// Copy the store slots of up to "max" appointments following the cursor in date order
+// and advance the cursor past them (recurring series are not expanded; returns the
+// number of slots copied)
+int pageAppointments(const struct ClinicData *data, struct AppointmentCursor *cursor,
+                     int slots[], int max);
+
+//////////////////////////////////////
+// RECORD FUNCTIONS
+//////////////////////////////////////
+
+// Get the patient's name
+const char *patientName(const struct Patient *patient);
+
+// Set the patient's name (the text is interned)
+void setPatientName(struct Patient *patient, const char *name);
+
+// Get the patient's contact type (PHONE_CELL .. PHONE_TBD)
+int patientPhoneType(const struct Patient *patient);
+
+// Get the patient's phone number as an integer (PHONE_NO_NUMBER if none)
+unsigned long long patientPhoneNumber(const struct Patient *patient);
+
+// Unpack the patient's phone into its text form
+void getPatientPhone(const struct Patient *patient, struct Phone *phone);
+
+// Pack a text form phone into the patient record
+void setPatientPhone(struct Patient *patient, const struct Phone *phone);
+
+// Convert a 10-digit phone string to an integer (PHONE_NO_NUMBER if not 10 digits)
+unsigned long long parsePhoneNumber(const char *number);
+
+// Convert a phone description (CELL/HOME/WORK/TBD) to a contact type
+int parsePhoneType(const char *description);
+
+// Get the description of a contact type
+const char *phoneTypeName(int type);
+
+//////////////////////////////////////
+// STORE FUNCTIONS
+//////////////////////////////////////
+
+// Allocate empty patient and appointment stores from the clinic's arena (returns 1 on success)
+int createClinic(struct ClinicData *data, int maxPatient, int maxAppointments);
+
+// Release the stores and everything else allocated from the clinic's arena
+void destroyClinic(struct ClinicData *data);
+
+// Rebuild the vacant slot lists after records were moved or written directly
+void syncClinicSlots(struct ClinicData *data);
+
+// Rebuild the slot lists and every index after records were written directly (e.g. by an import)
+// (appointments naming no valid resource or length are moved to resource 0 or
+// MINUTE_INTERVAL minutes, with a warning giving how many)
+void syncClinicIndexes(struct ClinicData *data);
+
+// Keep a snapshot store in step with the patient and appointment stores from now on
+// (publishes the current records; returns 0 when out of memory)
+int attachClinicSnapshots(struct ClinicData *data, struct SnapshotStore *snapshots);
+
+// Set the number of bookable resources (never below the highest one booked; returns 1 on success)
+int setClinicResources(struct ClinicData *data, int count);
+
+// Display the store allocation statistics
+void displayClinicMemory(const struct ClinicData *data);
+
 //////////////////////////////////////
 // USER INPUT FUNCTIONS
 //////////////////////////////////////
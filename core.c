@@ -1,9 +1,110 @@
 #define _CRT_SECURE_NO_WARNINGS
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <ctype.h>
+#include <errno.h>
+#include <limits.h>
 #include "core.h"
 
+// Standard input is read through one buffer of this many bytes, a line at a
+// time; a recorded session piped in is parsed in place instead of through one
+// scanf call per field
+#define INPUT_BUFFER_LEN (64 * 1024)
+
+// Data type: the input buffer
+struct InputBuffer
+{
+    char data[INPUT_BUFFER_LEN];
+    int len;
+    int pos;
+};
+
+static struct InputBuffer input;
+
+// -1 until the environment is checked, then whether to mark input requests
+static int markInput = -1;
+
+//////////////////////////////////////
+// INPUT BUFFER FUNCTIONS
+//////////////////////////////////////
+
+// Read more input once the buffer is used up (returns 0 at the end of input)
+static int refillInput(void)
+{
+    // The prompt must be out before waiting for the answer; a session replay
+    // driver also gets a marker telling it the clinic is waiting
+    if (markInput == -1)
+    {
+        markInput = getenv(INPUT_MARKER_ENV) != NULL;
+    }
+    if (markInput)
+    {
+        putchar(INPUT_MARKER);
+    }
+    fflush(stdout);
+    // fgets returns as soon as a line is in, so the menus never wait for more
+    // input than the user has typed
+    input.len = 0;
+    input.pos = 0;
+    while (fgets(input.data, INPUT_BUFFER_LEN, stdin) == NULL)
+    {
+        if (!ferror(stdin) || errno != EINTR)
+        {
+            return 0;
+        }
+        clearerr(stdin);
+    }
+    input.len = (int)strlen(input.data);
+    return input.len > 0;
+}
+
+// Next input character without taking it (EOF at the end of input)
+static int peekInput(void)
+{
+    if (input.pos == input.len && !refillInput())
+    {
+        return EOF;
+    }
+    return (unsigned char)input.data[input.pos];
+}
+
+// Take the next input character (EOF at the end of input)
+static int nextInput(void)
+{
+    int ch = peekInput();
+
+    if (ch != EOF)
+    {
+        input.pos++;
+    }
+    return ch;
+}
+
+// The input ran out before the user left the menus: nothing more can be answered
+static void endOfInput(void)
+{
+    printf("\n*** End of input ***\n");
+    exit(EXIT_FAILURE);
+}
+
+// Skip white space, across lines (returns the next character, without taking it)
+static int skipInputSpace(void)
+{
+    int ch;
+
+    while ((ch = peekInput()) != EOF && isspace(ch))
+    {
+        input.pos++;
+    }
+    if (ch == EOF)
+    {
+        endOfInput();
+    }
+    return ch;
+}
+
 //////////////////////////////////////
 // USER INTERFACE FUNCTIONS
 //////////////////////////////////////
@@ -11,10 +112,22 @@
 // Clear the standard input buffer
 void clearInputBuffer(void)
 {
-    // Discard all remaining char's from the standard input buffer:
-    while (getchar() != '\n')
+    const char *newLine;
+
+    // Discard all remaining char's up to and including the end of the line
+    for (;;)
     {
-        ; // do nothing!
+        if (peekInput() == EOF)
+        {
+            endOfInput();
+        }
+        newLine = memchr(input.data + input.pos, '\n', input.len - input.pos);
+        if (newLine != NULL)
+        {
+            input.pos = (int)(newLine - input.data) + 1;
+            return;
+        }
+        input.pos = input.len;
     }
 }
 
@@ -26,6 +139,21 @@ void suspend(void)
     putchar('\n');
 }
 
+// Wait for the user between pages of a listing (returns 0 if "q" was entered)
+int suspendPage(void)
+{
+    int ch;
+
+    printf("-- More: <ENTER> next page, q to stop --");
+    ch = nextInput();
+    if (ch != '\n' && ch != EOF)
+    {
+        clearInputBuffer();
+    }
+    putchar('\n');
+    return ch != 'q' && ch != 'Q' && ch != EOF;
+}
+
 //////////////////////////////////////
 // USER INPUT FUNCTIONS
 //////////////////////////////////////
@@ -33,20 +161,35 @@ void suspend(void)
 // Get an integer from the user
 int inputInt(void)
 {
-    char newLine = 'x';
-    int value = 0;
+    long long value, limit;
+    int ch, negative, digits;
 
-    while (newLine != '\n')
+    // A whole number right before the end of the line, after any white space
+    for (;;)
     {
-        scanf("%d%c", &value, &newLine);
-        if (newLine != '\n')
+        ch = skipInputSpace();
+        negative = ch == '-';
+        if (ch == '-' || ch == '+')
+        {
+            input.pos++;
+        }
+        value = 0;
+        limit = negative ? -(long long)INT_MIN : INT_MAX;
+        for (digits = 0; (ch = peekInput()) != EOF && isdigit(ch); digits++)
         {
-            clearInputBuffer();
-            printf("Error! Input a whole number: ");
+            // Out of range numbers clamp to INT_MIN/INT_MAX, so range checks reject them
+            value = value > (limit - (ch - '0')) / 10 ? limit : value * 10 + (ch - '0');
+            input.pos++;
         }
+        if (digits > 0 && nextInput() == '\n')
+        {
+            break;
+        }
+        clearInputBuffer();
+        printf("Error! Input a whole number: ");
     }
 
-    return value;
+    return (int)(negative ? -value : value);
 }
 
 // Validate and get a positive integer from the user
@@ -86,107 +229,102 @@ int inputIntRange(int min, int max)
 // Get a character from the user that matches one of the characters in the stringList
 char inputCharOption(const char *stringList)
 {
+    int ch;
 
-    char cValue;
-    int i = 0;
-    int stopLoop = 0;
-
-    do
+    // The character is taken as typed (even a new line) and the rest of its line
+    // dropped; after an invalid one the next line is dropped as well, so recorded
+    // sessions take the same lines as ever
+    for (;;)
     {
-        scanf("%c", &cValue);
-        clearInputBuffer();
-
-        for (i = 0; stringList[i] != '\0'; i++)
+        ch = nextInput();
+        if (ch == EOF)
         {
-
-            if (cValue == stringList[i])
-            {
-                stopLoop = 1;
-            }
+            endOfInput();
         }
-
-        if (stopLoop == 0)
+        clearInputBuffer();
+        if (ch != '\0' && strchr(stringList, ch) != NULL)
         {
-            printf("ERROR: Character must be one of [%s]: ", stringList);
-            clearInputBuffer();
+            return (char)ch;
         }
+        printf("ERROR: Character must be one of [%s]: ", stringList);
+        clearInputBuffer();
+    }
+}
 
-    } while (stopLoop == 0);
-
-    return cValue;
+// Get the first character after any white space and the character after it
+void inputCharPair(char *first, char *second)
+{
+    skipInputSpace();
+    *first = (char)nextInput();
+    if (peekInput() == EOF)
+    {
+        endOfInput();
+    }
+    *second = (char)nextInput();
 }
 
 // Get a string from the user
 void inputCString(char *strValue, int min, int max)
 {
-    int stopLoop = 0;
-    int strlength;
-    int exactlength = 0;
-    int i;
-    do
-    {
-
-        char stringList[100];
-        scanf(" %[^\n]", stringList);
-        clearInputBuffer();
-        strlength = 0;
-        //  char c = stringList[strlength];
+    int strlength, ch;
 
-        while (stringList[strlength] != EOF && stringList[strlength] != '\0')
+    // The line after any white space (leading blank lines included), copied
+    // straight from the input buffer while it fits
+    for (;;)
+    {
+        skipInputSpace();
+        for (strlength = 0; (ch = peekInput()) != EOF && ch != '\n'; strlength++)
         {
-            strlength++;
+            if (strlength < max)
+            {
+                strValue[strlength] = (char)ch;
+            }
+            input.pos++;
         }
+        clearInputBuffer();
 
         if (min == max)
         {
-            exactlength = min;
-            if (strlength == exactlength)
+            if (strlength == min)
             {
-                for (i = 0; i <= strlength; i++)
-                {
-                    strValue[i] = stringList[i];
-                }
-                stopLoop = 1;
-            }
-
-            else
-            {
-                printf("Invalid %d-digit number! Number: ", exactlength);
+                break;
             }
+            printf("Invalid %d-digit number! Number: ", min);
+        }
+        else if (strlength >= min && strlength <= max)
+        {
+            break;
+        }
+        else if (strlength > max)
+        {
+            printf("ERROR: String length must be no more than %d chars: ", max);
         }
         else
         {
-            if (strlength >= min && strlength <= max)
-            {
-                for (i = 0; i <= strlength; i++)
-                {
-                    strValue[i] = stringList[i];
-                }
-                stopLoop = 1;
-            }
-            else if (strlength > max)
-            {
-                printf("ERROR: String length must be no more than %d chars: ", max);
-            }
-            else
-            {
-                printf("ERROR: String length must be between %d and %d chars: ", min, max);
-            }
+            printf("ERROR: String length must be between %d and %d chars: ", min, max);
         }
-        stringList[strlength] = '\0';
-
-    } while (stopLoop == 0);
+    }
+    strValue[strlength] = '\0';
 }
 
 // Display a phone number in the format (xxx)xxx-xxxx
 void displayFormattedPhone(const char *number)
+{
+    char formatted[FORMATTED_PHONE_LEN + 1];
+
+    formatPhone(formatted, number);
+    fputs(formatted, stdout);
+}
+
+// Format a phone number as (xxx)xxx-xxxx into FORMATTED_PHONE_LEN + 1 chars
+void formatPhone(char *out, const char *number)
 {
     int digit = 0;
     int i = 0;
 
     if (number == NULL)
     {
-        printf("(___)___-____");
+        sprintf(out, "(___)___-____");
         return;
     }
 
@@ -202,12 +340,12 @@ void displayFormattedPhone(const char *number)
     if (digit == 10)
     {
 
-        printf("(%c%c%c)%c%c%c-%c%c%c%c", number[0], number[1], number[2],
-               number[3], number[4], number[5], number[6],
-               number[7], number[8], number[9]);
+        sprintf(out, "(%c%c%c)%c%c%c-%c%c%c%c", number[0], number[1], number[2],
+                number[3], number[4], number[5], number[6],
+                number[7], number[8], number[9]);
     }
     else
     {
-        printf("(___)___-____");
+        sprintf(out, "(___)___-____");
     }
 }
@@ -6,6 +6,14 @@
 #ifndef CORE_H
 #define CORE_H
 
+// Length of a formatted phone number: (xxx)xxx-xxxx
+#define FORMATTED_PHONE_LEN 13
+
+// With this environment variable set, INPUT_MARKER is written to the standard
+// output each time more input is needed (for the session replay driver)
+#define INPUT_MARKER_ENV "CLINIC_INPUT_MARKER"
+#define INPUT_MARKER '\0'
+
 //////////////////////////////////////
 // USER INTERFACE FUNCTIONS
 //////////////////////////////////////
@@ -16,6 +24,9 @@ void clearInputBuffer(void);
 // Wait for user to input the "enter" key to continue
 void suspend(void);
 
+// Wait for the user between pages of a listing (returns 0 if "q" was entered)
+int suspendPage(void);
+
 //////////////////////////////////////
 // USER INPUT FUNCTIONS
 //////////////////////////////////////
@@ -28,8 +39,14 @@ int inputIntRange(int min, int max);
 
 char inputCharOption(const char *stringList);
 
+// Get the first character after any white space and the character after it
+void inputCharPair(char *first, char *second);
+
 void inputCString(char *strValue, int min, int max);
 
 void displayFormattedPhone(const char *number);
 
+// Format a phone number as (xxx)xxx-xxxx into FORMATTED_PHONE_LEN + 1 chars
+void formatPhone(char *out, const char *number);
+
 #endif // !CORE_H
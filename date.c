@@ -0,0 +1,137 @@
+// include the user library "clinic" for the Date type
+#include "clinic.h"
+// include the user library "date" where the function prototypes are declared
+#include "date.h"
+
+//////////////////////////////////////
+// Internal macro's and tables
+//////////////////////////////////////
+
+// Days from 0001-01-01 to 1970-01-01
+#define DAYS_BEFORE_1970 719162
+
+// Whole 400-year cycles added to every year so the divisions below never
+// see a negative number (and need no floor corrections)
+#define YEAR_OFFSET 400000
+#define DAYS_PER_400_YEARS 146097
+#define DAYS_PER_100_YEARS 36524
+#define DAYS_PER_4_YEARS 1461
+
+// Days before each month (and the year's total) in common and leap years
+static const short daysBeforeMonth[2][13] = {
+    {0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334, 365},
+    {0, 31, 60, 91, 121, 152, 182, 213, 244, 274, 305, 335, 366},
+};
+
+//////////////////////////////////////
+// HELPERS
+//////////////////////////////////////
+
+// Day number of a year, month and day (the months carry into the year)
+static inline int dayNumber(int year, int month, int day)
+{
+    int m = month - 1, carry;
+    long long y;
+
+    // Only imported data can hold a month outside 1..12
+    if ((unsigned int)m > 11)
+    {
+        carry = m >= 0 ? m / 12 : -((11 - m) / 12);
+        year += carry;
+        m -= carry * 12;
+    }
+    y = (long long)year - 1 + YEAR_OFFSET;
+    return (int)(365 * y + y / 4 - y / 100 + y / 400 -
+                 (long long)(YEAR_OFFSET / 400) * DAYS_PER_400_YEARS - DAYS_BEFORE_1970 +
+                 daysBeforeMonth[isLeapYear(year)][m] + day - 1);
+}
+
+//////////////////////////////////////
+// DATE FUNCTIONS
+//////////////////////////////////////
+
+// Check for a leap year (Gregorian rules: every 4th year, except centuries not divisible by 400)
+int isLeapYear(int year)
+{
+    return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+}
+
+// Number of days in a month (1..12) of a year (0 for any other month)
+int daysInMonth(int year, int month)
+{
+    int leap = isLeapYear(year);
+
+    if (month < MIN_MONTH || month > MAX_MONTH)
+    {
+        return 0;
+    }
+    return daysBeforeMonth[leap][month] - daysBeforeMonth[leap][month - 1];
+}
+
+// Check that a date names a real day (year 1 or later)
+int isValidDate(const struct Date *date)
+{
+    return date->year > 0 && date->day >= MIN_DAY &&
+           date->day <= daysInMonth(date->year, date->month);
+}
+
+// Days since 1970-01-01 of a date (proleptic Gregorian calendar; out of range
+// months and days carry into the next month or year)
+int dateToDay(const struct Date *date)
+{
+    return dayNumber(date->year, date->month, date->day);
+}
+
+// Date of a day number (days since 1970-01-01)
+void dayToDate(int day, struct Date *date)
+{
+    long long z = (long long)day + DAYS_BEFORE_1970 +
+                  (long long)(YEAR_OFFSET / 400) * DAYS_PER_400_YEARS;
+    int cycles400, cycles100, cycles4, years, rest, leap, month;
+
+    // Peel whole 400, 100, 4 and 1 year spans off the days since 0001-01-01
+    // (the last century of 400 years and the last year of 4 are a day longer)
+    cycles400 = (int)(z / DAYS_PER_400_YEARS);
+    rest = (int)(z % DAYS_PER_400_YEARS);
+    cycles100 = rest / DAYS_PER_100_YEARS;
+    cycles100 -= cycles100 == 4;
+    rest -= cycles100 * DAYS_PER_100_YEARS;
+    cycles4 = rest / DAYS_PER_4_YEARS;
+    rest -= cycles4 * DAYS_PER_4_YEARS;
+    years = rest / 365;
+    years -= years == 4;
+    rest -= years * 365;
+
+    date->year = cycles400 * 400 + cycles100 * 100 + cycles4 * 4 + years + 1 - YEAR_OFFSET;
+
+    // Every month before December starts on or after day 32 * (month - 1),
+    // so rest / 32 is the month or the one before it
+    leap = isLeapYear(date->year);
+    month = rest >> 5;
+    month += rest >= daysBeforeMonth[leap][month + 1];
+    date->month = month + 1;
+    date->day = rest - daysBeforeMonth[leap][month] + 1;
+}
+
+// Weekday of a day number (WEEKDAY_SUNDAY .. WEEKDAY_SATURDAY)
+int dateWeekday(int day)
+{
+    // 1970-01-01 was a Thursday
+    return (day % 7 + 11) % 7;
+}
+
+// Convert "count" dates, each "stride" bytes after the previous one, to day numbers
+// (e.g. the date field of every record in an array)
+void datesToDays(const struct Date *first, size_t stride, int days[], int count)
+{
+    const char *at = (const char *)first;
+    const struct Date *date;
+    int i;
+
+    // Table lookups and divisions only: no per-date loops or month chains
+    for (i = 0; i < count; i++, at += stride)
+    {
+        date = (const struct Date *)at;
+        days[i] = dayNumber(date->year, date->month, date->day);
+    }
+}
@@ -0,0 +1,50 @@
+// SAFE-GUARD:
+// It is good practice to apply safe-guards to header files
+// Safe-guard's ensures only 1 copy of the header file is used in the project build
+// The macro name should be mirroring the file name with _ for spaces, dots, etc.
+#ifndef DATE_H
+#define DATE_H
+
+#include <stddef.h>
+
+struct Date;
+
+//////////////////////////////////////
+// Module macro's (usable by any file that includes this header)
+//////////////////////////////////////
+
+// Day number of 0001-01-01, the earliest date isValidDate accepts
+#define FIRST_VALID_DAY (-719162)
+
+// Weekdays returned by dateWeekday
+#define WEEKDAY_SUNDAY 0
+#define WEEKDAY_SATURDAY 6
+
+//////////////////////////////////////
+// DATE FUNCTIONS
+//////////////////////////////////////
+
+// Check for a leap year (Gregorian rules: every 4th year, except centuries not divisible by 400)
+int isLeapYear(int year);
+
+// Number of days in a month (1..12) of a year (0 for any other month)
+int daysInMonth(int year, int month);
+
+// Check that a date names a real day (year 1 or later)
+int isValidDate(const struct Date *date);
+
+// Days since 1970-01-01 of a date (proleptic Gregorian calendar; out of range
+// months and days carry into the next month or year)
+int dateToDay(const struct Date *date);
+
+// Date of a day number (days since 1970-01-01)
+void dayToDate(int day, struct Date *date);
+
+// Weekday of a day number (WEEKDAY_SUNDAY .. WEEKDAY_SATURDAY)
+int dateWeekday(int day);
+
+// Convert "count" dates, each "stride" bytes after the previous one, to day numbers
+// (e.g. the date field of every record in an array)
+void datesToDays(const struct Date *first, size_t stride, int days[], int count);
+
+#endif // !DATE_H
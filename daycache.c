@@ -0,0 +1,106 @@
+#include <stdlib.h>
+#include <string.h>
+
+// include the user library "daycache" where the function prototypes are declared
+#include "daycache.h"
+
+//////////////////////////////////////
+// DAY CACHE FUNCTIONS
+//////////////////////////////////////
+
+// Entry a day maps to
+static struct DayCacheEntry *entryFor(struct DayCache *cache, int day)
+{
+    return &cache->entries[(unsigned int)day & (DAYCACHE_SLOTS - 1)];
+}
+
+// Find a day's rendered rows (returns NULL on a miss)
+const struct DayCacheEntry *dayCacheFind(struct DayCache *cache, int day)
+{
+    struct DayCacheEntry *entry = entryFor(cache, day);
+
+    if (entry->used && entry->day == day)
+    {
+        cache->hits++;
+        return entry;
+    }
+    cache->misses++;
+    return NULL;
+}
+
+// Store a copy of a day's rendered rows and the patients booked that day (returns 1 on success)
+int dayCacheStore(struct DayCache *cache, int day, const char *text, size_t length,
+                  const int patients[], int patientCount)
+{
+    struct DayCacheEntry *entry = entryFor(cache, day);
+    char *block;
+
+    // One block holds the patient list followed by the text
+    block = malloc(sizeof(int) * patientCount + length + 1);
+    if (block == NULL)
+    {
+        return 0;
+    }
+    free(entry->patients);
+    entry->patients = (int *)block;
+    entry->text = block + sizeof(int) * patientCount;
+    memcpy(entry->patients, patients, sizeof(int) * patientCount);
+    memcpy(entry->text, text, length);
+    entry->text[length] = '\0';
+    entry->length = length;
+    entry->patientCount = patientCount;
+    entry->day = day;
+    entry->used = 1;
+    return 1;
+}
+
+// Invalidate a cache entry
+void dayCacheDropEntry(struct DayCache *cache, struct DayCacheEntry *entry)
+{
+    if (entry->used)
+    {
+        free(entry->patients);
+        memset(entry, 0, sizeof(*entry));
+        cache->drops++;
+    }
+}
+
+// Invalidate a day
+void dayCacheDropDay(struct DayCache *cache, int day)
+{
+    struct DayCacheEntry *entry = entryFor(cache, day);
+
+    if (entry->used && entry->day == day)
+    {
+        dayCacheDropEntry(cache, entry);
+    }
+}
+
+// Invalidate every day the patient is booked on
+void dayCacheDropPatient(struct DayCache *cache, int patientNumber)
+{
+    int i, j;
+
+    for (i = 0; i < DAYCACHE_SLOTS; i++)
+    {
+        for (j = 0; j < cache->entries[i].patientCount; j++)
+        {
+            if (cache->entries[i].patients[j] == patientNumber)
+            {
+                dayCacheDropEntry(cache, &cache->entries[i]);
+                break;
+            }
+        }
+    }
+}
+
+// Invalidate every day
+void dayCacheClear(struct DayCache *cache)
+{
+    int i;
+
+    for (i = 0; i < DAYCACHE_SLOTS; i++)
+    {
+        dayCacheDropEntry(cache, &cache->entries[i]);
+    }
+}
@@ -0,0 +1,64 @@
+// SAFE-GUARD:
+// It is good practice to apply safe-guards to header files
+// Safe-guard's ensures only 1 copy of the header file is used in the project build
+// The macro name should be mirroring the file name with _ for spaces, dots, etc.
+#ifndef DAYCACHE_H
+#define DAYCACHE_H
+
+#include <stddef.h>
+
+//////////////////////////////////////
+// Module macro's (usable by any file that includes this header)
+//////////////////////////////////////
+
+// Cached days (direct mapped by day number, a power of 2)
+#define DAYCACHE_SLOTS 64
+
+//////////////////////////////////////
+// Structures
+//////////////////////////////////////
+
+// Data type: one day's rendered schedule rows
+struct DayCacheEntry
+{
+    int day; // day number (days since 1970-01-01)
+    int used;
+    char *text;
+    size_t length;
+    int *patients; // patient numbers booked on the day (rendered or not)
+    int patientCount;
+};
+
+// Data type: rendered schedule cache
+struct DayCache
+{
+    struct DayCacheEntry entries[DAYCACHE_SLOTS];
+    long long hits;
+    long long misses;
+    long long drops; // entries invalidated by a mutation
+};
+
+//////////////////////////////////////
+// DAY CACHE FUNCTIONS
+//////////////////////////////////////
+
+// Find a day's rendered rows (returns NULL on a miss)
+const struct DayCacheEntry *dayCacheFind(struct DayCache *cache, int day);
+
+// Store a copy of a day's rendered rows and the patients booked that day (returns 1 on success)
+int dayCacheStore(struct DayCache *cache, int day, const char *text, size_t length,
+                  const int patients[], int patientCount);
+
+// Invalidate a day
+void dayCacheDropDay(struct DayCache *cache, int day);
+
+// Invalidate every day the patient is booked on
+void dayCacheDropPatient(struct DayCache *cache, int patientNumber);
+
+// Invalidate a cache entry
+void dayCacheDropEntry(struct DayCache *cache, struct DayCacheEntry *entry);
+
+// Invalidate every day
+void dayCacheClear(struct DayCache *cache);
+
+#endif // !DAYCACHE_H
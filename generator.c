@@ -0,0 +1,510 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <time.h>
+
+// include the user library "clinic" for the store limits and clinic hours
+#include "clinic.h"
+// include the user library "date" for the day numbers of the bookings
+#include "date.h"
+// include the user library "generator" where the function prototypes are declared
+#include "generator.h"
+
+//////////////////////////////////////
+// Internal macro's
+//////////////////////////////////////
+
+// Bookable starts per resource and day (the last one is END_HOUR:00)
+#define GRID_SLOTS ((END_HOUR - START_HOUR) * 60 / MINUTE_INTERVAL + 1)
+
+// Longest generated line of either file
+#define GENERATOR_LINE_LEN 64
+
+// Bookings ahead whose patient is drawn early and its number prefetched
+// (a random read of a table of millions of numbers misses the cache)
+#define PREFETCH_DISTANCE 16
+
+// Data type: an output file and its buffer
+struct GeneratorOutput
+{
+    FILE *fp;
+    char *buffer;
+    size_t length;
+    long long bytes;
+    int failed;
+};
+
+// Data type: the booked cells (resource * GRID_SLOTS + slot) of every day
+struct BookingGrid
+{
+    unsigned long long *cells; // "words" words per day
+    int *used;                 // booked cells per day
+    int *next;                 // a day at or after this one with room (union-find)
+    int days;
+    int words;
+    int cellsPerDay;
+};
+
+// Short enough that "first surname" always fits NAME_LEN
+static const char *const firstNames[] = {
+    "Shaggy", "Pugsley", "Beans",  "Banjo",  "Lettuce", "Bullet", "Nugget", "Bessie",
+    "Potato", "Alfie",   "Biscuit", "Coco",  "Daisy",   "Fudge",  "Ginger", "Hazel",
+    "Jasper", "Kona",    "Luna",   "Mango",  "Nacho",   "Oreo",   "Pepper", "Pickles",
+    "Quincy", "Rocky",   "Sadie",  "Tango",  "Waffles", "Ziggy",  "Bruno",  "Cookie",
+    "Dexter", "Echo",    "Felix",  "Gus",    "Hank",    "Ivy",    "Juno",   "Kiwi",
+    "Loki",   "Milo",    "Nala",   "Ollie",  "Pip",     "Rex",    "Simba",  "Toby"};
+static const char *const surnames[] = {
+    "Yanson", "Maulin", "Codi",   "Peas",   "Lemme",  "Smee",   "Baker",  "Chen",
+    "Diaz",   "Evans",  "Fisher", "Garcia", "Hughes", "Irwin",  "Jones",  "Khan",
+    "Lopez",  "Morgan", "Nguyen", "Owens",  "Patel",  "Quinn",  "Reyes",  "Singh",
+    "Tran",   "Usman",  "Vargas", "Walsh",  "Young",  "Zhang",  "Abbott", "Brooks"};
+
+//////////////////////////////////////
+// HELPERS
+//////////////////////////////////////
+
+// Monotonic clock in seconds
+static double nowSeconds(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Next random number (xorshift64*)
+static unsigned long long nextRandom(unsigned long long *state)
+{
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 0x2545F4914F6CDD1DULL;
+}
+
+// Random number in 0..n-1 (n below 2^32)
+static long randomBelow(unsigned long long *state, long n)
+{
+    return (long)(((nextRandom(state) >> 32) * (unsigned long long)n) >> 32);
+}
+
+// Random number in 0..n-1 skewed toward 0: the product of two uniform draws
+// (half of the results fall below n / 5, the mean is n / 4)
+static long randomSkewed(unsigned long long *state, long n)
+{
+    unsigned long long product = (nextRandom(state) >> 32) * (nextRandom(state) >> 32);
+
+    return (long)((product >> 32) * (unsigned long long)n >> 32);
+}
+
+// Write "value" in decimal, zero padded to "width" digits (returns the end)
+static char *putDigits(char *out, unsigned long long value, int width)
+{
+    char digits[20];
+    int n = 0;
+
+    do
+    {
+        digits[n++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value);
+    while (n < width)
+    {
+        digits[n++] = '0';
+    }
+    while (n)
+    {
+        *out++ = digits[--n];
+    }
+    return out;
+}
+
+// Copy a string (returns the end)
+static char *putText(char *out, const char *text)
+{
+    while (*text)
+    {
+        *out++ = *text++;
+    }
+    return out;
+}
+
+//////////////////////////////////////
+// OUTPUT FUNCTIONS
+//////////////////////////////////////
+
+// Create an output file (returns 1 on success)
+static int outputOpen(struct GeneratorOutput *out, const char *file)
+{
+    out->fp = fopen(file, "w");
+    out->buffer = malloc(GENERATOR_BUFFER);
+    out->length = 0;
+    out->bytes = 0;
+    out->failed = 0;
+    if (out->fp == NULL || out->buffer == NULL)
+    {
+        if (out->fp != NULL)
+        {
+            fclose(out->fp);
+        }
+        free(out->buffer);
+        return 0;
+    }
+    return 1;
+}
+
+// Write out the buffer
+static void outputFlush(struct GeneratorOutput *out)
+{
+    if (out->length > 0 && fwrite(out->buffer, 1, out->length, out->fp) != out->length)
+    {
+        out->failed = 1;
+    }
+    out->bytes += (long long)out->length;
+    out->length = 0;
+}
+
+// Room for one more line: the end of the buffered output
+static char *outputLine(struct GeneratorOutput *out)
+{
+    if (out->length + GENERATOR_LINE_LEN > GENERATOR_BUFFER)
+    {
+        outputFlush(out);
+    }
+    return out->buffer + out->length;
+}
+
+// Close an output file (returns 1 if everything was written)
+static int outputClose(struct GeneratorOutput *out)
+{
+    outputFlush(out);
+    if (fclose(out->fp) != 0)
+    {
+        out->failed = 1;
+    }
+    free(out->buffer);
+    return !out->failed;
+}
+
+//////////////////////////////////////
+// BOOKING GRID FUNCTIONS
+//////////////////////////////////////
+
+// Set up an empty grid of "days" days for "resources" resources (returns 1 on success)
+static int gridInit(struct BookingGrid *grid, int days, int resources)
+{
+    int i;
+
+    grid->days = days;
+    grid->cellsPerDay = resources * GRID_SLOTS;
+    grid->words = (grid->cellsPerDay + 63) / 64;
+    grid->cells = calloc((size_t)days * grid->words, sizeof(*grid->cells));
+    grid->used = calloc((size_t)days, sizeof(*grid->used));
+    grid->next = malloc(sizeof(*grid->next) * ((size_t)days + 1));
+    if (grid->cells == NULL || grid->used == NULL || grid->next == NULL)
+    {
+        free(grid->cells);
+        free(grid->used);
+        free(grid->next);
+        return 0;
+    }
+    for (i = 0; i <= days; i++)
+    {
+        grid->next[i] = i;
+    }
+    return 1;
+}
+
+// Free a grid
+static void gridFree(struct BookingGrid *grid)
+{
+    free(grid->cells);
+    free(grid->used);
+    free(grid->next);
+}
+
+// First day at or after "day" with a free cell (returns grid->days if there is none)
+static int gridDayWithRoom(struct BookingGrid *grid, int day)
+{
+    while (grid->next[day] != day)
+    {
+        grid->next[day] = grid->next[grid->next[day]]; // path halving
+        day = grid->next[day];
+    }
+    return day;
+}
+
+// Is a cell of a day booked?
+static int gridBooked(const struct BookingGrid *grid, int day, int cell)
+{
+    return (grid->cells[(size_t)day * grid->words + cell / 64] >> (cell % 64)) & 1;
+}
+
+// Book a cell of a day (a full day then points on to the next one)
+static void gridBook(struct BookingGrid *grid, int day, int cell)
+{
+    grid->cells[(size_t)day * grid->words + cell / 64] |= 1ULL << (cell % 64);
+    if (++grid->used[day] == grid->cellsPerDay)
+    {
+        grid->next[day] = day + 1;
+    }
+}
+
+// First free cell of a day at or after "start", wrapping around (the day has room)
+static int gridFreeCell(const struct BookingGrid *grid, int day, int start)
+{
+    const unsigned long long *words = grid->cells + (size_t)day * grid->words;
+    unsigned long long vacant;
+    int word = start / 64, i, cell;
+
+    vacant = ~words[word] & (~0ULL << (start % 64));
+    for (i = 0; i <= grid->words; i++)
+    {
+        if (vacant != 0)
+        {
+            cell = word * 64 + __builtin_ctzll(vacant);
+            if (cell < grid->cellsPerDay)
+            {
+                return cell;
+            }
+        }
+        word = (word + 1) % grid->words;
+        vacant = ~words[word];
+    }
+    return -1;
+}
+
+//////////////////////////////////////
+// GENERATOR FUNCTIONS
+//////////////////////////////////////
+
+// Write the patients in households; their numbers are kept for the bookings
+// (returns # of households, and sets *tbd to the patients without a contact)
+static long generatePatients(struct GeneratorOutput *out, int numbers[], long patients,
+                             unsigned long long *random, long *tbd)
+{
+    static const char *const types[] = {"CELL", "HOME", "WORK", "TBD"};
+    const char *surname = surnames[0];
+    unsigned long long phone = 0;
+    long households = 0, i;
+    int number = GENERATOR_FIRST_NUMBER, members = 0, type = 0, draw;
+    char *line, *at;
+
+    *tbd = 0;
+    for (i = 0; i < patients; i++)
+    {
+        if (members == 0)
+        {
+            // 1 member half the time, 2 a quarter of the time, and so on
+            members = 1 + __builtin_ctzll(nextRandom(random) | 1ULL << (GENERATOR_MAX_HOUSEHOLD - 1));
+            surname = surnames[randomSkewed(random, sizeof(surnames) / sizeof(surnames[0]))];
+            draw = (int)randomBelow(random, 100);
+            type = draw < GENERATOR_CELL_PERCENT ? 0
+                   : draw < GENERATOR_CELL_PERCENT + GENERATOR_HOME_PERCENT ? 1
+                   : draw < GENERATOR_CELL_PERCENT + GENERATOR_HOME_PERCENT + GENERATOR_WORK_PERCENT
+                       ? 2
+                       : 3;
+            // Area codes and exchanges never start with 0 or 1
+            phone = (2 + randomBelow(random, 8)) * 1000000000ULL +
+                    randomBelow(random, 100) * 10000000ULL +
+                    (2 + randomBelow(random, 8)) * 1000000ULL + randomBelow(random, 1000000);
+            households++;
+        }
+        members--;
+
+        numbers[i] = number;
+        line = at = outputLine(out);
+        at = putDigits(at, (unsigned int)number, 0);
+        *at++ = '|';
+        at = putText(at, firstNames[randomBelow(random, sizeof(firstNames) / sizeof(firstNames[0]))]);
+        *at++ = ' ';
+        at = putText(at, surname);
+        *at++ = '|';
+        at = putText(at, types[type]);
+        *at++ = '|';
+        if (type == 3)
+        {
+            (*tbd)++;
+        }
+        else
+        {
+            at = putDigits(at, phone, PHONE_LEN);
+        }
+        *at++ = '\n';
+        out->length += (size_t)(at - line);
+
+        // One number in ten is skipped, as if that patient had been removed
+        number += randomBelow(random, 10) == 0 ? 2 + (int)randomBelow(random, 4) : 1;
+    }
+    return households;
+}
+
+// Write the bookings (returns # of days that have at least one, or -1 if the grid ran out)
+static long generateAppointments(struct GeneratorOutput *out, struct BookingGrid *grid,
+                                 const int numbers[], long patients, long appointments,
+                                 int firstDay, int nearDays, unsigned long long *random)
+{
+    struct Date date;
+    long upcoming[PREFETCH_DISTANCE], i, daysBooked = 0;
+    int day, cell, slot, resource, minutes, length, number;
+    char *line, *at;
+
+    // Frequent patients (the skewed low end of the list) get more of the bookings
+    for (i = 0; i < PREFETCH_DISTANCE; i++)
+    {
+        upcoming[i] = randomSkewed(random, patients);
+    }
+    for (i = 0; i < appointments; i++)
+    {
+        number = numbers[upcoming[i % PREFETCH_DISTANCE]];
+        upcoming[i % PREFETCH_DISTANCE] = randomSkewed(random, patients);
+        __builtin_prefetch(&numbers[upcoming[i % PREFETCH_DISTANCE]]);
+
+        if (randomBelow(random, 100) < GENERATOR_PAST_PERCENT)
+        {
+            day = (int)randomBelow(random, GENERATOR_PAST_DAYS);
+        }
+        else
+        {
+            day = GENERATOR_PAST_DAYS + (int)randomSkewed(random, nearDays * 4L);
+        }
+        day = gridDayWithRoom(grid, day);
+        if (day >= grid->days)
+        {
+            return -1;
+        }
+        cell = gridFreeCell(grid, day, (int)randomBelow(random, grid->cellsPerDay));
+        if (grid->used[day] == 0)
+        {
+            daysBooked++;
+        }
+        gridBook(grid, day, cell);
+        slot = cell % GRID_SLOTS;
+        resource = cell / GRID_SLOTS;
+        length = 1;
+        if (slot + 1 < GRID_SLOTS && !gridBooked(grid, day, cell + 1) &&
+            randomBelow(random, 100) < GENERATOR_LONG_PERCENT)
+        {
+            gridBook(grid, day, cell + 1);
+            length = 2;
+        }
+
+        dayToDate(firstDay + day, &date);
+        minutes = START_HOUR * 60 + slot * MINUTE_INTERVAL;
+        line = at = outputLine(out);
+        at = putDigits(at, (unsigned int)number, 0);
+        *at++ = ',';
+        at = putDigits(at, (unsigned int)date.year, 0);
+        *at++ = ',';
+        at = putDigits(at, (unsigned int)date.month, 0);
+        *at++ = ',';
+        at = putDigits(at, (unsigned int)date.day, 0);
+        *at++ = ',';
+        at = putDigits(at, (unsigned int)(minutes / 60), 0);
+        *at++ = ',';
+        at = putDigits(at, (unsigned int)(minutes % 60), 0);
+        // The original six fields unless the booking needs more
+        if (resource != 0 || length != 1)
+        {
+            *at++ = ',';
+            at = putDigits(at, (unsigned int)resource, 0);
+            *at++ = ',';
+            at = putDigits(at, (unsigned int)(length * MINUTE_INTERVAL), 0);
+        }
+        *at++ = '\n';
+        out->length += (size_t)(at - line);
+    }
+    return daysBooked;
+}
+
+// Write "patients" patients and "appointments" bookings across "resources" resources
+// (0: enough for the bookings to stay near "from") to the two data files, from "seed";
+// prints the sizes and rates (returns 0 on success)
+int generateDataFiles(const char *patientFile, const char *appointmentFile, long patients,
+                      long appointments, int resources, const struct Date *from,
+                      unsigned long long seed)
+{
+    struct GeneratorOutput out;
+    struct BookingGrid grid;
+    unsigned long long random = seed * 0x9E3779B97F4A7C15ULL + 1; // any seed, 0 included
+    long households, tbd, daysBooked;
+    long long capacity;
+    int *numbers, days;
+    double started, patientSeconds, appointmentSeconds;
+
+    if (patients < 1 || patients > (INT_MAX - GENERATOR_FIRST_NUMBER) / 5 || appointments < 0 ||
+        appointments > INT_MAX / 2 || resources < 0 || resources > MAX_RESOURCES)
+    {
+        printf("ERROR: Generate 1-%d patients, 0-%d appointments and 1-%d resources\n",
+               (INT_MAX - GENERATOR_FIRST_NUMBER) / 5, INT_MAX / 2, MAX_RESOURCES);
+        return 1;
+    }
+    if (resources == 0)
+    {
+        // A month and a half of grid per batch of upcoming bookings
+        capacity = (long long)GRID_SLOTS * GENERATOR_NEAR_DAYS * 3;
+        resources = (int)((appointments + capacity - 1) / capacity);
+        resources = resources < 1 ? 1 : resources > MAX_RESOURCES ? MAX_RESOURCES : resources;
+    }
+    // History, the near window and room for every booking past it (two cells each)
+    capacity = (long long)GRID_SLOTS * resources;
+    days = (int)(GENERATOR_PAST_DAYS + GENERATOR_NEAR_DAYS * 4L +
+                 (appointments * 2 + capacity - 1) / capacity + 1);
+
+    numbers = malloc(sizeof(*numbers) * (size_t)patients);
+    if (numbers == NULL || !gridInit(&grid, days, resources))
+    {
+        free(numbers);
+        printf("ERROR: Out of memory\n");
+        return 1;
+    }
+    printf("Generating %ld patients and %ld appointments on %d resource(s) from %04d-%02d-%02d"
+           " (seed %llu)...\n",
+           patients, appointments, resources, from->year, from->month, from->day, seed);
+
+    started = nowSeconds();
+    if (!outputOpen(&out, patientFile))
+    {
+        printf("ERROR: Unable to create %s\n", patientFile);
+        free(numbers);
+        gridFree(&grid);
+        return 1;
+    }
+    households = generatePatients(&out, numbers, patients, &random, &tbd);
+    if (!outputClose(&out))
+    {
+        printf("ERROR: Writing %s failed\n", patientFile);
+        free(numbers);
+        gridFree(&grid);
+        return 1;
+    }
+    patientSeconds = nowSeconds() - started;
+    printf("%s: %ld patients in %ld households (%ld TBD contacts), %lld bytes in %.3f s"
+           " (%.0f MB/s)\n",
+           patientFile, patients, households, tbd, out.bytes, patientSeconds,
+           out.bytes / (patientSeconds + 1e-9) / 1e6);
+
+    started = nowSeconds();
+    if (!outputOpen(&out, appointmentFile))
+    {
+        printf("ERROR: Unable to create %s\n", appointmentFile);
+        free(numbers);
+        gridFree(&grid);
+        return 1;
+    }
+    daysBooked = generateAppointments(&out, &grid, numbers, patients, appointments,
+                                      dateToDay(from) - GENERATOR_PAST_DAYS,
+                                      GENERATOR_NEAR_DAYS, &random);
+    free(numbers);
+    gridFree(&grid);
+    if (!outputClose(&out) || daysBooked < 0)
+    {
+        printf("ERROR: Writing %s failed\n", appointmentFile);
+        return 1;
+    }
+    appointmentSeconds = nowSeconds() - started;
+    printf("%s: %ld appointments on %ld days, %lld bytes in %.3f s (%.0f MB/s)\n",
+           appointmentFile, appointments, daysBooked, out.bytes, appointmentSeconds,
+           out.bytes / (appointmentSeconds + 1e-9) / 1e6);
+    return 0;
+}
@@ -0,0 +1,63 @@
+// SAFE-GUARD:
+// It is good practice to apply safe-guards to header files
+// Safe-guard's ensures only 1 copy of the header file is used in the project build
+// The macro name should be mirroring the file name with _ for spaces, dots, etc.
+#ifndef GENERATOR_H
+#define GENERATOR_H
+
+#include "clinic.h"
+
+//////////////////////////////////////
+// Module macro's (usable by any file that includes this header)
+//////////////////////////////////////
+
+// Number given to the first generated patient
+#define GENERATOR_FIRST_NUMBER 1024
+
+// Largest household (patients sharing a surname and a contact number)
+#define GENERATOR_MAX_HOUSEHOLD 8
+
+// Percentages of contacts by type (the rest are TBD, without a number)
+#define GENERATOR_CELL_PERCENT 55
+#define GENERATOR_HOME_PERCENT 22
+#define GENERATOR_WORK_PERCENT 13
+
+// Percentage of bookings in the past year, and of two-interval bookings
+#define GENERATOR_PAST_PERCENT 10
+#define GENERATOR_LONG_PERCENT 15
+
+// Days of history, and the mean distance ahead of the upcoming bookings
+#define GENERATOR_PAST_DAYS 365
+#define GENERATOR_NEAR_DAYS 14
+
+// Output buffered before each write
+#define GENERATOR_BUFFER (1024 * 1024)
+
+//////////////////////////////////////
+// Generated data
+//////////////////////////////////////
+//
+// Patients are written in increasing number order with occasional gaps (as left
+// by removals), in households of 1 to GENERATOR_MAX_HOUSEHOLD pets whose sizes
+// halve in frequency as they grow. A household shares a surname, contact type
+// and number, so the household index sees realistic groups. Surnames are
+// skewed toward a common few.
+// A booking falls in the past year or, far more often, within a few weeks
+// ahead (a skewed draw around GENERATOR_NEAR_DAYS). It lands on the
+// START_HOUR..END_HOUR grid of a resource that is free at that time. When its
+// day is full it moves to the next day with room, as a clinic books out.
+// Frequent patients get more of the bookings. The files depend only on the
+// arguments, so the same seed and first day always give the same bytes.
+
+//////////////////////////////////////
+// GENERATOR FUNCTIONS
+//////////////////////////////////////
+
+// Write "patients" patients and "appointments" bookings across "resources" resources
+// (0: enough for the bookings to stay near "from") to the two data files, from "seed";
+// prints the sizes and rates (returns 0 on success)
+int generateDataFiles(const char *patientFile, const char *appointmentFile, long patients,
+                      long appointments, int resources, const struct Date *from,
+                      unsigned long long seed);
+
+#endif // !GENERATOR_H
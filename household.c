@@ -0,0 +1,244 @@
+#include <stdlib.h>
+#include <string.h>
+
+// include the user library "household" where the function prototypes are declared
+#include "household.h"
+
+//////////////////////////////////////
+// HELPERS
+//////////////////////////////////////
+
+// Bucket a phone number and surname hash to
+static int bucketOf(unsigned long long phone, unsigned int surname, int mask)
+{
+    unsigned long long key = phone * 0x9E3779B97F4A7C15ULL ^ surname;
+
+    return (int)((key ^ key >> 29) * 0xBF58476D1CE4E5B9ULL >> 32) & mask;
+}
+
+// Entry of a phone number and surname (returns -1 if never added)
+static int findHousehold(const struct HouseholdIndex *index, unsigned long long phone,
+                         unsigned int surname)
+{
+    const struct Household *entry;
+    int b;
+
+    if (index->index == NULL)
+    {
+        return -1;
+    }
+    for (b = bucketOf(phone, surname, index->indexMask); index->index[b];
+         b = (b + 1) & index->indexMask)
+    {
+        entry = &index->households[index->index[b] - 1];
+        if (entry->phone == phone && entry->surname == surname)
+        {
+            return index->index[b] - 1;
+        }
+    }
+    return -1;
+}
+
+// Find or add the entry of a phone number and surname (returns -1 on allocation failure)
+static int addHousehold(struct HouseholdIndex *index, unsigned long long phone,
+                        unsigned int surname)
+{
+    int entry = findHousehold(index, phone, surname), b, i;
+
+    if (entry != -1)
+    {
+        return entry;
+    }
+
+    if (index->count == index->capacity)
+    {
+        int capacity = index->capacity ? index->capacity * 2 : 64;
+        struct Household *grown = realloc(index->households, sizeof(*grown) * capacity);
+
+        if (grown == NULL)
+        {
+            return -1;
+        }
+        index->households = grown;
+        index->capacity = capacity;
+    }
+
+    // The table is rebuilt from the entries when it passes 3/4 full
+    if (index->index == NULL || (index->count + 1) * 4 > (index->indexMask + 1) * 3)
+    {
+        int size = index->index ? (index->indexMask + 1) * 2 : 128;
+        int *table = calloc(size, sizeof(*table));
+
+        if (table == NULL)
+        {
+            return -1;
+        }
+        free(index->index);
+        index->index = table;
+        index->indexMask = size - 1;
+        for (i = 0; i < index->count; i++)
+        {
+            for (b = bucketOf(index->households[i].phone, index->households[i].surname,
+                              index->indexMask);
+                 table[b]; b = (b + 1) & index->indexMask)
+            {
+                ; // linear probe
+            }
+            table[b] = i + 1;
+        }
+    }
+
+    entry = index->count++;
+    index->households[entry].phone = phone;
+    index->households[entry].surname = surname;
+    index->households[entry].first = -1;
+    index->households[entry].members = 0;
+    for (b = bucketOf(phone, surname, index->indexMask); index->index[b];
+         b = (b + 1) & index->indexMask)
+    {
+        ; // linear probe
+    }
+    index->index[b] = entry + 1;
+    return entry;
+}
+
+//////////////////////////////////////
+// HOUSEHOLD FUNCTIONS
+//////////////////////////////////////
+
+// Empty the index for a store of "maxSlots" patient slots (returns 0 on allocation failure)
+int householdReset(struct HouseholdIndex *index, int maxSlots)
+{
+    int i;
+
+    householdFree(index);
+    index->members = malloc(sizeof(*index->members) * (maxSlots ? maxSlots : 1));
+    if (index->members == NULL)
+    {
+        return 0;
+    }
+    for (i = 0; i < maxSlots; i++)
+    {
+        index->members[i].household = -1;
+        index->members[i].prev = -1;
+        index->members[i].next = -1;
+    }
+    index->maxSlots = maxSlots;
+    return 1;
+}
+
+// Release the index
+void householdFree(struct HouseholdIndex *index)
+{
+    free(index->households);
+    free(index->index);
+    free(index->members);
+    memset(index, 0, sizeof(*index));
+}
+
+// Group a patient slot with the others sharing its phone number and surname
+// (returns the household entry, -1 if it could not be added for lack of memory)
+int householdAdd(struct HouseholdIndex *index, int slot, int patientNumber,
+                 unsigned long long phone, unsigned int surname)
+{
+    struct HouseholdMember *member;
+    struct Household *household;
+    int entry, at, prev = -1;
+
+    if (slot < 0 || slot >= index->maxSlots)
+    {
+        return -1;
+    }
+    householdRemove(index, slot);
+    entry = addHousehold(index, phone, surname);
+    if (entry == -1)
+    {
+        return -1;
+    }
+    household = &index->households[entry];
+    member = &index->members[slot];
+    member->household = entry;
+    member->patientNumber = patientNumber;
+
+    // Members stay in patient number order: a household is a handful of
+    // patients, so the walk is short
+    for (at = household->first; at != -1 && index->members[at].patientNumber < patientNumber;
+         at = index->members[at].next)
+    {
+        prev = at;
+    }
+    member->prev = prev;
+    member->next = at;
+    if (prev != -1)
+    {
+        index->members[prev].next = slot;
+    }
+    else
+    {
+        household->first = slot;
+    }
+    if (at != -1)
+    {
+        index->members[at].prev = slot;
+    }
+    household->members++;
+    return entry;
+}
+
+// Take a patient slot out of its household
+void householdRemove(struct HouseholdIndex *index, int slot)
+{
+    struct HouseholdMember *member;
+
+    if (slot < 0 || slot >= index->maxSlots || index->members[slot].household == -1)
+    {
+        return;
+    }
+    member = &index->members[slot];
+    if (member->prev != -1)
+    {
+        index->members[member->prev].next = member->next;
+    }
+    else
+    {
+        index->households[member->household].first = member->next;
+    }
+    if (member->next != -1)
+    {
+        index->members[member->next].prev = member->prev;
+    }
+    index->households[member->household].members--;
+    member->household = -1;
+    member->prev = -1;
+    member->next = -1;
+}
+
+// Household entry of a patient slot (returns -1 if it is in none)
+int householdOf(const struct HouseholdIndex *index, int slot)
+{
+    if (slot < 0 || slot >= index->maxSlots)
+    {
+        return -1;
+    }
+    return index->members[slot].household;
+}
+
+// Copy up to "max" member slots of a household in patient number order (returns the total)
+int householdMembers(const struct HouseholdIndex *index, int household, int slots[], int max)
+{
+    int at, total = 0;
+
+    if (household < 0 || household >= index->count)
+    {
+        return 0;
+    }
+    for (at = index->households[household].first; at != -1; at = index->members[at].next)
+    {
+        if (total < max)
+        {
+            slots[total] = at;
+        }
+        total++;
+    }
+    return total;
+}
@@ -0,0 +1,67 @@
+// SAFE-GUARD:
+// It is good practice to apply safe-guards to header files
+// Safe-guard's ensures only 1 copy of the header file is used in the project build
+// The macro name should be mirroring the file name with _ for spaces, dots, etc.
+#ifndef HOUSEHOLD_H
+#define HOUSEHOLD_H
+
+//////////////////////////////////////
+// Structures
+//////////////////////////////////////
+
+// Data type: patients sharing one phone number and surname
+struct Household
+{
+    unsigned long long phone; // phone number (without the contact type)
+    unsigned int surname;     // interned surname id
+    int first;                // member slot with the lowest patient number (-1: none)
+    int members;
+};
+
+// Data type: a patient store slot's place in its household
+struct HouseholdMember
+{
+    int household; // household entry (-1: in none)
+    int patientNumber;
+    int prev; // neighbours in patient number order (-1: none)
+    int next;
+};
+
+// Data type: household grouping of the patient store, kept up to date on every
+// patient added, removed or re-keyed
+struct HouseholdIndex
+{
+    struct Household *households; // entries never move once added (empty ones are reused)
+    int count;
+    int capacity;
+    int *index;                       // open-addressing table: key -> entry + 1 (0: empty)
+    int indexMask;
+    struct HouseholdMember *members;  // one per patient store slot
+    int maxSlots;
+};
+
+//////////////////////////////////////
+// HOUSEHOLD FUNCTIONS
+//////////////////////////////////////
+
+// Empty the index for a store of "maxSlots" patient slots (returns 0 on allocation failure)
+int householdReset(struct HouseholdIndex *index, int maxSlots);
+
+// Release the index
+void householdFree(struct HouseholdIndex *index);
+
+// Group a patient slot with the others sharing its phone number and surname
+// (returns the household entry, -1 if it could not be added for lack of memory)
+int householdAdd(struct HouseholdIndex *index, int slot, int patientNumber,
+                 unsigned long long phone, unsigned int surname);
+
+// Take a patient slot out of its household
+void householdRemove(struct HouseholdIndex *index, int slot);
+
+// Household entry of a patient slot (returns -1 if it is in none)
+int householdOf(const struct HouseholdIndex *index, int slot);
+
+// Copy up to "max" member slots of a household in patient number order (returns the total)
+int householdMembers(const struct HouseholdIndex *index, int household, int slots[], int max);
+
+#endif // !HOUSEHOLD_H
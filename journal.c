@@ -0,0 +1,719 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stdint.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+// include the user library "journal" where the function prototypes are declared
+#include "journal.h"
+
+// Batch states
+#define BATCH_FILLING 0   // taking appends (empty when len is 0)
+#define BATCH_SUBMITTED 1 // handed to the backend
+#define BATCH_CLAIMED 2   // thread backend: a worker is writing it
+#define BATCH_DONE 3      // written and synced (or failed), not yet reported
+
+// io_uring user_data of the wake-up request sent on close
+#define RING_WAKE (~0ULL)
+
+//////////////////////////////////////
+// Internal structures
+//////////////////////////////////////
+
+// The shared rings of an io_uring instance (set up without liburing)
+struct JournalRing
+{
+    int fd;
+    unsigned *sqHead;
+    unsigned *sqTail;
+    unsigned *sqMask;
+    unsigned *sqArray;
+    unsigned *cqHead;
+    unsigned *cqTail;
+    unsigned *cqMask;
+    struct io_uring_sqe *sqes;
+    struct io_uring_cqe *cqes;
+    void *sqMap;
+    void *cqMap;
+    size_t sqMapSize;
+    size_t cqMapSize;
+    size_t sqeMapSize;
+};
+
+//////////////////////////////////////
+// IO_URING HELPERS
+//////////////////////////////////////
+
+// Release an io_uring instance
+static void ringFree(struct JournalRing *ring)
+{
+    if (ring->sqes != NULL && ring->sqes != MAP_FAILED)
+    {
+        munmap(ring->sqes, ring->sqeMapSize);
+    }
+    if (ring->cqMap != NULL && ring->cqMap != MAP_FAILED && ring->cqMap != ring->sqMap)
+    {
+        munmap(ring->cqMap, ring->cqMapSize);
+    }
+    if (ring->sqMap != NULL && ring->sqMap != MAP_FAILED)
+    {
+        munmap(ring->sqMap, ring->sqMapSize);
+    }
+    if (ring->fd != -1)
+    {
+        close(ring->fd);
+    }
+    free(ring);
+}
+
+// Set up an io_uring instance with room for "entries" requests (returns NULL if
+// the kernel does not allow it)
+static struct JournalRing *ringSetup(unsigned entries)
+{
+    struct JournalRing *ring = calloc(1, sizeof(*ring));
+    struct io_uring_params params;
+    char *sq, *cq;
+
+    if (ring == NULL)
+    {
+        return NULL;
+    }
+    memset(&params, 0, sizeof(params));
+    ring->fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+    if (ring->fd == -1)
+    {
+        free(ring);
+        return NULL;
+    }
+
+    ring->sqMapSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cqMapSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        if (ring->cqMapSize > ring->sqMapSize)
+        {
+            ring->sqMapSize = ring->cqMapSize;
+        }
+        ring->cqMapSize = ring->sqMapSize;
+    }
+    ring->sqMap = mmap(NULL, ring->sqMapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                       ring->fd, IORING_OFF_SQ_RING);
+    ring->cqMap = params.features & IORING_FEAT_SINGLE_MMAP
+                      ? ring->sqMap
+                      : mmap(NULL, ring->cqMapSize, PROT_READ | PROT_WRITE,
+                             MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+    ring->sqeMapSize = params.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sqes = mmap(NULL, ring->sqeMapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      ring->fd, IORING_OFF_SQES);
+    if (ring->sqMap == MAP_FAILED || ring->cqMap == MAP_FAILED || ring->sqes == MAP_FAILED)
+    {
+        ringFree(ring);
+        return NULL;
+    }
+
+    sq = ring->sqMap;
+    cq = ring->cqMap;
+    ring->sqHead = (unsigned *)(sq + params.sq_off.head);
+    ring->sqTail = (unsigned *)(sq + params.sq_off.tail);
+    ring->sqMask = (unsigned *)(sq + params.sq_off.ring_mask);
+    ring->sqArray = (unsigned *)(sq + params.sq_off.array);
+    ring->cqHead = (unsigned *)(cq + params.cq_off.head);
+    ring->cqTail = (unsigned *)(cq + params.cq_off.tail);
+    ring->cqMask = (unsigned *)(cq + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe *)(cq + params.cq_off.cqes);
+    return ring;
+}
+
+// Next free submission entry, cleared (the caller holds the journal lock)
+static struct io_uring_sqe *ringEntry(struct JournalRing *ring)
+{
+    unsigned tail = *ring->sqTail, index = tail & *ring->sqMask;
+    struct io_uring_sqe *sqe = &ring->sqes[index];
+
+    memset(sqe, 0, sizeof(*sqe));
+    ring->sqArray[index] = index;
+    __atomic_store_n(ring->sqTail, tail + 1, __ATOMIC_RELEASE);
+    return sqe;
+}
+
+// Hand "count" queued entries to the kernel without waiting for them
+static void ringSubmit(struct JournalRing *ring, unsigned count)
+{
+    while (syscall(__NR_io_uring_enter, ring->fd, count, 0, 0, NULL, 0) == -1 &&
+           (errno == EINTR || errno == EAGAIN || errno == EBUSY))
+    {
+        ; // retry until the kernel takes them
+    }
+}
+
+//////////////////////////////////////
+// BATCH HELPERS
+//////////////////////////////////////
+
+// Batch taking appends (NULL while every batch is in flight)
+static struct JournalBatch *fillingBatch(struct Journal *journal)
+{
+    if (journal->inFlight == JOURNAL_BATCHES)
+    {
+        return NULL;
+    }
+    return &journal->batches[(journal->oldest + journal->inFlight) % JOURNAL_BATCHES];
+}
+
+// Send the filling batch to the backend (journal lock held)
+static void submitBatch(struct Journal *journal, struct JournalBatch *batch)
+{
+    struct io_uring_sqe *sqe;
+    int index = (int)(batch - journal->batches);
+
+    batch->offset = journal->offset;
+    batch->state = BATCH_SUBMITTED;
+    batch->error = 0;
+    journal->offset += batch->len;
+    journal->inFlight++;
+    journal->batchesWritten++;
+
+    if (journal->backend == JOURNAL_BACKEND_URING)
+    {
+        // The write waits for every earlier request (batches land in file order, so
+        // a reader tailing the file never sees a hole) and the sync is linked to it
+        batch->pending = 2;
+        sqe = ringEntry(journal->ring);
+        sqe->opcode = IORING_OP_WRITE;
+        sqe->fd = journal->fd;
+        sqe->addr = (unsigned long long)(uintptr_t)batch->data;
+        sqe->len = (unsigned)batch->len;
+        sqe->off = (unsigned long long)batch->offset;
+        sqe->flags = IOSQE_IO_DRAIN | IOSQE_IO_LINK;
+        sqe->user_data = (unsigned long long)index * 2;
+        sqe = ringEntry(journal->ring);
+        sqe->opcode = IORING_OP_FSYNC;
+        sqe->fd = journal->fd;
+        sqe->fsync_flags = IORING_FSYNC_DATASYNC;
+        sqe->user_data = (unsigned long long)index * 2 + 1;
+        ringSubmit(journal->ring, 2);
+    }
+    else
+    {
+        pthread_cond_broadcast(&journal->changed);
+    }
+}
+
+// Record a finished batch, report every batch now finished in order and send the
+// batch that filled up meanwhile (journal lock held)
+static void finishBatch(struct Journal *journal, struct JournalBatch *batch, int error)
+{
+    struct JournalBatch *oldest, *filling;
+
+    batch->state = BATCH_DONE;
+    batch->error = error;
+
+    // Batches may complete out of order; a ticket is durable once every batch
+    // before it is too
+    while (journal->inFlight > 0 &&
+           (oldest = &journal->batches[journal->oldest])->state == BATCH_DONE)
+    {
+        if (oldest->error != 0 && journal->error == 0)
+        {
+            journal->error = oldest->error;
+        }
+        if (journal->error == 0)
+        {
+            journal->durable = oldest->lastTicket;
+        }
+        if (journal->done != NULL)
+        {
+            journal->done(journal->context, oldest->lastTicket, journal->error);
+        }
+        oldest->state = BATCH_FILLING;
+        oldest->len = 0;
+        journal->oldest = (journal->oldest + 1) % JOURNAL_BATCHES;
+        journal->inFlight--;
+    }
+
+    filling = fillingBatch(journal);
+    if (filling != NULL && filling->len > 0 && journal->error == 0)
+    {
+        submitBatch(journal, filling);
+    }
+    pthread_cond_broadcast(&journal->changed);
+}
+
+//////////////////////////////////////
+// BACKEND THREADS
+//////////////////////////////////////
+
+// io_uring backend: wait for completions and finish the batches they belong to
+static void *ringReaper(void *arg)
+{
+    struct Journal *journal = arg;
+    struct JournalRing *ring = journal->ring;
+    struct io_uring_cqe *cqe;
+    struct JournalBatch *batch;
+    unsigned head, tail;
+    int stop = 0, error;
+
+    while (!stop)
+    {
+        syscall(__NR_io_uring_enter, ring->fd, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0);
+
+        pthread_mutex_lock(&journal->lock);
+        head = *ring->cqHead;
+        tail = __atomic_load_n(ring->cqTail, __ATOMIC_ACQUIRE);
+        for (; head != tail; head++)
+        {
+            cqe = &ring->cqes[head & *ring->cqMask];
+            if (cqe->user_data == RING_WAKE)
+            {
+                stop = 1;
+                continue;
+            }
+            batch = &journal->batches[cqe->user_data / 2];
+
+            // A short write counts as a failure (the linked sync is then cancelled)
+            error = cqe->res < 0 ? -cqe->res : 0;
+            if (cqe->user_data % 2 == 0 && cqe->res >= 0 && (size_t)cqe->res != batch->len)
+            {
+                error = EIO;
+            }
+            if (error != 0 && batch->error == 0)
+            {
+                batch->error = error;
+            }
+            if (--batch->pending == 0)
+            {
+                finishBatch(journal, batch, batch->error);
+            }
+        }
+        __atomic_store_n(ring->cqHead, head, __ATOMIC_RELEASE);
+        pthread_mutex_unlock(&journal->lock);
+    }
+    return NULL;
+}
+
+// Thread backend: write submitted batches one at a time in file order; the sync of
+// one batch overlaps the write of the next
+static void *journalWorker(void *arg)
+{
+    struct Journal *journal = arg;
+    struct JournalBatch *batch;
+    size_t written;
+    ssize_t n;
+    int i, error;
+
+    pthread_mutex_lock(&journal->lock);
+    for (;;)
+    {
+        batch = NULL;
+        for (i = 0; i < journal->inFlight && batch == NULL && !journal->writing; i++)
+        {
+            batch = &journal->batches[(journal->oldest + i) % JOURNAL_BATCHES];
+            batch = batch->state == BATCH_SUBMITTED ? batch : NULL;
+        }
+        if (batch == NULL)
+        {
+            if (journal->stopping)
+            {
+                break;
+            }
+            pthread_cond_wait(&journal->changed, &journal->lock);
+            continue;
+        }
+        batch->state = BATCH_CLAIMED;
+        journal->writing = 1;
+        pthread_mutex_unlock(&journal->lock);
+
+        error = 0;
+        for (written = 0; written < batch->len && error == 0; written += n)
+        {
+            n = pwrite(journal->fd, batch->data + written, batch->len - written,
+                       batch->offset + (off_t)written);
+            if (n <= 0)
+            {
+                error = n == 0 ? EIO : errno;
+                n = 0;
+                if (error == EINTR)
+                {
+                    error = 0;
+                }
+            }
+        }
+        pthread_mutex_lock(&journal->lock);
+        journal->writing = 0;
+        pthread_cond_broadcast(&journal->changed);
+        pthread_mutex_unlock(&journal->lock);
+        if (error == 0 && fdatasync(journal->fd) == -1)
+        {
+            error = errno;
+        }
+
+        pthread_mutex_lock(&journal->lock);
+        finishBatch(journal, batch, error);
+    }
+    pthread_mutex_unlock(&journal->lock);
+    return NULL;
+}
+
+//////////////////////////////////////
+// JOURNAL FUNCTIONS
+//////////////////////////////////////
+
+// Start journaling to "fd" from byte "offset" (the fd must not be O_APPEND: batches
+// may be written out of order); "done" may be NULL (returns 0 on failure)
+int journalOpen(struct Journal *journal, int fd, off_t offset, int backend,
+                JournalCallback done, void *context)
+{
+    int i;
+
+    memset(journal, 0, sizeof(*journal));
+    journal->fd = fd;
+    journal->offset = offset;
+    journal->done = done;
+    journal->context = context;
+    for (i = 0; i < JOURNAL_BATCHES; i++)
+    {
+        journal->batches[i].data = malloc(JOURNAL_BATCH_BYTES);
+        if (journal->batches[i].data == NULL)
+        {
+            journalClose(journal);
+            return 0;
+        }
+    }
+    pthread_mutex_init(&journal->lock, NULL);
+    pthread_cond_init(&journal->changed, NULL);
+
+    // Two entries per batch (write + sync) and one for the wake-up on close
+    if (backend != JOURNAL_BACKEND_THREADS)
+    {
+        journal->ring = ringSetup(JOURNAL_BATCHES * 2 + 1);
+        if (journal->ring != NULL &&
+            pthread_create(&journal->threads[0], NULL, ringReaper, journal) == 0)
+        {
+            journal->backend = JOURNAL_BACKEND_URING;
+            journal->threadCount = 1;
+            return 1;
+        }
+        if (journal->ring != NULL)
+        {
+            ringFree(journal->ring);
+            journal->ring = NULL;
+        }
+        if (backend == JOURNAL_BACKEND_URING)
+        {
+            journalClose(journal);
+            return 0;
+        }
+    }
+
+    journal->backend = JOURNAL_BACKEND_THREADS;
+    for (i = 0; i < JOURNAL_THREADS; i++)
+    {
+        if (pthread_create(&journal->threads[i], NULL, journalWorker, journal) == 0)
+        {
+            journal->threadCount++;
+        }
+    }
+    if (journal->threadCount == 0)
+    {
+        journalClose(journal);
+        return 0;
+    }
+    return 1;
+}
+
+// Queue bytes for writing without waiting for the disk (returns the append's ticket,
+// 0 if it is larger than a batch or the journal failed)
+unsigned long long journalAppend(struct Journal *journal, const void *data, size_t size)
+{
+    struct JournalBatch *batch;
+    unsigned long long ticket = 0;
+
+    if (size > JOURNAL_BATCH_BYTES)
+    {
+        return 0;
+    }
+    pthread_mutex_lock(&journal->lock);
+    while (journal->error == 0 &&
+           ((batch = fillingBatch(journal)) == NULL || batch->len + size > JOURNAL_BATCH_BYTES))
+    {
+        // A full batch goes out now; with every batch in flight the caller waits
+        if (batch != NULL)
+        {
+            submitBatch(journal, batch);
+        }
+        else
+        {
+            pthread_cond_wait(&journal->changed, &journal->lock);
+        }
+    }
+    if (journal->error == 0)
+    {
+        memcpy(batch->data + batch->len, data, size);
+        batch->len += size;
+        ticket = ++journal->appended;
+        batch->lastTicket = ticket;
+
+        // One batch is kept back for appends arriving while the others are in
+        // flight: they are then written and synced together
+        if (journal->inFlight < JOURNAL_BATCHES - 1)
+        {
+            submitBatch(journal, batch);
+        }
+    }
+    pthread_mutex_unlock(&journal->lock);
+    return ticket;
+}
+
+// Wait until every append up to "ticket" is durable (returns 0 if the journal failed)
+int journalWait(struct Journal *journal, unsigned long long ticket)
+{
+    int ok;
+
+    pthread_mutex_lock(&journal->lock);
+    while (journal->durable < ticket && journal->error == 0)
+    {
+        pthread_cond_wait(&journal->changed, &journal->lock);
+    }
+    ok = journal->error == 0;
+    pthread_mutex_unlock(&journal->lock);
+    return ok;
+}
+
+// Last ticket known to be durable
+unsigned long long journalDurable(struct Journal *journal)
+{
+    unsigned long long durable;
+
+    pthread_mutex_lock(&journal->lock);
+    durable = journal->durable;
+    pthread_mutex_unlock(&journal->lock);
+    return durable;
+}
+
+// Name of the backend in use
+const char *journalBackendName(const struct Journal *journal)
+{
+    return journal->backend == JOURNAL_BACKEND_URING ? "io_uring" : "threads";
+}
+
+// Wait for every append, then stop the journal's threads (the fd stays open)
+// (returns 0 if the journal failed)
+int journalClose(struct Journal *journal)
+{
+    int i, ok = 1;
+
+    if (journal->threadCount > 0)
+    {
+        ok = journalWait(journal, journal->appended);
+        pthread_mutex_lock(&journal->lock);
+        journal->stopping = 1;
+
+        // Wait out a failed journal's batches still in flight before stopping
+        while (journal->inFlight > 0 && journal->batches[journal->oldest].state != BATCH_DONE)
+        {
+            pthread_cond_wait(&journal->changed, &journal->lock);
+        }
+        if (journal->ring != NULL)
+        {
+            struct io_uring_sqe *sqe = ringEntry(journal->ring);
+
+            sqe->opcode = IORING_OP_NOP;
+            sqe->user_data = RING_WAKE;
+            ringSubmit(journal->ring, 1);
+        }
+        pthread_cond_broadcast(&journal->changed);
+        pthread_mutex_unlock(&journal->lock);
+        for (i = 0; i < journal->threadCount; i++)
+        {
+            pthread_join(journal->threads[i], NULL);
+        }
+        pthread_mutex_destroy(&journal->lock);
+        pthread_cond_destroy(&journal->changed);
+    }
+    if (journal->ring != NULL)
+    {
+        ringFree(journal->ring);
+    }
+    for (i = 0; i < JOURNAL_BATCHES; i++)
+    {
+        free(journal->batches[i].data);
+    }
+    journal->threadCount = 0;
+    journal->ring = NULL;
+    memset(journal->batches, 0, sizeof(journal->batches));
+    return ok;
+}
+
+//////////////////////////////////////
+// BENCHMARK FUNCTIONS
+//////////////////////////////////////
+
+// Timestamps of one benchmark run
+struct JournalTiming
+{
+    long long *appendedAt; // per ticket: when the append was made
+    long long *durableAt;  // per ticket: when its batch was reported durable
+    unsigned long long reported;
+};
+
+// Monotonic clock in nanoseconds
+static long long nowNanos(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// Order of two latencies
+static int compareNanos(const void *a, const void *b)
+{
+    const long long *x = a, *y = b;
+
+    return (*x > *y) - (*x < *y);
+}
+
+// Completion callback of a benchmark run: stamp every ticket the batch covered
+static void stampDurable(void *context, unsigned long long ticket, int error)
+{
+    struct JournalTiming *timing = context;
+    long long now = nowNanos();
+
+    for (; timing->reported < ticket && error == 0; timing->reported++)
+    {
+        timing->durableAt[timing->reported] = now;
+    }
+}
+
+// Print one row of percentiles (sorts the latencies)
+static void printLatencies(const char *name, long long commit[], long long durable[], int n,
+                           long long elapsed, unsigned long long batches)
+{
+    qsort(commit, n, sizeof(*commit), compareNanos);
+    qsort(durable, n, sizeof(*durable), compareNanos);
+    printf("%-9s %11.1f %11.1f %11.1f %11.1f %9.0f %8llu\n", name,
+           commit[n / 2] / 1e3, commit[n - 1 - n / 100] / 1e3,
+           durable[n / 2] / 1e3, durable[n - 1 - n / 100] / 1e3,
+           n / (elapsed / 1e9), batches);
+}
+
+// Compare commit latency of a blocking write + fdatasync per change against each
+// asynchronous backend, journaling "changes" records to "file" (returns 0 on success)
+int benchmarkJournal(const char *file, int changes)
+{
+    static const int backends[] = {JOURNAL_BACKEND_URING, JOURNAL_BACKEND_THREADS};
+    struct JournalTiming timing;
+    struct Journal journal;
+    char record[24]; // about one booking change
+    long long *commit, *durable, started, elapsed;
+    int fd, i, b, failed = 0;
+
+    if (changes < 1)
+    {
+        printf("ERROR: The number of changes must be > 0\n");
+        return 1;
+    }
+    commit = malloc(sizeof(*commit) * changes);
+    durable = malloc(sizeof(*durable) * changes);
+    timing.appendedAt = malloc(sizeof(*timing.appendedAt) * changes);
+    timing.durableAt = malloc(sizeof(*timing.durableAt) * changes);
+    fd = open(file, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (commit == NULL || durable == NULL || timing.appendedAt == NULL ||
+        timing.durableAt == NULL || fd == -1)
+    {
+        printf("ERROR: Unable to set up the benchmark on %s\n", file);
+        free(commit);
+        free(durable);
+        free(timing.appendedAt);
+        free(timing.durableAt);
+        if (fd != -1)
+        {
+            close(fd);
+        }
+        return 1;
+    }
+    memset(record, 'x', sizeof(record));
+
+    printf("Journal commit latency, %d changes of %d bytes to %s (microseconds)\n", changes,
+           (int)sizeof(record), file);
+    printf("%-9s %11s %11s %11s %11s %9s %8s\n", "Backend", "Commit p50", "Commit p99",
+           "Durable p50", "Durable p99", "Changes/s", "Syncs");
+
+    // Blocking: the caller waits for its own write and sync
+    started = nowNanos();
+    for (i = 0; i < changes && !failed; i++)
+    {
+        long long at = nowNanos();
+
+        failed = pwrite(fd, record, sizeof(record), (off_t)i * sizeof(record)) !=
+                     (ssize_t)sizeof(record) ||
+                 fdatasync(fd) == -1;
+        commit[i] = nowNanos() - at;
+        durable[i] = commit[i];
+    }
+    elapsed = nowNanos() - started;
+    if (!failed)
+    {
+        printLatencies("sync", commit, durable, changes, elapsed, (unsigned long long)changes);
+    }
+
+    // Asynchronous: the caller only queues; durability is reported by callback
+    for (b = 0; b < 2 && !failed; b++)
+    {
+        if (ftruncate(fd, 0) == -1)
+        {
+            failed = 1;
+            break;
+        }
+        timing.reported = 0;
+        if (!journalOpen(&journal, fd, 0, backends[b], stampDurable, &timing) ||
+            journal.backend != backends[b])
+        {
+            printf("%-9s unavailable\n", backends[b] == JOURNAL_BACKEND_URING ? "io_uring"
+                                                                               : "threads");
+            if (journal.threadCount > 0)
+            {
+                journalClose(&journal);
+            }
+            continue;
+        }
+        started = nowNanos();
+        for (i = 0; i < changes; i++)
+        {
+            timing.appendedAt[i] = nowNanos();
+            journalAppend(&journal, record, sizeof(record));
+            commit[i] = nowNanos() - timing.appendedAt[i];
+        }
+        failed = !journalWait(&journal, journal.appended);
+        elapsed = nowNanos() - started;
+        for (i = 0; i < changes && !failed; i++)
+        {
+            durable[i] = timing.durableAt[i] - timing.appendedAt[i];
+        }
+        if (!failed)
+        {
+            printLatencies(journalBackendName(&journal), commit, durable, changes, elapsed,
+                           journal.batchesWritten);
+        }
+        journalClose(&journal);
+    }
+    if (failed)
+    {
+        printf("ERROR: Writing %s failed (%s)\n", file, strerror(errno));
+    }
+
+    close(fd);
+    unlink(file);
+    free(commit);
+    free(durable);
+    free(timing.appendedAt);
+    free(timing.durableAt);
+    return failed;
+}
@@ -0,0 +1,112 @@
+// SAFE-GUARD:
+// It is good practice to apply safe-guards to header files
+// Safe-guard's ensures only 1 copy of the header file is used in the project build
+// The macro name should be mirroring the file name with _ for spaces, dots, etc.
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <pthread.h>
+#include <sys/types.h>
+
+//////////////////////////////////////
+// Module macro's (usable by any file that includes this header)
+//////////////////////////////////////
+
+// I/O backends
+#define JOURNAL_BACKEND_AUTO 0    // io_uring when the kernel allows it, else threads
+#define JOURNAL_BACKEND_URING 1   // write + fdatasync linked in one io_uring submission
+#define JOURNAL_BACKEND_THREADS 2 // worker threads calling pwrite + fdatasync
+// Either way batches are written in file order, so a reader tailing the file
+// never finds a hole before the end
+
+// Appends are grouped into batches of up to this many bytes, one write + fdatasync each
+#define JOURNAL_BATCH_BYTES (64 * 1024)
+
+// Batches in flight or being filled (appends wait when every one is in flight)
+#define JOURNAL_BATCHES 4
+
+// Worker threads of the thread backend
+#define JOURNAL_THREADS 2
+
+// Default benchmark size (changes committed per backend)
+#define JOURNAL_BENCH_CHANGES 2000
+
+//////////////////////////////////////
+// Structures
+//////////////////////////////////////
+
+// Completion callback: every append up to "ticket" is durable (error 0) or the
+// journal failed (error is the errno); runs on a journal thread, so it must be quick
+typedef void (*JournalCallback)(void *context, unsigned long long ticket, int error);
+
+// Data type: one group of appends written and synced together
+struct JournalBatch
+{
+    char *data;
+    size_t len;
+    off_t offset;
+    unsigned long long lastTicket; // last append in the batch
+    int state;                     // filling, submitted, claimed by a worker or done
+    int pending;                   // io_uring: completions still expected
+    int error;
+};
+
+// Data type: an append-only file written in the background
+struct Journal
+{
+    int fd;
+    int backend;
+    off_t offset; // where the next submitted batch goes
+    struct JournalBatch batches[JOURNAL_BATCHES];
+    int oldest;   // oldest submitted batch (ring order)
+    int inFlight; // batches submitted and not yet completed
+    unsigned long long appended; // last ticket handed out
+    unsigned long long durable;  // last ticket on disk
+    unsigned long long batchesWritten;
+    int error;
+    int stopping;
+    int writing; // thread backend: a worker is in pwrite (one at a time)
+    JournalCallback done;
+    void *context;
+    pthread_mutex_t lock;
+    pthread_cond_t changed; // a batch completed or was queued
+    pthread_t threads[JOURNAL_THREADS];
+    int threadCount;
+    struct JournalRing *ring; // JOURNAL_BACKEND_URING state
+};
+
+//////////////////////////////////////
+// JOURNAL FUNCTIONS
+//////////////////////////////////////
+
+// Start journaling to "fd" from byte "offset" (the fd must not be O_APPEND: batches
+// may be written out of order); "done" may be NULL (returns 0 on failure)
+int journalOpen(struct Journal *journal, int fd, off_t offset, int backend,
+                JournalCallback done, void *context);
+
+// Queue bytes for writing without waiting for the disk (returns the append's ticket,
+// 0 if it is larger than a batch or the journal failed)
+unsigned long long journalAppend(struct Journal *journal, const void *data, size_t size);
+
+// Wait until every append up to "ticket" is durable (returns 0 if the journal failed)
+int journalWait(struct Journal *journal, unsigned long long ticket);
+
+// Last ticket known to be durable
+unsigned long long journalDurable(struct Journal *journal);
+
+// Name of the backend in use
+const char *journalBackendName(const struct Journal *journal);
+
+// Wait for every append, then stop the journal's threads (the fd stays open)
+// (returns 0 if the journal failed)
+int journalClose(struct Journal *journal);
+
+//////////////////////////////////////
+// BENCHMARK FUNCTIONS
+//////////////////////////////////////
+
+// Compare commit latency of a blocking write + fdatasync per change against each
+// asynchronous backend, journaling "changes" records to "file" (returns 0 on success)
+int benchmarkJournal(const char *file, int changes);
+
+#endif // !JOURNAL_H
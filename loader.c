@@ -0,0 +1,552 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <limits.h>
+#include <time.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// include the user library "clinic" where the record types are declared
+#include "clinic.h"
+// include the user library "metrics" for the operation timers
+#include "metrics.h"
+// include the user library "loader" where the function prototypes are declared
+#include "loader.h"
+
+//////////////////////////////////////
+// Internal structures
+//////////////////////////////////////
+
+// A read-only mapping of a whole data file
+struct MappedFile
+{
+    const char *data;
+    size_t size;
+};
+
+// One newline-aligned slice of the file and where its records land
+struct Chunk
+{
+    const char *begin;
+    const char *end;
+    int offset; // index of the chunk's first record in the destination array
+    int count;  // non-empty lines in the chunk
+    void *dest;
+    int max;
+    void (*parse)(const char *line, const char *eol, void *dest, int index);
+};
+
+//////////////////////////////////////
+// FILE MAPPING
+//////////////////////////////////////
+
+// Map the whole file read-only (returns 1 on success, empty files map to size 0)
+static int mapFile(const char *path, struct MappedFile *file)
+{
+    struct stat st;
+    void *addr;
+    int fd;
+
+    file->data = NULL;
+    file->size = 0;
+    fd = open(path, O_RDONLY);
+    if (fd == -1)
+    {
+        return 0;
+    }
+    if (fstat(fd, &st) == -1)
+    {
+        close(fd);
+        return 0;
+    }
+    if (st.st_size > 0)
+    {
+        addr = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED)
+        {
+            close(fd);
+            return 0;
+        }
+        madvise(addr, st.st_size, MADV_SEQUENTIAL);
+        file->data = addr;
+        file->size = st.st_size;
+    }
+    close(fd);
+    return 1;
+}
+
+// Release a mapping made by mapFile
+static void unmapFile(struct MappedFile *file)
+{
+    if (file->data != NULL)
+    {
+        munmap((void *)file->data, file->size);
+    }
+}
+
+//////////////////////////////////////
+// PARSING
+//////////////////////////////////////
+
+// End of the line: its '\n' or the limit
+static const char *lineEnd(const char *line, const char *limit)
+{
+    const char *eol = memchr(line, '\n', limit - line);
+
+    if (eol == NULL)
+    {
+        eol = limit;
+    }
+    return eol;
+}
+
+// Parse a decimal integer and step past one delimiter, the way sscanf's %d reads it
+// (leading white space and a sign are taken, and an out of range value saturates
+// to a long before it is converted to int, as strtol does for scanf)
+static int parseInt(const char **cursor, const char *eol)
+{
+    const char *p = *cursor;
+    unsigned long magnitude = 0, limit;
+    int negative = 0, digit;
+
+    while (p < eol && isspace((unsigned char)*p))
+    {
+        p++;
+    }
+    if (p < eol && (*p == '-' || *p == '+'))
+    {
+        negative = *p == '-';
+        p++;
+    }
+    limit = negative ? (unsigned long)LONG_MAX + 1 : (unsigned long)LONG_MAX;
+    while (p < eol && *p >= '0' && *p <= '9')
+    {
+        digit = *p - '0';
+        magnitude = magnitude > (limit - digit) / 10 ? limit : magnitude * 10 + digit;
+        p++;
+    }
+    *cursor = p < eol ? p + 1 : p;
+    return (int)(long)(negative ? 0 - magnitude : magnitude);
+}
+
+// Copy a delimited field, truncated to "len" characters, and step past the delimiter
+static void parseField(const char **cursor, const char *eol, char *out, int len, char delim)
+{
+    const char *p = *cursor;
+    int n = 0;
+
+    while (p < eol && *p != delim && *p != '\r')
+    {
+        if (n < len)
+        {
+            out[n++] = *p;
+        }
+        p++;
+    }
+    out[n] = '\0';
+    *cursor = p < eol ? p + 1 : p;
+}
+
+// Parse "number|name|description|phone"
+static void parsePatientLine(const char *line, const char *eol, void *dest, int index)
+{
+    struct Patient *patient = (struct Patient *)dest + index;
+    char name[NAME_LEN + 1];
+    struct Phone phone;
+
+    patient->patientNumber = parseInt(&line, eol);
+    parseField(&line, eol, name, NAME_LEN, '|');
+    parseField(&line, eol, phone.description, PHONE_DESC_LEN, '|');
+    parseField(&line, eol, phone.number, PHONE_LEN, '|');
+    setPatientName(patient, name);
+    setPatientPhone(patient, &phone);
+}
+
+// Has the line another field before its end
+static int hasField(const char *line, const char *eol)
+{
+    return line < eol && *line != '\r';
+}
+
+// Parse "patient,year,month,day,hour,min[,resource,minutes]"
+static void parseAppointmentLine(const char *line, const char *eol, void *dest, int index)
+{
+    struct Appointment *appoint = (struct Appointment *)dest + index;
+
+    appoint->patientNumber = parseInt(&line, eol);
+    appoint->date.year = parseInt(&line, eol);
+    appoint->date.month = parseInt(&line, eol);
+    appoint->date.day = parseInt(&line, eol);
+    appoint->time.hour = parseInt(&line, eol);
+    appoint->time.min = parseInt(&line, eol);
+    appoint->resource = hasField(line, eol) ? parseInt(&line, eol) : 0;
+    appoint->duration = hasField(line, eol) ? parseInt(&line, eol) : MINUTE_INTERVAL;
+}
+
+// A line holds a record unless it is empty (or just "\r")
+static int isRecordLine(const char *line, const char *eol)
+{
+    return eol > line && !(eol - line == 1 && *line == '\r');
+}
+
+//////////////////////////////////////
+// CHUNK WORKERS
+//////////////////////////////////////
+
+// Phase 1: count the records in a chunk
+static void *countChunk(void *arg)
+{
+    struct Chunk *chunk = arg;
+    const char *p = chunk->begin, *eol;
+
+    chunk->count = 0;
+    while (p < chunk->end)
+    {
+        eol = lineEnd(p, chunk->end);
+        if (isRecordLine(p, eol))
+        {
+            chunk->count++;
+        }
+        p = eol + 1;
+    }
+    return NULL;
+}
+
+// Phase 2: parse a chunk straight into its slice of the destination
+static void *parseChunk(void *arg)
+{
+    struct Chunk *chunk = arg;
+    const char *p = chunk->begin, *eol;
+    int index = chunk->offset;
+
+    while (p < chunk->end && index < chunk->max)
+    {
+        eol = lineEnd(p, chunk->end);
+        if (isRecordLine(p, eol))
+        {
+            chunk->parse(p, eol, chunk->dest, index++);
+        }
+        p = eol + 1;
+    }
+    return NULL;
+}
+
+// Run the worker over every chunk, one thread each (the first runs on the caller)
+static void runChunks(struct Chunk chunks[], int n, void *(*worker)(void *))
+{
+    pthread_t threads[LOADER_MAX_THREADS];
+    int started[LOADER_MAX_THREADS] = {0};
+    int i;
+
+    for (i = 1; i < n; i++)
+    {
+        started[i] = pthread_create(&threads[i], NULL, worker, &chunks[i]) == 0;
+        if (!started[i])
+        {
+            worker(&chunks[i]);
+        }
+    }
+    worker(&chunks[0]);
+    for (i = 1; i < n; i++)
+    {
+        if (started[i])
+        {
+            pthread_join(threads[i], NULL);
+        }
+    }
+}
+
+// Split, count, place and parse a data file (returns # of records stored)
+static int importParallel(const char *datafile, void *dest, int max, int threads,
+                          void (*parse)(const char *, const char *, void *, int))
+{
+    struct MappedFile file;
+    struct Chunk chunks[LOADER_MAX_THREADS];
+    size_t i, cut;
+    int n, c, total = 0;
+
+    if (!mapFile(datafile, &file))
+    {
+        putchar('\n');
+        printf("Error: Fail to open the file\n");
+        return 0;
+    }
+
+    if (threads <= 0)
+    {
+        threads = loaderDefaultThreads();
+    }
+    if (threads > LOADER_MAX_THREADS)
+    {
+        threads = LOADER_MAX_THREADS;
+    }
+    if ((size_t)threads > file.size / LOADER_MIN_CHUNK)
+    {
+        threads = (int)(file.size / LOADER_MIN_CHUNK);
+    }
+    if (threads < 1)
+    {
+        threads = 1;
+    }
+
+    // Cut at roughly equal byte offsets, then slide each cut past the next newline
+    n = 0;
+    cut = 0;
+    for (c = 0; c < threads && cut < file.size; c++)
+    {
+        size_t stop = c == threads - 1 ? file.size : file.size / threads * (c + 1);
+
+        if (stop < cut)
+        {
+            stop = cut;
+        }
+        for (i = stop; i > 0 && i < file.size && file.data[i - 1] != '\n'; i++)
+        {
+            ; // advance to the start of the next line
+        }
+        chunks[n].begin = file.data + cut;
+        chunks[n].end = file.data + (i < file.size ? i : file.size);
+        chunks[n].dest = dest;
+        chunks[n].max = max;
+        chunks[n].parse = parse;
+        cut = chunks[n].end - file.data;
+        n++;
+    }
+
+    if (n > 0)
+    {
+        runChunks(chunks, n, countChunk);
+
+        // Prefix sums give every chunk a private destination range: no locking needed
+        for (c = 0; c < n; c++)
+        {
+            chunks[c].offset = total;
+            total += chunks[c].count;
+        }
+        runChunks(chunks, n, parseChunk);
+    }
+
+    unmapFile(&file);
+    return total < max ? total : max;
+}
+
+//////////////////////////////////////
+// FILE FUNCTIONS
+//////////////////////////////////////
+
+// Number of threads to use when the caller passes 0 (online CPUs)
+int loaderDefaultThreads(void)
+{
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+    if (cpus < 1)
+    {
+        return 1;
+    }
+    return cpus > LOADER_MAX_THREADS ? LOADER_MAX_THREADS : (int)cpus;
+}
+
+// Count the non-empty lines of a data file (returns -1 if it cannot be opened)
+int countDataRecords(const char *datafile)
+{
+    struct MappedFile file;
+    struct Chunk chunk;
+
+    if (!mapFile(datafile, &file))
+    {
+        return -1;
+    }
+    chunk.begin = file.data;
+    chunk.end = file.data + file.size;
+    countChunk(&chunk);
+    unmapFile(&file);
+    return chunk.count;
+}
+
+// Parallel importPatients: the first "max" records in file order (returns # of records read)
+int importPatientsParallel(const char *datafile, struct Patient patients[], int max,
+                           int threads)
+{
+    int count;
+    METRIC_START(started);
+
+    count = importParallel(datafile, patients, max, threads, parsePatientLine);
+    METRIC_STOP(METRIC_IMPORT_PATIENTS, started);
+    return count;
+}
+
+// Parallel importAppointments: the first "max" records in file order (returns # of records read)
+int importAppointmentsParallel(const char *datafile, struct Appointment appoints[], int max,
+                               int threads)
+{
+    int count;
+    METRIC_START(started);
+
+    count = importParallel(datafile, appoints, max, threads, parseAppointmentLine);
+    METRIC_STOP(METRIC_IMPORT_APPOINTMENTS, started);
+    return count;
+}
+
+//////////////////////////////////////
+// BENCHMARK FUNCTIONS
+//////////////////////////////////////
+
+// Monotonic clock in seconds
+static double nowSeconds(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Index of the first of "count" records that differ between two arrays (-1 if none)
+static int firstDifference(const void *a, const void *b, size_t size, int count)
+{
+    int i;
+
+    for (i = 0; i < count; i++)
+    {
+        if (memcmp((const char *)a + i * size, (const char *)b + i * size, size) != 0)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Describe the first record a parallel import got differently from the sequential one
+static void describeDifference(char *note, size_t len, const struct Patient *reference,
+                               const struct Patient *patients, int patientCount,
+                               const struct Appointment *refAppoints,
+                               const struct Appointment *appoints, int appointCount)
+{
+    const struct Appointment *x, *y;
+    int at = firstDifference(patients, reference, sizeof(*patients), patientCount);
+
+    if (at != -1)
+    {
+        snprintf(note, len, "patient record %d: #%d %s vs #%d %s", at + 1,
+                 reference[at].patientNumber, patientName(&reference[at]),
+                 patients[at].patientNumber, patientName(&patients[at]));
+        return;
+    }
+    at = firstDifference(appoints, refAppoints, sizeof(*appoints), appointCount);
+    if (at != -1)
+    {
+        x = &refAppoints[at];
+        y = &appoints[at];
+        snprintf(note, len,
+                 "appointment record %d: %d,%d,%d,%d,%d,%d,%d,%d vs %d,%d,%d,%d,%d,%d,%d,%d",
+                 at + 1, x->patientNumber, x->date.year, x->date.month, x->date.day,
+                 x->time.hour, x->time.min, x->resource, x->duration, y->patientNumber,
+                 y->date.year, y->date.month, y->date.day, y->time.hour, y->time.min,
+                 y->resource, y->duration);
+        return;
+    }
+    snprintf(note, len, "the records match but not their count");
+}
+
+// Time sequential vs parallel imports for 1..maxThreads threads and print the scaling
+// (returns 1 if some thread count imported different records, naming the first)
+int benchmarkImport(const char *patientFile, const char *appointmentFile, int maxThreads)
+{
+    struct Patient *reference, *patients;
+    struct Appointment *refAppoints, *appoints;
+    double start, seqPatients, seqAppoints, parPatients, parAppoints, base = 0;
+    int patientCount, appointCount, threads, match, seqRecords, parRecords, mismatch = 0;
+    char note[256];
+
+    patientCount = countDataRecords(patientFile);
+    appointCount = countDataRecords(appointmentFile);
+    if (patientCount < 0 || appointCount < 0)
+    {
+        printf("Error: Fail to open the file\n");
+        return 1;
+    }
+    if (maxThreads <= 0)
+    {
+        maxThreads = loaderDefaultThreads();
+    }
+
+    reference = calloc(patientCount + 1, sizeof(*reference));
+    patients = calloc(patientCount + 1, sizeof(*patients));
+    refAppoints = calloc(appointCount + 1, sizeof(*refAppoints));
+    appoints = calloc(appointCount + 1, sizeof(*appoints));
+    if (reference == NULL || patients == NULL || refAppoints == NULL || appoints == NULL)
+    {
+        free(reference);
+        free(patients);
+        free(refAppoints);
+        free(appoints);
+        printf("ERROR: Out of memory\n");
+        return 1;
+    }
+
+    start = nowSeconds();
+    seqRecords = importPatients(patientFile, reference, patientCount);
+    seqPatients = nowSeconds() - start;
+    start = nowSeconds();
+    seqRecords += importAppointments(appointmentFile, refAppoints, appointCount);
+    seqAppoints = nowSeconds() - start;
+
+    printf("Import benchmark: %d patients, %d appointments\n\n", patientCount, appointCount);
+    printf("Threads  Patients(ms)  Appoint.(ms)  Speedup  Records  Result\n"
+           "-------- ------------- ------------- -------- -------- ------\n");
+    printf("%-8s %13.2f %13.2f %8s %8d %s\n", "scanf", seqPatients * 1e3, seqAppoints * 1e3,
+           "-", seqRecords, "ref");
+
+    for (threads = 1;; threads *= 2)
+    {
+        if (threads > maxThreads)
+        {
+            threads = maxThreads;
+        }
+        memset(patients, 0, sizeof(*patients) * patientCount);
+        memset(appoints, 0, sizeof(*appoints) * appointCount);
+
+        start = nowSeconds();
+        parRecords = importPatientsParallel(patientFile, patients, patientCount, threads);
+        parPatients = nowSeconds() - start;
+        start = nowSeconds();
+        parRecords += importAppointmentsParallel(appointmentFile, appoints, appointCount, threads);
+        parAppoints = nowSeconds() - start;
+
+        if (threads == 1)
+        {
+            base = parPatients + parAppoints;
+        }
+        match = parRecords == seqRecords &&
+                memcmp(patients, reference, sizeof(*patients) * patientCount) == 0 &&
+                memcmp(appoints, refAppoints, sizeof(*appoints) * appointCount) == 0;
+        printf("%-8d %13.2f %13.2f %7.2fx %8d %s\n", threads, parPatients * 1e3,
+               parAppoints * 1e3, base / (parPatients + parAppoints), parRecords,
+               match ? "same" : "DIFF");
+        if (!match && !mismatch)
+        {
+            mismatch = threads;
+            describeDifference(note, sizeof(note), reference, patients, patientCount,
+                               refAppoints, appoints, appointCount);
+        }
+        if (threads == maxThreads)
+        {
+            break;
+        }
+    }
+    putchar('\n');
+
+    if (mismatch)
+    {
+        printf("First difference (%d threads): %s\n\n", mismatch, note);
+    }
+
+    free(reference);
+    free(patients);
+    free(refAppoints);
+    free(appoints);
+    return mismatch ? 1 : 0;
+}
@@ -0,0 +1,46 @@
+// SAFE-GUARD:
+// It is good practice to apply safe-guards to header files
+// Safe-guard's ensures only 1 copy of the header file is used in the project build
+// The macro name should be mirroring the file name with _ for spaces, dots, etc.
+#ifndef LOADER_H
+#define LOADER_H
+
+#include "clinic.h"
+
+//////////////////////////////////////
+// Module macro's (usable by any file that includes this header)
+//////////////////////////////////////
+
+// Upper bound on loader threads
+#define LOADER_MAX_THREADS 64
+
+// Files smaller than this are parsed on the calling thread
+#define LOADER_MIN_CHUNK (64 * 1024)
+
+//////////////////////////////////////
+// FILE FUNCTIONS
+//////////////////////////////////////
+
+// Number of threads to use when the caller passes 0 (online CPUs)
+int loaderDefaultThreads(void);
+
+// Count the non-empty lines of a data file (returns -1 if it cannot be opened)
+int countDataRecords(const char *datafile);
+
+// Parallel importPatients: the first "max" records in file order (returns # of records read)
+int importPatientsParallel(const char *datafile, struct Patient patients[], int max,
+                           int threads);
+
+// Parallel importAppointments: the first "max" records in file order (returns # of records read)
+int importAppointmentsParallel(const char *datafile, struct Appointment appoints[], int max,
+                               int threads);
+
+//////////////////////////////////////
+// BENCHMARK FUNCTIONS
+//////////////////////////////////////
+
+// Time sequential vs parallel imports for 1..maxThreads threads and print the scaling
+// (returns 1 if some thread count imported different records, naming the first)
+int benchmarkImport(const char *patientFile, const char *appointmentFile, int maxThreads);
+
+#endif // !LOADER_H
@@ -1,24 +1,250 @@
 // Main function for the main menu
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
 #include "clinic.h"
+#include "loader.h"
+#include "shard.h"
+#include "server.h"
+#include "reminders.h"
+#include "changefeed.h"
+#include "packfile.h"
+#include "replay.h"
+#include "selfcheck.h"
+#include "generator.h"
 
 #define MAX_PETS 20 // Macro for the maximum number of patients
 #define MAX_APPOINTMENTS 50
+#define MAX_SITES 64 // Most sites served by one --serve-sites daemon
 
-int main(void)
+// Serve imported shards with "resources" resources each, then release them
+// (returns the exit status: 1 if the import failed)
+static int serveShards(struct ClinicShards *shards, int patientCount, int resources,
+                       const char *address)
 {
-    struct Patient pets[MAX_PETS] = {{0}};
-    struct Appointment appoints[MAX_APPOINTMENTS] = {{0}};
-    struct ClinicData data = {pets, MAX_PETS, appoints, MAX_APPOINTMENTS};
+    int result, i;
 
-    int patientCount = importPatients("patientData.txt", pets, MAX_PETS);
-    int appointmentCount = importAppointments("appointmentData.txt", appoints, MAX_APPOINTMENTS);
+    if (patientCount < 0)
+    {
+        destroyShards(shards);
+        return 1;
+    }
+    for (i = 0; i < shards->count; i++)
+    {
+        setClinicResources(&shards->shards[i].data, resources);
+    }
+    printf("Imported %d patient records into %d shard(s)...\n\n", patientCount, shards->count);
+    result = runServer(shards, address);
+    destroyShards(shards);
+    return result;
+}
+
+int main(int argc, char *argv[])
+{
+    struct ClinicData data;
+    struct ChangeFeed feed;
+    int patientCount, appointmentCount;
+
+    // Load generator: --loadgen [address] [connections] [requests] [depth]
+    if (argc > 1 && strcmp(argv[1], "--loadgen") == 0)
+    {
+        return runLoadGenerator(argc > 2 ? argv[2] : SERVER_DEFAULT_ADDRESS,
+                                argc > 3 ? atoi(argv[3]) : 4,
+                                argc > 4 ? atoi(argv[4]) : 100000,
+                                argc > 5 ? atoi(argv[5]) : 16);
+    }
+
+    // Daemon mode: --serve [address] [shards] [resources]
+    if (argc > 1 && strcmp(argv[1], "--serve") == 0)
+    {
+        struct ClinicShards shards;
+        int shardCount = argc > 3 ? atoi(argv[3]) : 1;
+
+        // Range shards hold twice an even share of the records, for uneven ranges
+        patientCount = countDataRecords("patientData.txt");
+        appointmentCount = countDataRecords("appointmentData.txt");
+        if (shardCount < 1 || patientCount < 0 || appointmentCount < 0 ||
+            !createShards(&shards, shardCount, SHARD_BY_RANGE,
+                          patientCount / shardCount * 2 + SHARD_ROOM,
+                          appointmentCount / shardCount * 2 + SHARD_ROOM))
+        {
+            printf("ERROR: Unable to create %d shard(s) for the data files\n", shardCount);
+            return 1;
+        }
+        patientCount = importShardedData(&shards, "patientData.txt", "appointmentData.txt");
+        return serveShards(&shards, patientCount, argc > 4 ? atoi(argv[4]) : CLINIC_RESOURCES,
+                           argc > 2 ? argv[2] : SERVER_DEFAULT_ADDRESS);
+    }
+
+    // Daemon mode with one shard per site: --serve-sites <address> <resources>
+    // <patientFile> <appointmentFile> [<patientFile> <appointmentFile> ...]
+    if (argc > 5 && argc % 2 == 0 && strcmp(argv[1], "--serve-sites") == 0)
+    {
+        struct ClinicShards shards;
+        const char *patientFiles[MAX_SITES], *appointmentFiles[MAX_SITES];
+        int siteCount = (argc - 4) / 2, most = 0, mostAppointments = 0, i;
+
+        // Every site's shard is sized for the largest site
+        for (i = 0; i < siteCount && i < MAX_SITES; i++)
+        {
+            patientFiles[i] = argv[4 + 2 * i];
+            appointmentFiles[i] = argv[5 + 2 * i];
+            patientCount = countDataRecords(patientFiles[i]);
+            appointmentCount = countDataRecords(appointmentFiles[i]);
+            most = patientCount > most ? patientCount : most;
+            mostAppointments = appointmentCount > mostAppointments ? appointmentCount
+                                                                   : mostAppointments;
+        }
+        if (siteCount > MAX_SITES ||
+            !createShards(&shards, siteCount, SHARD_BY_SITE, most + SHARD_ROOM,
+                          mostAppointments + SHARD_ROOM))
+        {
+            printf("ERROR: Unable to create %d site shard(s) (at most %d)\n", siteCount,
+                   MAX_SITES);
+            return 1;
+        }
+        patientCount = importShardSites(&shards, patientFiles, appointmentFiles);
+        return serveShards(&shards, patientCount, atoi(argv[3]), argv[2]);
+    }
+
+    // Import benchmark: --bench-import [patientFile] [appointmentFile] [threads]
+    if (argc > 1 && strcmp(argv[1], "--bench-import") == 0)
+    {
+        return benchmarkImport(argc > 2 ? argv[2] : "patientData.txt",
+                               argc > 3 ? argv[3] : "appointmentData.txt",
+                               argc > 4 ? atoi(argv[4]) : 0);
+    }
+
+    // Differential check of the indexes: --selfcheck [operations] [seed] [patients]
+    if (argc > 1 && strcmp(argv[1], "--selfcheck") == 0)
+    {
+        return runSelfCheck(argc > 2 ? atol(argv[2]) : SELFCHECK_OPERATIONS,
+                            argc > 3 ? strtoull(argv[3], NULL, 10) : (unsigned long long)time(NULL),
+                            argc > 4 ? atoi(argv[4]) : SELFCHECK_PATIENTS);
+    }
+
+    // Synthetic data: --generate <patientFile> <appointmentFile> <patients> [appointments]
+    // [seed] [resources] [from] (one appointment per patient, seed 1, enough resources
+    // for the bookings to stay near "from" and today by default)
+    if (argc > 4 && strcmp(argv[1], "--generate") == 0)
+    {
+        struct Date from;
+        time_t now = time(NULL);
+        struct tm *today = localtime(&now);
+
+        from.year = today->tm_year + 1900;
+        from.month = today->tm_mon + 1;
+        from.day = today->tm_mday;
+        if ((argc > 8 && sscanf(argv[8], "%d-%d-%d", &from.year, &from.month, &from.day) != 3) ||
+            !isValidDate(&from))
+        {
+            printf("ERROR: Dates must be valid yyyy-mm-dd dates\n");
+            return 1;
+        }
+        return generateDataFiles(argv[2], argv[3], atol(argv[4]),
+                                 argc > 5 ? atol(argv[5]) : atol(argv[4]),
+                                 argc > 7 ? atoi(argv[7]) : 0, &from,
+                                 argc > 6 ? strtoull(argv[6], NULL, 10) : 1);
+    }
+
+    // Session transcripts: --record <transcript> and --replay <transcript> [runs] [inputFile]
+    if (argc > 2 && strcmp(argv[1], "--record") == 0)
+    {
+        return recordTranscript(argv[2]);
+    }
+    if (argc > 2 && strcmp(argv[1], "--replay") == 0)
+    {
+        return replayTranscript(argv[2], argc > 3 && atoi(argv[3]) > 0 ? atoi(argv[3]) : 1,
+                                argc > 4 ? argv[4] : NULL);
+    }
+
+    // Compressed data files: --pack <patientFile> <appointmentFile> <packFile>
+    // and --unpack <packFile> <patientFile> <appointmentFile>
+    if (argc > 4 && strcmp(argv[1], "--pack") == 0)
+    {
+        return packDataFiles(argv[2], argv[3], argv[4]);
+    }
+    if (argc > 4 && strcmp(argv[1], "--unpack") == 0)
+    {
+        return unpackDataFiles(argv[2], argv[3], argv[4]);
+    }
+
+    // Journal benchmark: --bench-journal [file] [changes]
+    if (argc > 1 && strcmp(argv[1], "--bench-journal") == 0)
+    {
+        return benchmarkJournal(argc > 2 ? argv[2] : "journalBench.tmp",
+                                argc > 3 ? atoi(argv[3]) : JOURNAL_BENCH_CHANGES);
+    }
+
+    // Reminders batch job: --reminders [from] [to] [output] [patientFile] [appointmentFile]
+    // (dates as yyyy-mm-dd; tomorrow by default)
+    if (argc > 1 && strcmp(argv[1], "--reminders") == 0)
+    {
+        struct Date from, to;
+        time_t now = time(NULL);
+        struct tm *today = localtime(&now);
+
+        from.year = today->tm_year + 1900;
+        from.month = today->tm_mon + 1;
+        from.day = today->tm_mday;
+        dayToDate(dateToDay(&from) + 1, &from);
+        if (argc > 2 && sscanf(argv[2], "%d-%d-%d", &from.year, &from.month, &from.day) != 3)
+        {
+            from.year = 0;
+        }
+        to = from;
+        if (argc > 3 && sscanf(argv[3], "%d-%d-%d", &to.year, &to.month, &to.day) != 3)
+        {
+            to.year = 0;
+        }
+        if (!isValidDate(&from) || !isValidDate(&to))
+        {
+            printf("ERROR: Dates must be valid yyyy-mm-dd dates\n");
+            return 1;
+        }
+        return runReminders(argc > 5 ? argv[5] : "patientData.txt",
+                            argc > 6 ? argv[6] : "appointmentData.txt", &from, &to,
+                            argc > 4 ? argv[4] : REMINDERS_FILE);
+    }
+
+    // Replica: --replica <feed> [patientFile] [appointmentFile]
+    if (argc > 2 && strcmp(argv[1], "--replica") == 0)
+    {
+        return runReplica(argv[2], argc > 3 ? argv[3] : "patientData.txt",
+                          argc > 4 ? argv[4] : "appointmentData.txt");
+    }
+
+    // Change feed: --feed <file or replica socket> logs every change made in the menus
+    feed.fd = -1;
+    feed.journal = NULL;
+    if (argc > 2 && strcmp(argv[1], "--feed") == 0 && !changeFeedOpen(&feed, argv[2]))
+    {
+        printf("ERROR: Unable to open the change feed %s\n", argv[2]);
+        return 1;
+    }
+
+    if (!createClinic(&data, MAX_PETS, MAX_APPOINTMENTS))
+    {
+        printf("ERROR: Out of memory\n");
+        return 1;
+    }
+    patientCount = importPatients("patientData.txt", data.patients, data.maxPatient);
+    appointmentCount = importAppointments("appointmentData.txt", data.appointments,
+                                          data.maxAppointments);
+    syncClinicIndexes(&data);
+    if (feed.fd != -1)
+    {
+        data.feed = &feed;
+    }
 
     printf("Imported %d patient records...\n", patientCount);
     printf("Imported %d appointment records...\n\n", appointmentCount);
 
     menuMain(&data);
+    destroyClinic(&data);
+    changeFeedClose(&feed);
 
     return 0;
-}
\ No newline at end of file
+}
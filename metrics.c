@@ -0,0 +1,231 @@
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+// include the user library "metrics" where the function prototypes are declared
+#include "metrics.h"
+
+#ifndef CLINIC_NO_METRICS
+
+//////////////////////////////////////
+// Internal structures
+//////////////////////////////////////
+
+// One thread's histograms: only that thread writes them, so recording
+// needs no locks or atomics (a report taken while threads run is approximate)
+struct ThreadMetrics
+{
+    struct Histogram ops[METRIC_COUNT];
+    struct ThreadMetrics *next;
+    int retired; // owning thread exited: the block is reused by the next new thread
+};
+
+static struct ThreadMetrics *threads;
+static pthread_mutex_t threadsLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t threadKey;
+static pthread_once_t keyOnce = PTHREAD_ONCE_INIT;
+static __thread struct ThreadMetrics *local;
+
+static const char *const opNames[METRIC_COUNT] = {
+    "find patient", "phone search", "book appointment", "sort appointments",
+    "import patients", "import appointments", "view patients", "view all appts",
+    "view appts by date", "server request"};
+
+//////////////////////////////////////
+// HELPERS
+//////////////////////////////////////
+
+// Thread exit: keep the counts, hand the block to the next new thread
+static void retireThread(void *block)
+{
+    pthread_mutex_lock(&threadsLock);
+    ((struct ThreadMetrics *)block)->retired = 1;
+    pthread_mutex_unlock(&threadsLock);
+}
+
+static void createKey(void)
+{
+    pthread_key_create(&threadKey, retireThread);
+}
+
+// The calling thread's histograms (returns NULL when out of memory)
+static struct ThreadMetrics *threadMetrics(void)
+{
+    struct ThreadMetrics *block;
+
+    if (local != NULL)
+    {
+        return local;
+    }
+    pthread_once(&keyOnce, createKey);
+    pthread_mutex_lock(&threadsLock);
+    for (block = threads; block != NULL && !block->retired; block = block->next)
+    {
+        ; // find a retired block
+    }
+    if (block != NULL)
+    {
+        block->retired = 0;
+    }
+    else
+    {
+        block = calloc(1, sizeof(*block));
+        if (block != NULL)
+        {
+            block->next = threads;
+            threads = block;
+        }
+    }
+    pthread_mutex_unlock(&threadsLock);
+    if (block != NULL)
+    {
+        pthread_setspecific(threadKey, block);
+    }
+    local = block;
+    return block;
+}
+
+// Bucket of a value: exact below 2^(METRICS_SUB_BITS+1), then
+// 2^METRICS_SUB_BITS linear steps per power of two
+static int bucketOf(unsigned long long value)
+{
+    int exponent;
+
+    if (value < (2ULL << METRICS_SUB_BITS))
+    {
+        return (int)value;
+    }
+    exponent = 63 - __builtin_clzll(value);
+    return ((exponent - METRICS_SUB_BITS + 1) << METRICS_SUB_BITS) +
+           (int)((value >> (exponent - METRICS_SUB_BITS)) & ((1u << METRICS_SUB_BITS) - 1));
+}
+
+// Highest value that falls in a bucket
+static unsigned long long bucketTop(int bucket)
+{
+    int exponent, sub;
+
+    if (bucket < (2 << METRICS_SUB_BITS))
+    {
+        return (unsigned long long)bucket;
+    }
+    exponent = (bucket >> METRICS_SUB_BITS) + METRICS_SUB_BITS - 1;
+    sub = bucket & ((1 << METRICS_SUB_BITS) - 1);
+    return ((((unsigned long long)(1 << METRICS_SUB_BITS) + sub + 1)
+             << (exponent - METRICS_SUB_BITS)) - 1);
+}
+
+// Value below which "fraction" of the recorded latencies fall
+static unsigned long long percentile(const struct Histogram *hist, double fraction)
+{
+    double wanted = hist->count * fraction;
+    unsigned long long rank = (unsigned long long)wanted, seen = 0;
+    int i;
+
+    // Nearest rank: the ceil(count * fraction)-th smallest latency
+    if (rank > 0 && (double)rank == wanted)
+    {
+        rank--;
+    }
+
+    for (i = 0; i < METRICS_BUCKETS; i++)
+    {
+        seen += hist->buckets[i];
+        if (seen > rank)
+        {
+            return bucketTop(i) < hist->max ? bucketTop(i) : hist->max;
+        }
+    }
+    return hist->max;
+}
+
+//////////////////////////////////////
+// METRICS FUNCTIONS
+//////////////////////////////////////
+
+// Monotonic clock in nanoseconds
+unsigned long long metricsNow(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL + (unsigned long long)ts.tv_nsec;
+}
+
+// Record one operation's latency in the calling thread's histograms
+void metricsRecord(int op, unsigned long long nanos)
+{
+    struct ThreadMetrics *block = threadMetrics();
+    struct Histogram *hist;
+
+    if (block == NULL)
+    {
+        return;
+    }
+    hist = &block->ops[op];
+    hist->count++;
+    hist->total += nanos;
+    if (nanos > hist->max)
+    {
+        hist->max = nanos;
+    }
+    hist->buckets[bucketOf(nanos)]++;
+}
+
+// Print count, mean, percentiles and max of every operation seen by any thread
+void metricsReport(FILE *out)
+{
+    struct ThreadMetrics *block;
+    struct Histogram *merged;
+    int op, i;
+
+    merged = calloc(1, sizeof(*merged));
+    if (merged == NULL)
+    {
+        return;
+    }
+    fprintf(out, "Operation Metrics (microseconds)\n"
+                 "===========================================================================\n"
+                 "Operation              Count      Mean       p50       p99     p99.9       Max\n"
+                 "-------------------- ------- --------- --------- --------- --------- ---------\n");
+    for (op = 0; op < METRIC_COUNT; op++)
+    {
+        memset(merged, 0, sizeof(*merged));
+        pthread_mutex_lock(&threadsLock);
+        for (block = threads; block != NULL; block = block->next)
+        {
+            merged->count += block->ops[op].count;
+            merged->total += block->ops[op].total;
+            if (block->ops[op].max > merged->max)
+            {
+                merged->max = block->ops[op].max;
+            }
+            for (i = 0; i < METRICS_BUCKETS; i++)
+            {
+                merged->buckets[i] += block->ops[op].buckets[i];
+            }
+        }
+        pthread_mutex_unlock(&threadsLock);
+
+        if (merged->count)
+        {
+            fprintf(out, "%-20s %7llu %9.2f %9.2f %9.2f %9.2f %9.2f\n", opNames[op],
+                    merged->count, merged->total / 1000.0 / merged->count,
+                    percentile(merged, 0.50) / 1000.0, percentile(merged, 0.99) / 1000.0,
+                    percentile(merged, 0.999) / 1000.0, merged->max / 1000.0);
+        }
+    }
+    fputc('\n', out);
+    free(merged);
+}
+
+#else
+
+// Print count, mean, percentiles and max of every operation seen by any thread
+void metricsReport(FILE *out)
+{
+    fprintf(out, "Operation metrics are not available (built with CLINIC_NO_METRICS)\n\n");
+}
+
+#endif // !CLINIC_NO_METRICS
@@ -0,0 +1,70 @@
+// SAFE-GUARD:
+// It is good practice to apply safe-guards to header files
+// Safe-guard's ensures only 1 copy of the header file is used in the project build
+// The macro name should be mirroring the file name with _ for spaces, dots, etc.
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdio.h>
+
+//////////////////////////////////////
+// Module macro's (usable by any file that includes this header)
+//////////////////////////////////////
+
+// Instrumented operations
+#define METRIC_FIND_PATIENT 0
+#define METRIC_PHONE_SEARCH 1
+#define METRIC_BOOK_APPOINTMENT 2
+#define METRIC_SORT 3
+#define METRIC_IMPORT_PATIENTS 4
+#define METRIC_IMPORT_APPOINTMENTS 5
+#define METRIC_VIEW_PATIENTS 6
+#define METRIC_VIEW_ALL 7
+#define METRIC_VIEW_DAY 8
+#define METRIC_REQUEST 9
+#define METRIC_COUNT 10
+
+// Histogram resolution: 2^METRICS_SUB_BITS buckets per power of two (~6% error)
+#define METRICS_SUB_BITS 4
+#define METRICS_BUCKETS ((64 - METRICS_SUB_BITS + 1) << METRICS_SUB_BITS)
+
+// Time an operation: METRIC_START(t) among the declarations, METRIC_STOP(op, t) when done
+// (METRIC_RESTART(t) excludes what came before, e.g. waiting for user input).
+// Building with -DCLINIC_NO_METRICS compiles the instrumentation out.
+#ifndef CLINIC_NO_METRICS
+#define METRIC_START(var) unsigned long long var = metricsNow()
+#define METRIC_RESTART(var) ((var) = metricsNow())
+#define METRIC_STOP(op, var) metricsRecord((op), metricsNow() - (var))
+#else
+#define METRIC_START(var) int var = 0
+#define METRIC_RESTART(var) ((void)(var))
+#define METRIC_STOP(op, var) ((void)(var))
+#endif
+
+//////////////////////////////////////
+// Structures
+//////////////////////////////////////
+
+// Data type: log-linear latency histogram of one operation (nanoseconds)
+struct Histogram
+{
+    unsigned long long count;
+    unsigned long long total;
+    unsigned long long max;
+    unsigned long long buckets[METRICS_BUCKETS];
+};
+
+//////////////////////////////////////
+// METRICS FUNCTIONS
+//////////////////////////////////////
+
+// Monotonic clock in nanoseconds
+unsigned long long metricsNow(void);
+
+// Record one operation's latency in the calling thread's histograms
+void metricsRecord(int op, unsigned long long nanos);
+
+// Print count, mean, percentiles and max of every operation seen by any thread
+void metricsReport(FILE *out);
+
+#endif // !METRICS_H
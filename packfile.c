@@ -0,0 +1,808 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+// include the user library "packfile" where the function prototypes are declared
+#include "packfile.h"
+
+// Longest line of the text data files
+#define PACK_LINE_LEN 127
+
+// Initial dictionary slots
+#define PACK_DICTIONARY_START 256
+
+// decodeRecord result when the buffer ends inside the record
+#define PACK_SHORT -2
+
+//////////////////////////////////////
+// VARINT HELPERS
+//////////////////////////////////////
+
+// Append an unsigned varint
+static unsigned char *putVarint(unsigned char *out, unsigned long long value)
+{
+    while (value >= 0x80)
+    {
+        *out++ = (unsigned char)(value | 0x80);
+        value >>= 7;
+    }
+    *out++ = (unsigned char)value;
+    return out;
+}
+
+// Zigzag code a signed value so small negatives stay short
+static unsigned long long zigzag(long long value)
+{
+    return ((unsigned long long)value << 1) ^ (unsigned long long)(value >> 63);
+}
+
+// Undo zigzag
+static long long unzigzag(unsigned long long value)
+{
+    return (long long)(value >> 1) ^ -(long long)(value & 1);
+}
+
+// Read an unsigned varint ending before "end" (returns 0 if it does not)
+static int getVarint(const unsigned char **at, const unsigned char *end,
+                     unsigned long long *value)
+{
+    const unsigned char *in = *at;
+    unsigned long long result = 0;
+    int shift;
+
+    for (shift = 0; in < end && shift < 64; shift += 7)
+    {
+        result |= (unsigned long long)(*in & 0x7F) << shift;
+        if ((*in++ & 0x80) == 0)
+        {
+            *value = result;
+            *at = in;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+//////////////////////////////////////
+// DICTIONARY HELPERS
+//////////////////////////////////////
+
+// Hash of a name
+static unsigned int hashName(const char *name)
+{
+    unsigned int hash = 2166136261u;
+
+    while (*name)
+    {
+        hash = (hash ^ (unsigned char)*name++) * 16777619u;
+    }
+    return hash;
+}
+
+// Hash of a phone number
+static unsigned int hashPhone(unsigned long long number)
+{
+    number *= 0x9E3779B97F4A7C15ULL;
+    return (unsigned int)(number >> 32);
+}
+
+// Make room for one more name (returns 0 if out of memory)
+static int growNames(struct PackNames *names)
+{
+    char (*entries)[NAME_LEN + 1];
+    int capacity;
+
+    if (names->count < names->capacity)
+    {
+        return 1;
+    }
+    capacity = names->capacity ? names->capacity * 2 : PACK_DICTIONARY_START;
+    entries = realloc(names->entries, sizeof(*entries) * capacity);
+    if (entries == NULL)
+    {
+        return 0;
+    }
+    names->entries = entries;
+    names->capacity = capacity;
+    return 1;
+}
+
+// Make room for one more phone number (returns 0 if out of memory)
+static int growPhones(struct PackPhones *phones)
+{
+    unsigned long long *entries;
+    int capacity;
+
+    if (phones->count < phones->capacity)
+    {
+        return 1;
+    }
+    capacity = phones->capacity ? phones->capacity * 2 : PACK_DICTIONARY_START;
+    entries = realloc(phones->entries, sizeof(*entries) * capacity);
+    if (entries == NULL)
+    {
+        return 0;
+    }
+    phones->entries = entries;
+    phones->capacity = capacity;
+    return 1;
+}
+
+// Rebuild an index at twice the size once it is half full (returns 0 if out of memory)
+static int growTable(int **table, int *tableSize, int count, const void *entries, int isName)
+{
+    int size, i, slot, *grown;
+
+    if (count * 2 < *tableSize)
+    {
+        return 1;
+    }
+    size = *tableSize ? *tableSize * 2 : PACK_DICTIONARY_START * 2;
+    grown = malloc(sizeof(*grown) * size);
+    if (grown == NULL)
+    {
+        return 0;
+    }
+    memset(grown, -1, sizeof(*grown) * size);
+    for (i = 0; i < count; i++)
+    {
+        slot = (int)((isName ? hashName(((const char(*)[NAME_LEN + 1])entries)[i])
+                             : hashPhone(((const unsigned long long *)entries)[i])) &
+                     (unsigned int)(size - 1));
+        while (grown[slot] != -1)
+        {
+            slot = (slot + 1) & (size - 1);
+        }
+        grown[slot] = i;
+    }
+    free(*table);
+    *table = grown;
+    *tableSize = size;
+    return 1;
+}
+
+// Writer: find a name, adding it if new (returns its entry, -1 if out of memory;
+// "added" tells whether it was new)
+static int lookupName(struct PackNames *names, const char *name, int *added)
+{
+    int slot;
+
+    if (!growTable(&names->table, &names->tableSize, names->count, names->entries, 1) ||
+        !growNames(names))
+    {
+        return -1;
+    }
+    slot = (int)(hashName(name) & (unsigned int)(names->tableSize - 1));
+    while (names->table[slot] != -1)
+    {
+        if (strcmp(names->entries[names->table[slot]], name) == 0)
+        {
+            *added = 0;
+            return names->table[slot];
+        }
+        slot = (slot + 1) & (names->tableSize - 1);
+    }
+    strcpy(names->entries[names->count], name);
+    names->table[slot] = names->count;
+    *added = 1;
+    return names->count++;
+}
+
+// Writer: find a phone number, adding it if new (returns its entry, -1 if out of memory)
+static int lookupPhone(struct PackPhones *phones, unsigned long long number, int *added)
+{
+    int slot;
+
+    if (!growTable(&phones->table, &phones->tableSize, phones->count, phones->entries, 0) ||
+        !growPhones(phones))
+    {
+        return -1;
+    }
+    slot = (int)(hashPhone(number) & (unsigned int)(phones->tableSize - 1));
+    while (phones->table[slot] != -1)
+    {
+        if (phones->entries[phones->table[slot]] == number)
+        {
+            *added = 0;
+            return phones->table[slot];
+        }
+        slot = (slot + 1) & (phones->tableSize - 1);
+    }
+    phones->entries[phones->count] = number;
+    phones->table[slot] = phones->count;
+    *added = 1;
+    return phones->count++;
+}
+
+// Release the dictionaries
+static void freeState(struct PackState *state)
+{
+    free(state->firstNames.entries);
+    free(state->firstNames.table);
+    free(state->surnames.entries);
+    free(state->surnames.table);
+    free(state->phones.entries);
+    free(state->phones.table);
+    memset(state, 0, sizeof(*state));
+}
+
+// Append a name code, spelling the name out when it is new (returns NULL if out
+// of memory); "base" is the code of entry 0, the code before it marks a new entry
+static unsigned char *putName(unsigned char *out, struct PackNames *names, const char *name,
+                              int base)
+{
+    int added, entry = lookupName(names, name, &added);
+    size_t len = strlen(name);
+
+    if (entry == -1)
+    {
+        return NULL;
+    }
+    if (!added)
+    {
+        return putVarint(out, (unsigned long long)(entry + base));
+    }
+    out = putVarint(out, (unsigned long long)(base - 1));
+    out = putVarint(out, len);
+    memcpy(out, name, len);
+    return out + len;
+}
+
+// Read a name code into "name" (returns 0 if corrupt, PACK_SHORT if cut off)
+static int getName(const unsigned char **at, const unsigned char *end,
+                   struct PackNames *names, unsigned long long code, int base, char *name)
+{
+    unsigned long long len;
+
+    if (code >= (unsigned long long)base)
+    {
+        if (code - base >= (unsigned long long)names->count)
+        {
+            return 0;
+        }
+        strcpy(name, names->entries[code - base]);
+        return 1;
+    }
+    if (!getVarint(at, end, &len))
+    {
+        return PACK_SHORT;
+    }
+    if (len > NAME_LEN)
+    {
+        return 0;
+    }
+    if ((size_t)(end - *at) < len)
+    {
+        return PACK_SHORT;
+    }
+    if (!growNames(names))
+    {
+        return 0;
+    }
+    memcpy(names->entries[names->count], *at, len);
+    names->entries[names->count][len] = '\0';
+    strcpy(name, names->entries[names->count++]);
+    *at += len;
+    return 1;
+}
+
+//////////////////////////////////////
+// WRITER FUNCTIONS
+//////////////////////////////////////
+
+// Create a pack file (returns 0 on failure)
+int packWriterOpen(struct PackWriter *writer, const char *file)
+{
+    memset(writer, 0, sizeof(*writer));
+    writer->fp = fopen(file, "wb");
+    if (writer->fp == NULL)
+    {
+        return 0;
+    }
+    writer->bytes = PACK_MAGIC_LEN;
+    return fwrite(PACK_MAGIC, 1, PACK_MAGIC_LEN, writer->fp) == PACK_MAGIC_LEN;
+}
+
+// Add a patient ("phone" packed like Patient.phone) (returns 0 on a write error)
+int packPatient(struct PackWriter *writer, int patientNumber, const char *name,
+                unsigned long long phone)
+{
+    struct PackState *state = &writer->state;
+    unsigned char record[PACK_MAX_RECORD], *out = record;
+    char first[NAME_LEN + 1];
+    const char *space = strrchr(name, ' ');
+    size_t firstLen = space != NULL ? (size_t)(space - name) : strlen(name);
+    int added, entry;
+
+    if (patientNumber < 1 || firstLen > NAME_LEN ||
+        (space != NULL && strlen(space + 1) > NAME_LEN))
+    {
+        return 0;
+    }
+    memcpy(first, name, firstLen);
+    first[firstLen] = '\0';
+
+    out = putVarint(out, zigzag((long long)patientNumber - state->lastPatient) << 2 | PACK_PATIENT);
+    out = putName(out, &state->firstNames, first, 1);
+    if (out != NULL)
+    {
+        out = space != NULL ? putName(out, &state->surnames, space + 1, 2) : putVarint(out, 0);
+    }
+    entry = out != NULL ? lookupPhone(&state->phones, phone >> PHONE_TYPE_BITS, &added) : -1;
+    if (entry == -1)
+    {
+        return 0;
+    }
+    out = putVarint(out, (unsigned long long)(added ? 0 : entry + 1) << PHONE_TYPE_BITS |
+                             (phone & ((1 << PHONE_TYPE_BITS) - 1)));
+    if (added)
+    {
+        out = putVarint(out, phone >> PHONE_TYPE_BITS);
+    }
+
+    state->lastPatient = patientNumber;
+    state->patients++;
+    writer->bytes += out - record;
+    return fwrite(record, 1, out - record, writer->fp) == (size_t)(out - record);
+}
+
+// Add an appointment (returns 0 on a write error)
+int packAppointment(struct PackWriter *writer, const struct Appointment *appoint)
+{
+    struct PackState *state = &writer->state;
+    unsigned char record[PACK_MAX_RECORD], *out = record;
+    int day = dateToDay(&appoint->date);
+    int minutes = appoint->time.hour * 60 + appoint->time.min;
+
+    // Only records packNext reads back are written
+    if (appoint->patientNumber < 1 || day < FIRST_VALID_DAY || minutes < 0 ||
+        minutes >= 24 * 60 || appoint->resource < 0 || appoint->duration < 0)
+    {
+        return 0;
+    }
+
+    out = putVarint(out, zigzag((long long)appoint->patientNumber - state->lastAppointment) << 2 |
+                             PACK_APPOINTMENT);
+    out = putVarint(out, zigzag((long long)day - state->lastDay));
+    out = putVarint(out, (unsigned long long)minutes);
+    out = putVarint(out, (unsigned long long)appoint->resource);
+    out = putVarint(out, (unsigned long long)appoint->duration);
+
+    state->lastAppointment = appoint->patientNumber;
+    state->lastDay = day;
+    state->appointments++;
+    writer->bytes += out - record;
+    return fwrite(record, 1, out - record, writer->fp) == (size_t)(out - record);
+}
+
+// Write the end mark and close the file (returns 0 on a write error)
+int packWriterClose(struct PackWriter *writer)
+{
+    unsigned char end[24], *out = end;
+    int ok;
+
+    out = putVarint(out, 0);
+    out = putVarint(out, (unsigned long long)writer->state.patients);
+    out = putVarint(out, (unsigned long long)writer->state.appointments);
+    writer->bytes += out - end;
+    ok = fwrite(end, 1, out - end, writer->fp) == (size_t)(out - end);
+    if (fclose(writer->fp) != 0)
+    {
+        ok = 0;
+    }
+    writer->fp = NULL;
+    freeState(&writer->state);
+    return ok;
+}
+
+//////////////////////////////////////
+// READER FUNCTIONS
+//////////////////////////////////////
+
+// Move the unread bytes to the front and read more (returns bytes read, 0 at the
+// end of the file, -1 on error)
+static int fillReader(struct PackReader *reader)
+{
+    ssize_t n;
+
+    memmove(reader->buffer, reader->buffer + reader->pos, reader->len - reader->pos);
+    reader->len -= reader->pos;
+    reader->pos = 0;
+    do
+    {
+        n = read(reader->fd, reader->buffer + reader->len, PACK_READ_CHUNK);
+    } while (n == -1 && errno == EINTR);
+    if (n > 0)
+    {
+        reader->len += (int)n;
+        reader->bytes += n;
+    }
+    return (int)n;
+}
+
+// Open a pack file (returns 0 if it cannot be read or is not a pack file)
+int packReaderOpen(struct PackReader *reader, const char *file)
+{
+    memset(reader, 0, sizeof(*reader));
+    reader->fd = open(file, O_RDONLY | O_CLOEXEC);
+    reader->buffer = malloc(PACK_READ_CHUNK + PACK_MAX_RECORD);
+    if (reader->fd != -1 && reader->buffer != NULL)
+    {
+        posix_fadvise(reader->fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+        while (reader->len < PACK_MAGIC_LEN && fillReader(reader) > 0)
+        {
+            ; // a short read leaves the magic incomplete
+        }
+        if (reader->len >= PACK_MAGIC_LEN &&
+            memcmp(reader->buffer, PACK_MAGIC, PACK_MAGIC_LEN) == 0)
+        {
+            reader->pos = PACK_MAGIC_LEN;
+            return 1;
+        }
+    }
+    packReaderClose(reader);
+    return 0;
+}
+
+// Decode one record from the buffer (returns a packNext result or PACK_SHORT)
+static int decodeRecord(struct PackReader *reader, struct PackRecord *record)
+{
+    struct PackState *state = &reader->state;
+    const unsigned char *at = reader->buffer + reader->pos;
+    const unsigned char *end = reader->buffer + reader->len;
+    unsigned long long head, code, a, b, c, d;
+    long long delta;
+    int kind, rc;
+
+    if (!getVarint(&at, end, &head))
+    {
+        return PACK_SHORT;
+    }
+    kind = (int)(head & 3);
+    if (kind == 0)
+    {
+        if (head != 0)
+        {
+            return PACK_BAD;
+        }
+        if (!getVarint(&at, end, &a) || !getVarint(&at, end, &b))
+        {
+            return PACK_SHORT;
+        }
+        reader->pos = (int)(at - reader->buffer);
+        return (long long)a == state->patients && (long long)b == state->appointments
+                   ? PACK_END
+                   : PACK_BAD;
+    }
+
+    if (kind == PACK_PATIENT)
+    {
+        delta = unzigzag(head >> 2);
+        if (delta < 1 - (long long)state->lastPatient ||
+            delta > INT_MAX - (long long)state->lastPatient)
+        {
+            return PACK_BAD;
+        }
+        record->patientNumber = (int)(state->lastPatient + delta);
+        if (!getVarint(&at, end, &code))
+        {
+            return PACK_SHORT;
+        }
+        rc = getName(&at, end, &state->firstNames, code, 1, record->name);
+        if (rc != 1)
+        {
+            return rc == 0 ? PACK_BAD : PACK_SHORT;
+        }
+        if (!getVarint(&at, end, &code))
+        {
+            return PACK_SHORT;
+        }
+        if (code != 0)
+        {
+            char surname[NAME_LEN + 1];
+            size_t len = strlen(record->name);
+
+            rc = getName(&at, end, &state->surnames, code, 2, surname);
+            if (rc != 1)
+            {
+                return rc == 0 ? PACK_BAD : PACK_SHORT;
+            }
+            if (len + 1 + strlen(surname) > NAME_LEN)
+            {
+                return PACK_BAD;
+            }
+            record->name[len] = ' ';
+            strcpy(record->name + len + 1, surname);
+        }
+        if (!getVarint(&at, end, &code))
+        {
+            return PACK_SHORT;
+        }
+        if (code >> PHONE_TYPE_BITS == 0)
+        {
+            if (!getVarint(&at, end, &a))
+            {
+                return PACK_SHORT;
+            }
+            if (!growPhones(&state->phones))
+            {
+                return PACK_BAD;
+            }
+            state->phones.entries[state->phones.count++] = a;
+        }
+        else if ((code >> PHONE_TYPE_BITS) - 1 < (unsigned long long)state->phones.count)
+        {
+            a = state->phones.entries[(code >> PHONE_TYPE_BITS) - 1];
+        }
+        else
+        {
+            return PACK_BAD;
+        }
+        record->phone = a << PHONE_TYPE_BITS | (code & ((1 << PHONE_TYPE_BITS) - 1));
+        state->lastPatient = record->patientNumber;
+        state->patients++;
+    }
+    else if (kind == PACK_APPOINTMENT)
+    {
+        delta = unzigzag(head >> 2);
+        if (delta < 1 - (long long)state->lastAppointment ||
+            delta > INT_MAX - (long long)state->lastAppointment)
+        {
+            return PACK_BAD;
+        }
+        record->patientNumber = (int)(state->lastAppointment + delta);
+        if (!getVarint(&at, end, &a) || !getVarint(&at, end, &b) ||
+            !getVarint(&at, end, &c) || !getVarint(&at, end, &d))
+        {
+            return PACK_SHORT;
+        }
+
+        // The day must stay one isValidDate accepts and every field fit an int
+        delta = unzigzag(a);
+        if (b >= 24 * 60 || c > INT_MAX || d > INT_MAX ||
+            delta < FIRST_VALID_DAY - (long long)state->lastDay ||
+            delta > INT_MAX - (long long)state->lastDay)
+        {
+            return PACK_BAD;
+        }
+        state->lastDay += (int)delta;
+        record->appointment.patientNumber = record->patientNumber;
+        dayToDate(state->lastDay, &record->appointment.date);
+        record->appointment.time.hour = (int)(b / 60);
+        record->appointment.time.min = (int)(b % 60);
+        record->appointment.resource = (int)c;
+        record->appointment.duration = (int)d;
+        state->lastAppointment = record->patientNumber;
+        state->appointments++;
+    }
+    else
+    {
+        return PACK_BAD;
+    }
+    reader->pos = (int)(at - reader->buffer);
+    return kind;
+}
+
+// Decode the next record (returns PACK_PATIENT / PACK_APPOINTMENT, PACK_END or PACK_BAD)
+int packNext(struct PackReader *reader, struct PackRecord *record)
+{
+    struct PackState *state = &reader->state;
+    int result, firstNames, surnames, phones;
+
+    if (reader->fd == -1)
+    {
+        return PACK_BAD;
+    }
+    for (;;)
+    {
+        // Records are decoded straight from the buffer; one cut off by the end of
+        // the buffer is decoded again after the next read, dropping the dictionary
+        // entries it added the first time
+        firstNames = state->firstNames.count;
+        surnames = state->surnames.count;
+        phones = state->phones.count;
+        result = decodeRecord(reader, record);
+        if (result != PACK_SHORT)
+        {
+            return result;
+        }
+        state->firstNames.count = firstNames;
+        state->surnames.count = surnames;
+        state->phones.count = phones;
+        if (reader->eof || reader->len - reader->pos > PACK_MAX_RECORD)
+        {
+            return PACK_BAD;
+        }
+        if (fillReader(reader) <= 0)
+        {
+            reader->eof = 1;
+        }
+    }
+}
+
+// Close the file
+void packReaderClose(struct PackReader *reader)
+{
+    if (reader->fd != -1)
+    {
+        close(reader->fd);
+    }
+    reader->fd = -1;
+    free(reader->buffer);
+    reader->buffer = NULL;
+    freeState(&reader->state);
+}
+
+//////////////////////////////////////
+// CONVERSION FUNCTIONS
+//////////////////////////////////////
+
+// Seconds between two clock readings
+static double secondsBetween(const struct timespec *from, const struct timespec *to)
+{
+    return (double)(to->tv_sec - from->tv_sec) + (to->tv_nsec - from->tv_nsec) / 1e9;
+}
+
+// Compress data files in the import layouts into a pack file, printing the sizes
+// (returns 0 on success)
+int packDataFiles(const char *patientFile, const char *appointmentFile, const char *packFile)
+{
+    struct PackWriter writer;
+    struct Appointment appoint;
+    char line[PACK_LINE_LEN + 1], name[PACK_LINE_LEN + 1];
+    char description[PACK_LINE_LEN + 1], number[PACK_LINE_LEN + 1];
+    FILE *patients = fopen(patientFile, "r");
+    FILE *appoints = fopen(appointmentFile, "r");
+    long long textBytes = 0, patientCount, appointmentCount;
+    int patientNumber, fields, ok;
+
+    if (patients == NULL || appoints == NULL || !packWriterOpen(&writer, packFile))
+    {
+        printf("ERROR: Unable to open %s, %s or %s\n", patientFile, appointmentFile, packFile);
+        if (patients != NULL)
+        {
+            fclose(patients);
+        }
+        if (appoints != NULL)
+        {
+            fclose(appoints);
+        }
+        return 1;
+    }
+
+    // Same fields and defaults as importPatients / importAppointments
+    ok = 1;
+    while (ok && fgets(line, sizeof(line), patients) != NULL)
+    {
+        textBytes += (long long)strlen(line);
+        name[0] = description[0] = number[0] = '\0';
+        patientNumber = 0;
+        sscanf(line, "%d|%127[^|]|%127[^|]|%127[^\n]", &patientNumber, name, description,
+               number);
+        if (patientNumber != 0)
+        {
+            name[NAME_LEN] = '\0';
+            description[PHONE_DESC_LEN] = '\0';
+            number[PHONE_LEN] = '\0';
+            ok = packPatient(&writer, patientNumber, name,
+                             parsePhoneNumber(number) << PHONE_TYPE_BITS |
+                                 (unsigned long long)parsePhoneType(description));
+        }
+    }
+    while (ok && fgets(line, sizeof(line), appoints) != NULL)
+    {
+        textBytes += (long long)strlen(line);
+        fields = sscanf(line, "%d,%d,%d,%d,%d,%d,%d,%d", &appoint.patientNumber,
+                        &appoint.date.year, &appoint.date.month, &appoint.date.day,
+                        &appoint.time.hour, &appoint.time.min, &appoint.resource,
+                        &appoint.duration);
+        if (fields >= 6)
+        {
+            appoint.resource = fields < 7 ? 0 : appoint.resource;
+            appoint.duration = fields < 8 ? MINUTE_INTERVAL : appoint.duration;
+            ok = packAppointment(&writer, &appoint);
+        }
+    }
+    fclose(patients);
+    fclose(appoints);
+
+    patientCount = writer.state.patients;
+    appointmentCount = writer.state.appointments;
+    if (!packWriterClose(&writer) || !ok)
+    {
+        printf("ERROR: Writing %s failed\n", packFile);
+        return 1;
+    }
+    printf("Packed %lld patient(s) and %lld appointment(s): %lld bytes of text -> %lld bytes"
+           " (%.1f%%)\n",
+           patientCount, appointmentCount, textBytes, writer.bytes,
+           textBytes > 0 ? 100.0 * writer.bytes / textBytes : 0.0);
+    return 0;
+}
+
+// Expand a pack file back into the import layouts, printing the decode speed
+// (returns 0 on success)
+int unpackDataFiles(const char *packFile, const char *patientFile, const char *appointmentFile)
+{
+    struct PackReader reader;
+    struct PackRecord record;
+    struct Patient patient = {0};
+    struct Phone phone;
+    struct timespec start, stop;
+    FILE *patients, *appoints;
+    long long patientCount, appointmentCount;
+    int result;
+
+    // A first pass only decodes, timing the decoder apart from the text formatting
+    if (!packReaderOpen(&reader, packFile))
+    {
+        printf("ERROR: %s is not a pack file\n", packFile);
+        return 1;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    while ((result = packNext(&reader, &record)) == PACK_PATIENT || result == PACK_APPOINTMENT)
+    {
+        ; // records are dropped
+    }
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    patientCount = reader.state.patients;
+    appointmentCount = reader.state.appointments;
+    packReaderClose(&reader);
+    if (result != PACK_END)
+    {
+        printf("ERROR: %s is corrupt or cut short\n", packFile);
+        return 1;
+    }
+    printf("Decoded %s: %lld patient(s) and %lld appointment(s) from %lld bytes in %.3f s"
+           " (%.0f MB/s)\n",
+           packFile, patientCount, appointmentCount, reader.bytes,
+           secondsBetween(&start, &stop),
+           reader.bytes / (secondsBetween(&start, &stop) + 1e-9) / 1e6);
+
+    patients = fopen(patientFile, "w");
+    appoints = fopen(appointmentFile, "w");
+    if (patients == NULL || appoints == NULL || !packReaderOpen(&reader, packFile))
+    {
+        printf("ERROR: Unable to create %s or %s\n", patientFile, appointmentFile);
+        if (patients != NULL)
+        {
+            fclose(patients);
+        }
+        if (appoints != NULL)
+        {
+            fclose(appoints);
+        }
+        return 1;
+    }
+    while ((result = packNext(&reader, &record)) == PACK_PATIENT || result == PACK_APPOINTMENT)
+    {
+        if (result == PACK_PATIENT)
+        {
+            patient.phone = record.phone;
+            getPatientPhone(&patient, &phone);
+            fprintf(patients, "%d|%s|%s|%s\n", record.patientNumber, record.name,
+                    phone.description, phone.number);
+        }
+        else
+        {
+            fprintf(appoints, "%d,%d,%d,%d,%d,%d,%d,%d\n", record.patientNumber,
+                    record.appointment.date.year, record.appointment.date.month,
+                    record.appointment.date.day, record.appointment.time.hour,
+                    record.appointment.time.min, record.appointment.resource,
+                    record.appointment.duration);
+        }
+    }
+    packReaderClose(&reader);
+    if (fclose(patients) != 0 || fclose(appoints) != 0 || result != PACK_END)
+    {
+        printf("ERROR: Writing %s and %s failed\n", patientFile, appointmentFile);
+        return 1;
+    }
+    return 0;
+}
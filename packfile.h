@@ -0,0 +1,160 @@
+// SAFE-GUARD:
+// It is good practice to apply safe-guards to header files
+// Safe-guard's ensures only 1 copy of the header file is used in the project build
+// The macro name should be mirroring the file name with _ for spaces, dots, etc.
+#ifndef PACKFILE_H
+#define PACKFILE_H
+
+#include <stdio.h>
+
+#include "clinic.h"
+
+//////////////////////////////////////
+// Module macro's (usable by any file that includes this header)
+//////////////////////////////////////
+
+// First bytes of every pack file
+#define PACK_MAGIC "VCPACK1\n"
+#define PACK_MAGIC_LEN 8
+
+// packNext results
+#define PACK_PATIENT 1
+#define PACK_APPOINTMENT 2
+#define PACK_END 0  // the end mark was read and the record counts matched
+#define PACK_BAD -1 // not a pack file, corrupt, or cut short
+
+// Bytes read from a pack file at a time
+#define PACK_READ_CHUNK (256 * 1024)
+
+// Largest encoded record (two new dictionary names and a new phone number)
+#define PACK_MAX_RECORD 80
+
+//////////////////////////////////////
+// Pack format
+//////////////////////////////////////
+//
+// PACK_MAGIC, then one record per patient or appointment in any order, then an
+// end mark. All integers are LEB128 varints; signed deltas are zigzag coded.
+//   head  delta of the patient# from the previous record of the same kind << 2 | kind
+//         (kind 1 patient, 2 appointment; a head of 0 is the end mark)
+//   patient      first name code, surname code, phone code
+//   appointment  delta of the day number (days since 1970-01-01) from the previous
+//                appointment, minute of the day, resource, duration
+//   end mark     0, patient count, appointment count
+// A name is split at its last space. Name and phone codes refer to dictionaries
+// built as the file is read: a first name code is 0 for a new entry (length and
+// bytes follow) or 1 + entry; a surname code is 0 for no surname (no space in
+// the name), 1 for a new entry or 2 + entry; a phone code is (0 for a new
+// number, which follows, or 1 + entry) << 2 | contact type.
+
+//////////////////////////////////////
+// Structures
+//////////////////////////////////////
+
+// Data type: a dictionary of names (fixed slots so entries never move)
+struct PackNames
+{
+    char (*entries)[NAME_LEN + 1];
+    int count;
+    int capacity;
+    int *table; // writer: open-addressed index of entries (-1: empty)
+    int tableSize;
+};
+
+// Data type: a dictionary of phone numbers
+struct PackPhones
+{
+    unsigned long long *entries;
+    int count;
+    int capacity;
+    int *table; // writer only
+    int tableSize;
+};
+
+// Data type: the state shared by both directions
+struct PackState
+{
+    struct PackNames firstNames;
+    struct PackNames surnames;
+    struct PackPhones phones;
+    int lastPatient;     // patient# of the previous patient record
+    int lastAppointment; // patient# of the previous appointment record
+    int lastDay;         // day number of the previous appointment record
+    long long patients;
+    long long appointments;
+};
+
+// Data type: writing a pack file
+struct PackWriter
+{
+    FILE *fp;
+    struct PackState state;
+    long long bytes; // written so far
+};
+
+// Data type: reading a pack file record by record
+struct PackReader
+{
+    int fd;
+    struct PackState state;
+    unsigned char *buffer; // PACK_READ_CHUNK + PACK_MAX_RECORD bytes
+    int len;
+    int pos;
+    int eof;
+    long long bytes; // read so far
+};
+
+// Data type: one decoded record
+struct PackRecord
+{
+    int patientNumber;
+    char name[NAME_LEN + 1];        // PACK_PATIENT
+    unsigned long long phone;       // PACK_PATIENT: packed like Patient.phone
+    struct Appointment appointment; // PACK_APPOINTMENT
+};
+
+//////////////////////////////////////
+// WRITER FUNCTIONS
+//////////////////////////////////////
+
+// Create a pack file (returns 0 on failure)
+int packWriterOpen(struct PackWriter *writer, const char *file);
+
+// Add a patient ("phone" packed like Patient.phone) (returns 0 on a write error
+// or a patient number below 1)
+int packPatient(struct PackWriter *writer, int patientNumber, const char *name,
+                unsigned long long phone);
+
+// Add an appointment (returns 0 on a write error or a patient number, date, time,
+// resource or duration the format cannot hold)
+int packAppointment(struct PackWriter *writer, const struct Appointment *appoint);
+
+// Write the end mark and close the file (returns 0 on a write error)
+int packWriterClose(struct PackWriter *writer);
+
+//////////////////////////////////////
+// READER FUNCTIONS
+//////////////////////////////////////
+
+// Open a pack file (returns 0 if it cannot be read or is not a pack file)
+int packReaderOpen(struct PackReader *reader, const char *file);
+
+// Decode the next record (returns PACK_PATIENT / PACK_APPOINTMENT, PACK_END or PACK_BAD)
+int packNext(struct PackReader *reader, struct PackRecord *record);
+
+// Close the file
+void packReaderClose(struct PackReader *reader);
+
+//////////////////////////////////////
+// CONVERSION FUNCTIONS
+//////////////////////////////////////
+
+// Compress data files in the import layouts into a pack file, printing the sizes
+// (returns 0 on success)
+int packDataFiles(const char *patientFile, const char *appointmentFile, const char *packFile);
+
+// Expand a pack file back into the import layouts, printing the decode speed
+// (returns 0 on success)
+int unpackDataFiles(const char *packFile, const char *patientFile, const char *appointmentFile);
+
+#endif // !PACKFILE_H
@@ -0,0 +1,214 @@
+#include <stdlib.h>
+#include <string.h>
+
+// include the user library "pool" where the function prototypes are declared
+#include "pool.h"
+
+//////////////////////////////////////
+// ARENA FUNCTIONS
+//////////////////////////////////////
+
+// Round a size up to the allocation alignment
+static size_t alignSize(size_t size)
+{
+    return (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+}
+
+// Allocate zeroed, ARENA_ALIGN aligned memory (returns NULL when out of memory)
+void *arenaAlloc(struct Arena *arena, size_t size)
+{
+    struct ArenaBlock *block = arena->blocks;
+    size_t header = alignSize(sizeof(struct ArenaBlock));
+    void *memory;
+
+    size = alignSize(size ? size : 1);
+
+    // Blocks double up to ARENA_BLOCK_SIZE so small arenas stay small, and
+    // oversized requests get a block of their own so no block is wasted
+    if (block == NULL || block->size - block->used < size)
+    {
+        size_t blockSize = arena->reserved < ARENA_MIN_BLOCK ? ARENA_MIN_BLOCK : arena->reserved;
+
+        if (blockSize > ARENA_BLOCK_SIZE)
+        {
+            blockSize = ARENA_BLOCK_SIZE;
+        }
+        if (size > blockSize - header)
+        {
+            blockSize = size + header;
+        }
+
+        block = malloc(blockSize);
+        if (block == NULL)
+        {
+            return NULL;
+        }
+        block->size = blockSize - header;
+        block->used = 0;
+        block->next = arena->blocks;
+        arena->blocks = block;
+        arena->reserved += blockSize;
+        arena->blockCount++;
+    }
+
+    memory = (char *)block + header + block->used;
+    block->used += size;
+    arena->requested += size;
+    arena->allocations++;
+    memset(memory, 0, size);
+    return memory;
+}
+
+// Release every block at once
+void arenaRelease(struct Arena *arena)
+{
+    struct ArenaBlock *block = arena->blocks, *next;
+
+    while (block != NULL)
+    {
+        next = block->next;
+        free(block);
+        block = next;
+    }
+    memset(arena, 0, sizeof(*arena));
+}
+
+//////////////////////////////////////
+// SLOT POOL FUNCTIONS
+//////////////////////////////////////
+
+// Set up a slot pool for "capacity" records (returns 1 on success)
+int initSlotPool(struct SlotPool *pool, struct Arena *arena, int capacity)
+{
+    memset(pool, 0, sizeof(*pool));
+    pool->freeSlots = arenaAlloc(arena, sizeof(int) * (capacity ? capacity : 1));
+    pool->liveSlots = arenaAlloc(arena, sizeof(int) * (capacity ? capacity : 1));
+    pool->livePosition = arenaAlloc(arena, sizeof(int) * (capacity ? capacity : 1));
+    if (pool->freeSlots == NULL || pool->liveSlots == NULL || pool->livePosition == NULL)
+    {
+        return 0;
+    }
+    pool->capacity = capacity;
+    resetSlotPool(pool);
+    return 1;
+}
+
+// Take a free slot, the most recently vacated first (returns -1 when full)
+int takeSlot(struct SlotPool *pool)
+{
+    int slot;
+
+    if (pool->freeCount == 0)
+    {
+        return -1;
+    }
+    pool->takes++;
+    slot = pool->freeSlots[--pool->freeCount];
+    addLiveSlot(pool, slot);
+    return slot;
+}
+
+// Return a vacated slot to the pool
+void releaseSlot(struct SlotPool *pool, int slot)
+{
+    int at;
+
+    if (slot < 0 || slot >= pool->capacity || pool->freeCount == pool->capacity)
+    {
+        return;
+    }
+
+    // Swap-remove: the last live slot takes the released one's place
+    at = pool->livePosition[slot];
+    if (at != -1)
+    {
+        pool->liveSlots[at] = pool->liveSlots[--pool->liveCount];
+        pool->livePosition[pool->liveSlots[at]] = at;
+        pool->livePosition[slot] = -1;
+    }
+    pool->freeSlots[pool->freeCount++] = slot;
+    pool->releases++;
+}
+
+// Peek at the slot takeSlot would return (returns -1 when full)
+int peekSlot(const struct SlotPool *pool)
+{
+    return pool->freeCount ? pool->freeSlots[pool->freeCount - 1] : -1;
+}
+
+// Empty both lists before they are rebuilt with addFreeSlot and addLiveSlot
+void resetSlotPool(struct SlotPool *pool)
+{
+    int i;
+
+    pool->freeCount = 0;
+    pool->liveCount = 0;
+    for (i = 0; i < pool->capacity; i++)
+    {
+        pool->livePosition[i] = -1;
+    }
+}
+
+// Add a vacant slot to the free list (the last one added is taken first)
+void addFreeSlot(struct SlotPool *pool, int slot)
+{
+    if (pool->freeCount < pool->capacity)
+    {
+        pool->freeSlots[pool->freeCount++] = slot;
+    }
+}
+
+// Add an occupied slot to the live list
+void addLiveSlot(struct SlotPool *pool, int slot)
+{
+    if (pool->livePosition[slot] == -1 && pool->liveCount < pool->capacity)
+    {
+        pool->livePosition[slot] = pool->liveCount;
+        pool->liveSlots[pool->liveCount++] = slot;
+    }
+}
+
+//////////////////////////////////////
+// NODE POOL FUNCTIONS
+//////////////////////////////////////
+
+// Set up a pool of "nodeSize" byte nodes backed by the arena
+void initNodePool(struct NodePool *pool, struct Arena *arena, size_t nodeSize)
+{
+    memset(pool, 0, sizeof(*pool));
+    pool->arena = arena;
+    pool->nodeSize = nodeSize < sizeof(void *) ? sizeof(void *) : nodeSize;
+}
+
+// Allocate a zeroed node, reusing freed nodes first (returns NULL when out of memory)
+void *allocNode(struct NodePool *pool)
+{
+    void *node = pool->freeList;
+
+    if (node != NULL)
+    {
+        // The first word of a free node links to the next free node
+        memcpy(&pool->freeList, node, sizeof(void *));
+        memset(node, 0, pool->nodeSize);
+        pool->reuses++;
+    }
+    else
+    {
+        node = arenaAlloc(pool->arena, pool->nodeSize);
+        if (node == NULL)
+        {
+            return NULL;
+        }
+    }
+    pool->allocations++;
+    pool->live++;
+    return node;
+}
+
+// Return a node to the pool's free list
+void freeNode(struct NodePool *pool, void *node)
+{
+    memcpy(node, &pool->freeList, sizeof(void *));
+    pool->freeList = node;
+    pool->live--;
+}
@@ -0,0 +1,114 @@
+// SAFE-GUARD:
+// It is good practice to apply safe-guards to header files
+// Safe-guard's ensures only 1 copy of the header file is used in the project build
+// The macro name should be mirroring the file name with _ for spaces, dots, etc.
+#ifndef POOL_H
+#define POOL_H
+
+#include <stddef.h>
+
+//////////////////////////////////////
+// Module macro's (usable by any file that includes this header)
+//////////////////////////////////////
+
+// Arena block sizes (blocks grow geometrically from the minimum) and alignment
+#define ARENA_MIN_BLOCK 4096
+#define ARENA_BLOCK_SIZE (256 * 1024)
+#define ARENA_ALIGN 16
+
+//////////////////////////////////////
+// Structures
+//////////////////////////////////////
+
+// Data type: one block of arena memory
+struct ArenaBlock
+{
+    struct ArenaBlock *next;
+    size_t size;
+    size_t used;
+};
+
+// Data type: bump allocator released in one step
+struct Arena
+{
+    struct ArenaBlock *blocks;
+    size_t requested; // bytes handed out
+    size_t reserved;  // bytes obtained from malloc
+    long long allocations;
+    int blockCount;
+};
+
+// Data type: free list of record slots in a fixed-capacity store, with the
+// occupied slots kept dense so scans cost the live records, not the capacity
+struct SlotPool
+{
+    int *freeSlots;
+    int freeCount;
+    int *liveSlots;    // occupied slots (order changes as slots are released)
+    int *livePosition; // position of each slot in liveSlots (-1: free)
+    int liveCount;
+    int capacity;
+    long long takes;
+    long long releases;
+};
+
+// Data type: free list of fixed-size nodes carved from an arena (schedule tree nodes)
+struct NodePool
+{
+    struct Arena *arena;
+    size_t nodeSize;
+    void *freeList;
+    int live;
+    long long allocations;
+    long long reuses;
+};
+
+//////////////////////////////////////
+// ARENA FUNCTIONS
+//////////////////////////////////////
+
+// Allocate zeroed, ARENA_ALIGN aligned memory (returns NULL when out of memory)
+void *arenaAlloc(struct Arena *arena, size_t size);
+
+// Release every block at once
+void arenaRelease(struct Arena *arena);
+
+//////////////////////////////////////
+// SLOT POOL FUNCTIONS
+//////////////////////////////////////
+
+// Set up a slot pool for "capacity" records (returns 1 on success)
+int initSlotPool(struct SlotPool *pool, struct Arena *arena, int capacity);
+
+// Take a free slot, the most recently vacated first (returns -1 when full)
+int takeSlot(struct SlotPool *pool);
+
+// Return a vacated slot to the pool
+void releaseSlot(struct SlotPool *pool, int slot);
+
+// Peek at the slot takeSlot would return (returns -1 when full)
+int peekSlot(const struct SlotPool *pool);
+
+// Empty both lists before they are rebuilt with addFreeSlot and addLiveSlot
+void resetSlotPool(struct SlotPool *pool);
+
+// Add a vacant slot to the free list (the last one added is taken first)
+void addFreeSlot(struct SlotPool *pool, int slot);
+
+// Add an occupied slot to the live list
+void addLiveSlot(struct SlotPool *pool, int slot);
+
+//////////////////////////////////////
+// NODE POOL FUNCTIONS
+//////////////////////////////////////
+
+// Set up a pool of "nodeSize" byte nodes backed by the arena
+void initNodePool(struct NodePool *pool, struct Arena *arena, size_t nodeSize);
+
+// Allocate a zeroed node, reusing freed nodes first (returns NULL when out of memory)
+void *allocNode(struct NodePool *pool);
+
+// Return a node to the pool's free list
+void freeNode(struct NodePool *pool, void *node);
+
+#endif // !POOL_H
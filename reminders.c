@@ -0,0 +1,371 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// include the user library "clinic" where the store functions are declared
+#include "clinic.h"
+// include the user library "loader" for the parallel import
+#include "loader.h"
+// include the user library "reminders" where the function prototypes are declared
+#include "reminders.h"
+
+//////////////////////////////////////
+// Internal macro's
+//////////////////////////////////////
+
+// Longest reminder line (names are at most IMPORT_FIELD_LEN characters)
+#define REMINDER_LINE_LEN (IMPORT_FIELD_LEN + 64)
+
+// How far ahead in a cursor page the bookings (and, half as far, their
+// patients) are prefetched
+#define PREFETCH_DISTANCE 16
+
+//////////////////////////////////////
+// HELPERS
+//////////////////////////////////////
+
+// Monotonic clock in seconds
+static double nowSeconds(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Build a table of patient slots indexed by patient number - *first when the numbers
+// are dense enough (returns NULL otherwise: look patients up through the index)
+static int *densePatientSlots(const struct ClinicData *data, int *first, int *span)
+{
+    int *slots, i;
+
+    if (data->patientCount == 0)
+    {
+        return NULL;
+    }
+    *first = data->patientOrder[0].patientNumber;
+    *span = data->patientOrder[data->patientCount - 1].patientNumber - *first + 1;
+    if (*span / 4 > data->patientCount)
+    {
+        return NULL;
+    }
+    slots = malloc(sizeof(*slots) * *span);
+    if (slots != NULL)
+    {
+        for (i = 0; i < *span; i++)
+        {
+            slots[i] = -1;
+        }
+        // Walked from the end so a duplicated number keeps its lowest slot
+        for (i = data->patientCount - 1; i >= 0; i--)
+        {
+            slots[data->patientOrder[i].patientNumber - *first] = data->patientOrder[i].slot;
+        }
+    }
+    return slots;
+}
+
+// Write "value" as at least "width" digits (returns the position after them)
+static char *putDigits(char *out, unsigned long long value, int width)
+{
+    char digits[20];
+    int n = 0;
+
+    do
+    {
+        digits[n++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value);
+    while (n < width)
+    {
+        digits[n++] = '0';
+    }
+    while (n)
+    {
+        *out++ = digits[--n];
+    }
+    return out;
+}
+
+// Format one reminder line (returns its length, 0 if the patient has no phone contact)
+static int formatReminder(char *line, const struct Patient *patient,
+                          const struct Appointment *appoint)
+{
+    unsigned long long number = patientPhoneNumber(patient);
+    const char *name, *type;
+    size_t length;
+    char *at = line;
+
+    if (patientPhoneType(patient) == PHONE_TBD || number == PHONE_NO_NUMBER)
+    {
+        return 0;
+    }
+    name = patientName(patient);
+    length = strlen(name);
+    if (length > IMPORT_FIELD_LEN)
+    {
+        length = IMPORT_FIELD_LEN;
+    }
+
+    // Written digit by digit: a million lines through printf would dominate the job
+    at = putDigits(at, (unsigned int)appoint->date.year, 4);
+    *at++ = '-';
+    at = putDigits(at, (unsigned int)appoint->date.month, 2);
+    *at++ = '-';
+    at = putDigits(at, (unsigned int)appoint->date.day, 2);
+    *at++ = '|';
+    at = putDigits(at, (unsigned int)appoint->time.hour, 2);
+    *at++ = ':';
+    at = putDigits(at, (unsigned int)appoint->time.min, 2);
+    *at++ = '|';
+    at = putDigits(at, (unsigned int)patient->patientNumber, 5);
+    *at++ = '|';
+    memcpy(at, name, length);
+    at += length;
+    *at++ = '|';
+    *at++ = '(';
+    at = putDigits(at, number / 10000000, 3);
+    *at++ = ')';
+    at = putDigits(at, number / 10000 % 1000, 3);
+    *at++ = '-';
+    at = putDigits(at, number % 10000, 4);
+    *at++ = '|';
+    type = phoneTypeName(patientPhoneType(patient));
+    length = strlen(type);
+    memcpy(at, type, length);
+    at += length;
+    *at++ = '\n';
+    return (int)(at - line);
+}
+
+// Order of a booking within its day (time, then resource)
+static int timeOrder(const struct Appointment *appoint)
+{
+    return (appoint->time.hour * 60 + appoint->time.min) * (MAX_RESOURCES + 1) + appoint->resource;
+}
+
+// Expand the series occurrences on a day in time order (returns the count)
+static int dayOccurrences(const struct ClinicData *data, int day, struct Appointment occurrences[])
+{
+    const struct Series *rule;
+    struct Appointment occurrence;
+    int i, k, count = 0;
+
+    for (i = 0; i < data->seriesSlots.liveCount; i++)
+    {
+        rule = &data->series[data->seriesSlots.liveSlots[i]];
+        if (seriesOccursOn(rule, day))
+        {
+            seriesOccurrence(rule, day, &occurrence);
+            for (k = count++; k > 0 && timeOrder(&occurrences[k - 1]) > timeOrder(&occurrence); k--)
+            {
+                occurrences[k] = occurrences[k - 1];
+            }
+            occurrences[k] = occurrence;
+        }
+    }
+    return count;
+}
+
+//////////////////////////////////////
+// REMINDER FUNCTIONS
+//////////////////////////////////////
+
+// Write the reminders for every booking from "from" to "to" (inclusive)
+// (returns # of reminders written and sets *skipped to the bookings without a contact)
+int writeReminders(const struct ClinicData *data, const struct Date *from,
+                   const struct Date *to, FILE *out, int *skipped)
+{
+    const struct Appointment *next;
+    struct AppointmentCursor cursor;
+    struct Appointment *occurrences;
+    char *buffer;
+    int *slots, *patientSlots;
+    int first = 0, span = 0;
+    int fromDay = dateToDay(from), toDay = dateToDay(to);
+    int seriesActive = data->seriesSlots.liveCount > 0;
+    int day, at = 0, n = 0, o, occurrenceCount, patient, line, written = 0;
+    size_t length = 0;
+    long long dayEnd;
+
+    *skipped = 0;
+    slots = malloc(sizeof(*slots) * REMINDERS_PAGE);
+    buffer = malloc(REMINDERS_BUFFER);
+    occurrences = malloc(sizeof(*occurrences) *
+                         (data->seriesSlots.liveCount ? data->seriesSlots.liveCount : 1));
+    if (slots == NULL || buffer == NULL || occurrences == NULL)
+    {
+        free(slots);
+        free(buffer);
+        free(occurrences);
+        return -1;
+    }
+
+    // A million binary searches over the patient index cost more than the
+    // rest of the job, so the join goes through a table by patient number
+    patientSlots = densePatientSlots(data, &first, &span);
+
+    // One pass: the bookings come off the interval index in date order and
+    // each day's series occurrences are merged in by time
+    seekAppointmentCursor(&cursor, (long long)fromDay * MINUTES_PER_DAY);
+    for (day = fromDay; day <= toDay; day++)
+    {
+        dayEnd = (long long)(day + 1) * MINUTES_PER_DAY;
+        occurrenceCount = seriesActive ? dayOccurrences(data, day, occurrences) : 0;
+        o = 0;
+        for (;;)
+        {
+            if (at == n)
+            {
+                n = pageAppointments(data, &cursor, slots, REMINDERS_PAGE);
+                at = 0;
+            }
+            // The page is in time order but the records are not: fetch ahead
+            if (at + PREFETCH_DISTANCE < n)
+            {
+                __builtin_prefetch(&data->appointments[slots[at + PREFETCH_DISTANCE]]);
+            }
+            if (patientSlots != NULL && at + PREFETCH_DISTANCE / 2 < n)
+            {
+                patient = data->appointments[slots[at + PREFETCH_DISTANCE / 2]].patientNumber - first;
+                if (patient >= 0 && patient < span && patientSlots[patient] != -1)
+                {
+                    __builtin_prefetch(&data->patients[patientSlots[patient]]);
+                }
+            }
+
+            next = NULL;
+            if (at < n && dateTimeKey(&data->appointments[slots[at]].date,
+                                      &data->appointments[slots[at]].time) < dayEnd)
+            {
+                next = &data->appointments[slots[at]];
+            }
+            if (o < occurrenceCount && (next == NULL || timeOrder(&occurrences[o]) < timeOrder(next)))
+            {
+                next = &occurrences[o++];
+            }
+            else if (next != NULL)
+            {
+                at++;
+            }
+            else
+            {
+                break;
+            }
+
+            if (patientSlots != NULL)
+            {
+                patient = next->patientNumber - first >= 0 && next->patientNumber - first < span
+                              ? patientSlots[next->patientNumber - first]
+                              : -1;
+            }
+            else
+            {
+                patient = findPatientSlot(data, next->patientNumber);
+            }
+            if (patient == -1)
+            {
+                continue;
+            }
+            if (length + REMINDER_LINE_LEN > REMINDERS_BUFFER)
+            {
+                fwrite(buffer, 1, length, out);
+                length = 0;
+            }
+            line = formatReminder(buffer + length, &data->patients[patient], next);
+            if (line == 0)
+            {
+                (*skipped)++;
+            }
+            else
+            {
+                length += line;
+                written++;
+            }
+        }
+
+        // Without series only the days holding bookings need a visit
+        if (!seriesActive)
+        {
+            if (at == n)
+            {
+                break;
+            }
+            day = dateToDay(&data->appointments[slots[at]].date) - 1;
+        }
+    }
+    fwrite(buffer, 1, length, out);
+
+    free(patientSlots);
+    free(slots);
+    free(buffer);
+    free(occurrences);
+    return written;
+}
+
+// Batch job: import the data files and write a date range's reminders to "outFile"
+// ("-" for standard output); prints the timings (returns 0 on success)
+int runReminders(const char *patientFile, const char *appointmentFile,
+                 const struct Date *from, const struct Date *to, const char *outFile)
+{
+    struct ClinicData data;
+    FILE *out, *report = strcmp(outFile, "-") == 0 ? stderr : stdout;
+    double started, loaded, done;
+    int patientCount, appointCount, written, skipped;
+
+    patientCount = countDataRecords(patientFile);
+    appointCount = countDataRecords(appointmentFile);
+    if (patientCount < 0 || appointCount < 0)
+    {
+        fprintf(report, "ERROR: Unable to open the data files\n");
+        return 1;
+    }
+    if (!createClinic(&data, patientCount ? patientCount : 1,
+                      appointCount ? appointCount : 1))
+    {
+        fprintf(report, "ERROR: Out of memory\n");
+        return 1;
+    }
+
+    started = nowSeconds();
+    patientCount = importPatientsParallel(patientFile, data.patients, data.maxPatient, 0);
+    appointCount = importAppointmentsParallel(appointmentFile, data.appointments,
+                                              data.maxAppointments, 0);
+    syncClinicIndexes(&data);
+    loaded = nowSeconds();
+
+    out = strcmp(outFile, "-") == 0 ? stdout : fopen(outFile, "w");
+    if (out == NULL)
+    {
+        fprintf(report, "ERROR: Unable to write %s\n", outFile);
+        destroyClinic(&data);
+        return 1;
+    }
+    written = writeReminders(&data, from, to, out, &skipped);
+    if (out != stdout)
+    {
+        fclose(out);
+    }
+    else
+    {
+        fflush(out);
+    }
+    done = nowSeconds();
+
+    fprintf(report, "Imported %d patient and %d appointment records in %.1f ms\n",
+            patientCount, appointCount, (loaded - started) * 1e3);
+    if (written < 0)
+    {
+        fprintf(report, "ERROR: Out of memory\n");
+    }
+    else
+    {
+        fprintf(report, "Wrote %d reminders for %04d-%02d-%02d..%04d-%02d-%02d to %s in %.1f ms "
+                        "(%d without a phone contact skipped)\n",
+                written, from->year, from->month, from->day, to->year, to->month, to->day,
+                outFile, (done - loaded) * 1e3, skipped);
+    }
+    destroyClinic(&data);
+    return written < 0;
+}
@@ -0,0 +1,47 @@
+// SAFE-GUARD:
+// It is good practice to apply safe-guards to header files
+// Safe-guard's ensures only 1 copy of the header file is used in the project build
+// The macro name should be mirroring the file name with _ for spaces, dots, etc.
+#ifndef REMINDERS_H
+#define REMINDERS_H
+
+#include <stdio.h>
+#include "clinic.h"
+
+//////////////////////////////////////
+// Module macro's (usable by any file that includes this header)
+//////////////////////////////////////
+
+// Default reminders file
+#define REMINDERS_FILE "reminders.txt"
+
+// Bookings read from the interval index per cursor page
+#define REMINDERS_PAGE 4096
+
+// Output buffered before each write
+#define REMINDERS_BUFFER (64 * 1024)
+
+//////////////////////////////////////
+// Reminder format
+//////////////////////////////////////
+//
+// One line per booking, in date and time order, fields separated by '|':
+//   yyyy-mm-dd|hh:mm|patient#|name|(xxx)xxx-xxxx|contact type
+// Recurring series occurrences are included; patients whose contact type is
+// TBD (or who have no number) are skipped.
+
+//////////////////////////////////////
+// REMINDER FUNCTIONS
+//////////////////////////////////////
+
+// Write the reminders for every booking from "from" to "to" (inclusive)
+// (returns # of reminders written and sets *skipped to the bookings without a contact)
+int writeReminders(const struct ClinicData *data, const struct Date *from,
+                   const struct Date *to, FILE *out, int *skipped);
+
+// Batch job: import the data files and write a date range's reminders to "outFile"
+// ("-" for standard output); prints the timings (returns 0 on success)
+int runReminders(const char *patientFile, const char *appointmentFile,
+                 const struct Date *from, const struct Date *to, const char *outFile);
+
+#endif // !REMINDERS_H
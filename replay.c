@@ -0,0 +1,495 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+// include the user library "core" for the input marker
+#include "core.h"
+// include the user library "replay" where the function prototypes are declared
+#include "replay.h"
+
+// Data type: the menus running in a child process
+struct ReplayChild
+{
+    pid_t pid;
+    int input;  // the child's standard input
+    int output; // the child's standard output
+};
+
+// Data type: the timings of every prompt seen
+struct ReplayStats
+{
+    struct ReplayOperation operations[REPLAY_MAX_PROMPTS];
+    int count;
+    long inputs;
+    double seconds; // all runs
+};
+
+//////////////////////////////////////
+// HELPERS
+//////////////////////////////////////
+
+// Monotonic clock in seconds
+static double nowSeconds(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Write all of a buffer (returns 0 on failure)
+static int writeAll(int fd, const char *data, size_t size)
+{
+    ssize_t n;
+
+    while (size > 0)
+    {
+        n = write(fd, data, size);
+        if (n == -1 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n <= 0)
+        {
+            return 0;
+        }
+        data += n;
+        size -= (size_t)n;
+    }
+    return 1;
+}
+
+// Read a whole file into a NUL terminated buffer (returns NULL on failure)
+static char *loadFile(const char *path, long *size)
+{
+    FILE *fp = fopen(path, "rb");
+    char *text = NULL;
+
+    if (fp != NULL && fseek(fp, 0, SEEK_END) == 0 && (*size = ftell(fp)) >= 0 &&
+        fseek(fp, 0, SEEK_SET) == 0 && (text = malloc(*size + 1)) != NULL)
+    {
+        if (fread(text, 1, *size, fp) != (size_t)*size)
+        {
+            free(text);
+            text = NULL;
+        }
+        else
+        {
+            text[*size] = '\0';
+        }
+    }
+    if (fp != NULL)
+    {
+        fclose(fp);
+    }
+    return text;
+}
+
+// Start this program's menus with piped standard input and output (returns 0 on failure)
+static int startChild(struct ReplayChild *child)
+{
+    int toChild[2], fromChild[2];
+
+    if (pipe2(toChild, O_CLOEXEC) == -1)
+    {
+        return 0;
+    }
+    if (pipe2(fromChild, O_CLOEXEC) == -1)
+    {
+        close(toChild[0]);
+        close(toChild[1]);
+        return 0;
+    }
+
+    fflush(stdout);
+    child->pid = fork();
+    if (child->pid == 0)
+    {
+        dup2(toChild[0], STDIN_FILENO);
+        dup2(fromChild[1], STDOUT_FILENO);
+        setenv(INPUT_MARKER_ENV, "1", 1);
+        execl("/proc/self/exe", "vetclinic", (char *)NULL);
+        _exit(127);
+    }
+    close(toChild[0]);
+    close(fromChild[1]);
+    if (child->pid == -1)
+    {
+        close(toChild[1]);
+        close(fromChild[0]);
+        return 0;
+    }
+    child->input = toChild[1];
+    child->output = fromChild[0];
+    return 1;
+}
+
+// Wait for the child to exit, killing it first if "stop" is set (returns its exit
+// status, -1 if it did not exit normally)
+static int finishChild(struct ReplayChild *child, int stop)
+{
+    int status;
+
+    if (child->input != -1)
+    {
+        close(child->input);
+    }
+    if (stop)
+    {
+        kill(child->pid, SIGKILL);
+    }
+    close(child->output);
+    while (waitpid(child->pid, &status, 0) == -1 && errno == EINTR)
+    {
+        ; // retry
+    }
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+// Time one input under the prompt it answered
+static void countOperation(struct ReplayStats *stats, const char *prompt, double seconds)
+{
+    struct ReplayOperation *op = NULL;
+    int i;
+
+    for (i = 0; i < stats->count && op == NULL; i++)
+    {
+        if (strcmp(stats->operations[i].prompt, prompt) == 0)
+        {
+            op = &stats->operations[i];
+        }
+    }
+    if (op == NULL)
+    {
+        op = &stats->operations[stats->count < REPLAY_MAX_PROMPTS ? stats->count++
+                                                                  : REPLAY_MAX_PROMPTS - 1];
+        if (op->count == 0)
+        {
+            strcpy(op->prompt, prompt);
+        }
+    }
+    op->count++;
+    op->total += seconds;
+    if (seconds > op->max)
+    {
+        op->max = seconds;
+    }
+}
+
+// The prompt ending at "at": the text since the start of its line, trimmed
+static void promptBefore(const char *text, long at, char *prompt)
+{
+    long start = at, end = at;
+    int len;
+
+    while (start > 0 && text[start - 1] != '\n')
+    {
+        start--;
+    }
+    while (start < end && text[start] == ' ')
+    {
+        start++;
+    }
+    while (end > start && text[end - 1] == ' ')
+    {
+        end--;
+    }
+    len = end - start > REPLAY_PROMPT_LEN ? REPLAY_PROMPT_LEN : (int)(end - start);
+    memcpy(prompt, text + start, len);
+    prompt[len] = '\0';
+    if (len == 0)
+    {
+        strcpy(prompt, "(blank line)");
+    }
+}
+
+// Line number of a transcript position
+static int lineOf(const char *text, long at)
+{
+    int line = 1;
+    long i;
+
+    for (i = 0; i < at; i++)
+    {
+        line += text[i] == '\n';
+    }
+    return line;
+}
+
+// Report where the output left the transcript: the expected line and the line the
+// clinic printed (what is left of it in "rest")
+static void reportMismatch(const char *text, long at, const char *printed, int printedLen,
+                           const char *rest, int restLen)
+{
+    long start = at, end = at;
+    int i;
+
+    while (start > 0 && text[start - 1] != '\n')
+    {
+        start--;
+    }
+    while (text[end] != '\0' && text[end] != '\n')
+    {
+        end++;
+    }
+    for (i = 0; i < restLen && rest[i] != '\n'; i++)
+    {
+        ; // the printed line goes on up to here
+    }
+    printf("Output differs from the transcript at line %d:\n", lineOf(text, at));
+    printf("  expected: %.*s\n", (int)(end - start), text + start);
+    printf("  got:      %.*s%.*s\n", printedLen, printed, i, rest);
+}
+
+//////////////////////////////////////
+// REPLAY FUNCTIONS
+//////////////////////////////////////
+
+// Replay the transcript once (returns 0 if the output matched)
+static int replayOnce(const char *text, long size, struct ReplayStats *stats, FILE *inputs)
+{
+    struct ReplayChild child;
+    char *chunk = malloc(REPLAY_READ_CHUNK);
+    char prompt[REPLAY_PROMPT_LEN + 1], printed[REPLAY_LINE_LEN];
+    const char *newLine;
+    double started, sent;
+    long at = 0, inputLen;
+    int i, n, printedLen = 0, failed = 0, status;
+
+    // A clinic that exits early must not take this program down with SIGPIPE
+    signal(SIGPIPE, SIG_IGN);
+    if (chunk == NULL || !startChild(&child))
+    {
+        printf("ERROR: Unable to start the clinic\n");
+        free(chunk);
+        return 1;
+    }
+    started = sent = nowSeconds();
+    strcpy(prompt, "(start-up)");
+
+    while (!failed && (n = (int)read(child.output, chunk, REPLAY_READ_CHUNK)) != 0)
+    {
+        if (n == -1)
+        {
+            failed = errno != EINTR;
+            continue;
+        }
+        for (i = 0; i < n && !failed; i++)
+        {
+            if (chunk[i] != INPUT_MARKER)
+            {
+                // Output must follow the transcript byte for byte
+                if (at == size)
+                {
+                    printf("The clinic printed more than the transcript holds (line %d)\n",
+                           lineOf(text, at));
+                    failed = 1;
+                    continue;
+                }
+                if (text[at] != chunk[i])
+                {
+                    reportMismatch(text, at, printed, printedLen, chunk + i, n - i);
+                    failed = 1;
+                    continue;
+                }
+                at++;
+                printedLen = chunk[i] == '\n' ? 0 : printedLen;
+                if (chunk[i] != '\n' && printedLen < REPLAY_LINE_LEN)
+                {
+                    printed[printedLen++] = chunk[i];
+                }
+                continue;
+            }
+
+            // The clinic waits: the rest of the line is what was typed there
+            countOperation(stats, prompt, nowSeconds() - sent);
+            if (at == size)
+            {
+                printf("The transcript ends while the clinic waits for input (line %d)\n",
+                       lineOf(text, at));
+                failed = 1;
+                continue;
+            }
+            promptBefore(text, at, prompt);
+            newLine = memchr(text + at, '\n', size - at);
+            inputLen = newLine != NULL ? newLine - (text + at) + 1 : size - at;
+            if (inputs != NULL)
+            {
+                fwrite(text + at, 1, inputLen, inputs);
+            }
+            sent = nowSeconds();
+            stats->inputs++;
+            if (!writeAll(child.input, text + at, inputLen))
+            {
+                printf("ERROR: The clinic stopped reading input (line %d)\n", lineOf(text, at));
+                failed = 1;
+            }
+            at += inputLen;
+            printedLen = 0;
+            if (newLine == NULL)
+            {
+                // The last line had no end: the clinic finds its input ends there
+                close(child.input);
+                child.input = -1;
+            }
+        }
+    }
+
+    status = finishChild(&child, failed);
+    if (!failed)
+    {
+        countOperation(stats, prompt, nowSeconds() - sent);
+        if (at < size)
+        {
+            printf("The clinic exited at line %d of the transcript's %d\n", lineOf(text, at),
+                   lineOf(text, size));
+            failed = 1;
+        }
+        else if (status != 0)
+        {
+            printf("The clinic exited with status %d\n", status);
+            failed = 1;
+        }
+    }
+    stats->seconds += nowSeconds() - started;
+    free(chunk);
+    return failed;
+}
+
+// Replay a transcript "runs" times against this program's menus, checking the
+// output matches, and print timings per prompt; the extracted input is written
+// to "inputFile" unless it is NULL (returns 0 if every run matched)
+int replayTranscript(const char *transcript, int runs, const char *inputFile)
+{
+    struct ReplayStats *stats = calloc(1, sizeof(*stats));
+    struct ReplayOperation *op;
+    FILE *inputs = NULL;
+    char *text;
+    long size;
+    int run, failed = 0, i;
+
+    text = loadFile(transcript, &size);
+    if (text == NULL || stats == NULL || (long)strlen(text) != size)
+    {
+        printf("ERROR: Unable to read the transcript %s\n", transcript);
+        free(text);
+        free(stats);
+        return 1;
+    }
+    if (inputFile != NULL && (inputs = fopen(inputFile, "w")) == NULL)
+    {
+        printf("ERROR: Unable to create %s\n", inputFile);
+        free(text);
+        free(stats);
+        return 1;
+    }
+
+    for (run = 0; run < runs && !failed; run++)
+    {
+        failed = replayOnce(text, size, stats, run == 0 ? inputs : NULL);
+    }
+    if (inputs != NULL && fclose(inputs) != 0)
+    {
+        printf("ERROR: Writing %s failed\n", inputFile);
+        failed = 1;
+    }
+
+    if (!failed)
+    {
+        printf("Replayed %s %d time(s): %ld inputs, output matched, %.1f ms per run\n\n",
+               transcript, runs, stats->inputs / runs, stats->seconds * 1e3 / runs);
+        printf("%-*s %8s %10s %10s\n", REPLAY_PROMPT_LEN, "Prompt answered", "Count",
+               "Mean(us)", "Max(us)");
+        for (i = 0; i < stats->count; i++)
+        {
+            op = &stats->operations[i];
+            printf("%-*s %8ld %10.1f %10.1f\n", REPLAY_PROMPT_LEN, op->prompt, op->count,
+                   op->total * 1e6 / op->count, op->max * 1e6);
+        }
+    }
+    free(text);
+    free(stats);
+    return failed;
+}
+
+// Run the menus with this program's standard input and output, writing the
+// session to a transcript (returns 0 if the menus exited normally)
+int recordTranscript(const char *transcript)
+{
+    struct ReplayChild child;
+    FILE *out = fopen(transcript, "w");
+    char chunk[REPLAY_READ_CHUNK / 16], line[REPLAY_LINE_LEN + 1];
+    int echo = !isatty(STDIN_FILENO), i, n, status;
+
+    signal(SIGPIPE, SIG_IGN);
+    if (out == NULL || !startChild(&child))
+    {
+        printf("ERROR: Unable to %s\n", out == NULL ? "create the transcript" : "start the clinic");
+        if (out != NULL)
+        {
+            fclose(out);
+        }
+        return 1;
+    }
+
+    while ((n = (int)read(child.output, chunk, sizeof(chunk))) != 0)
+    {
+        if (n == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            break;
+        }
+        for (i = 0; i < n; i++)
+        {
+            if (chunk[i] != INPUT_MARKER)
+            {
+                putchar(chunk[i]);
+                fputc(chunk[i], out);
+                continue;
+            }
+
+            // Pass the next line typed to the clinic, echoing it into the
+            // transcript (and to the screen when it is not typed there)
+            fflush(stdout);
+            if (child.input == -1)
+            {
+                continue;
+            }
+            if (fgets(line, sizeof(line), stdin) == NULL)
+            {
+                close(child.input);
+                child.input = -1;
+                continue;
+            }
+            fputs(line, out);
+            if (echo)
+            {
+                fputs(line, stdout);
+            }
+            if (!writeAll(child.input, line, strlen(line)))
+            {
+                close(child.input);
+                child.input = -1;
+            }
+        }
+    }
+    fflush(stdout);
+
+    status = finishChild(&child, 0);
+    if (fclose(out) != 0)
+    {
+        printf("ERROR: Writing %s failed\n", transcript);
+        return 1;
+    }
+    return status != 0;
+}
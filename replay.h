@@ -0,0 +1,63 @@
+// SAFE-GUARD:
+// It is good practice to apply safe-guards to header files
+// Safe-guard's ensures only 1 copy of the header file is used in the project build
+// The macro name should be mirroring the file name with _ for spaces, dots, etc.
+#ifndef REPLAY_H
+#define REPLAY_H
+
+//////////////////////////////////////
+// Module macro's (usable by any file that includes this header)
+//////////////////////////////////////
+
+// Distinct prompts timed separately (later ones are counted under the last)
+#define REPLAY_MAX_PROMPTS 64
+
+// Characters of a prompt kept as its operation name
+#define REPLAY_PROMPT_LEN 40
+
+// Bytes of clinic output read at a time
+#define REPLAY_READ_CHUNK (64 * 1024)
+
+// Longest input line accepted while recording
+#define REPLAY_LINE_LEN 1024
+
+//////////////////////////////////////
+// Transcripts
+//////////////////////////////////////
+//
+// A transcript is what a terminal shows for one run of the menus: the clinic's
+// output with each typed line echoed where it was typed, i.e. right after the
+// prompt (output.txt is one). The clinic runs as a child of this program, with
+// INPUT_MARKER_ENV set so it marks every point where it waits for input (see
+// core.h). Replaying matches the child's output against the transcript; at each
+// marker the rest of the current transcript line is the input typed there.
+// Output that varies between runs (ADMIN Metrics timings) only replays against
+// a build with CLINIC_NO_METRICS.
+
+//////////////////////////////////////
+// Structures
+//////////////////////////////////////
+
+// Data type: timings of the inputs answering one prompt
+struct ReplayOperation
+{
+    char prompt[REPLAY_PROMPT_LEN + 1];
+    long count;
+    double total; // seconds from sending the input to the next marker
+    double max;
+};
+
+//////////////////////////////////////
+// REPLAY FUNCTIONS
+//////////////////////////////////////
+
+// Replay a transcript "runs" times against this program's menus, checking the
+// output matches, and print timings per prompt; the extracted input is written
+// to "inputFile" unless it is NULL (returns 0 if every run matched)
+int replayTranscript(const char *transcript, int runs, const char *inputFile);
+
+// Run the menus with this program's standard input and output, writing the
+// session to a transcript (returns 0 if the menus exited normally)
+int recordTranscript(const char *transcript);
+
+#endif // !REPLAY_H
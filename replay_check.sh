@@ -0,0 +1,43 @@
+#!/bin/sh
+# Replay output.txt against the current menus, with and without the metrics
+# timers compiled in, from a scratch copy of the data files; then check that
+# the data files round-trip through a pack file and that a corrupt pack is refused.
+# Usage: ./replay_check.sh [runs]   (exits non-zero at the first mismatch)
+
+set -e
+cd "$(dirname "$0")"
+runs=${1:-1}
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+for flags in "" "-DCLINIC_NO_METRICS"; do
+    ${CC:-gcc} -std=gnu11 -O2 -pthread $flags *.c -o "$work/vetclinic"
+    cp patientData.txt appointmentData.txt output.txt "$work"
+    (cd "$work" && ./vetclinic --replay output.txt "$runs" > replay.log) || {
+        cat "$work/replay.log"
+        echo "FAILED: output.txt does not replay (build flags: ${flags:-none})"
+        exit 1
+    }
+    head -n 1 "$work/replay.log"
+done
+echo "output.txt replays on both builds"
+
+# Packing the unpacked text must give back the same pack file
+(cd "$work" && ./vetclinic --pack patientData.txt appointmentData.txt first.pack > pack.log &&
+    ./vetclinic --unpack first.pack patients.txt appointments.txt >> pack.log &&
+    ./vetclinic --pack patients.txt appointments.txt second.pack >> pack.log &&
+    cmp -s first.pack second.pack) || {
+    cat "$work/pack.log"
+    echo "FAILED: the data files do not round-trip through a pack file"
+    exit 1
+}
+
+# One appointment 2000000000 days before 1970 (zigzag varint 3999999999) must be
+# refused, not decoded into a date
+printf 'VCPACK1\n\012\377\317\254\363\016\000\000\036\000\000\001' > "$work/corrupt.pack"
+if (cd "$work" && ./vetclinic --unpack corrupt.pack patients.txt appointments.txt > pack.log); then
+    cat "$work/pack.log"
+    echo "FAILED: a corrupt pack file was unpacked"
+    exit 1
+fi
+echo "the data files round-trip through a pack file and a corrupt one is refused"
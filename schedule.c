@@ -0,0 +1,458 @@
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+// include the user library "pool" for the tree nodes
+#include "pool.h"
+// include the user library "schedule" where the function prototypes are declared
+#include "schedule.h"
+
+//////////////////////////////////////
+// HELPERS
+//////////////////////////////////////
+
+// Order of two bookings (start, then slot)
+static int compareIntervals(const void *a, const void *b)
+{
+    const struct Interval *x = a, *y = b;
+
+    if (x->start != y->start)
+    {
+        return x->start < y->start ? -1 : 1;
+    }
+    return (x->slot > y->slot) - (x->slot < y->slot);
+}
+
+// Next treap priority (xorshift32)
+static unsigned int nextPriority(struct Schedule *schedule)
+{
+    schedule->random ^= schedule->random << 13;
+    schedule->random ^= schedule->random >> 17;
+    schedule->random ^= schedule->random << 5;
+    return schedule->random;
+}
+
+// Recompute a node's latest end from its own and its children's
+static void refreshNode(struct IntervalNode *node)
+{
+    node->maxEnd = node->interval.end;
+    if (node->left != NULL && node->left->maxEnd > node->maxEnd)
+    {
+        node->maxEnd = node->left->maxEnd;
+    }
+    if (node->right != NULL && node->right->maxEnd > node->maxEnd)
+    {
+        node->maxEnd = node->right->maxEnd;
+    }
+}
+
+// Recompute the latest ends from a node up to the root
+static void refreshPath(struct IntervalNode *node)
+{
+    for (; node != NULL; node = node->parent)
+    {
+        refreshNode(node);
+    }
+}
+
+// Put "child" where "node" hangs from its parent (or the root)
+static void replaceChild(struct ResourceIntervals *list, struct IntervalNode *node,
+                         struct IntervalNode *child)
+{
+    if (node->parent == NULL)
+    {
+        list->root = child;
+    }
+    else if (node->parent->left == node)
+    {
+        node->parent->left = child;
+    }
+    else
+    {
+        node->parent->right = child;
+    }
+    if (child != NULL)
+    {
+        child->parent = node->parent;
+    }
+}
+
+// Rotate a node above its parent, keeping the start (then slot) order
+static void rotateUp(struct ResourceIntervals *list, struct IntervalNode *node)
+{
+    struct IntervalNode *parent = node->parent;
+
+    replaceChild(list, parent, node);
+    if (parent->left == node)
+    {
+        parent->left = node->right;
+        if (node->right != NULL)
+        {
+            node->right->parent = parent;
+        }
+        node->right = parent;
+    }
+    else
+    {
+        parent->right = node->left;
+        if (node->left != NULL)
+        {
+            node->left->parent = parent;
+        }
+        node->left = parent;
+    }
+    parent->parent = node;
+    refreshNode(parent);
+    refreshNode(node);
+}
+
+// Build a balanced tree of sorted bookings items[low..high) (returns its root)
+// (priorities fall with depth as in a treap of "total" random priorities, so
+// later insertions keep the tree balanced)
+static struct IntervalNode *buildTree(struct NodePool *nodes, const struct Interval items[],
+                                      int low, int high, int depth, int total)
+{
+    struct IntervalNode *node;
+    double share;
+    int mid;
+
+    if (low >= high)
+    {
+        return NULL;
+    }
+    mid = low + (high - low) / 2;
+    node = allocNode(nodes);
+    if (node == NULL)
+    {
+        return NULL;
+    }
+    node->interval = items[mid];
+    share = ((double)(2ULL << (depth < 62 ? depth : 62)) - 1) / ((double)total + 1);
+    node->priority = share >= 1 ? 0 : (unsigned int)((1 - share) * UINT_MAX);
+    node->left = buildTree(nodes, items, low, mid, depth + 1, total);
+    node->right = buildTree(nodes, items, mid + 1, high, depth + 1, total);
+    if ((node->left == NULL && low < mid) || (node->right == NULL && mid + 1 < high))
+    {
+        return NULL; // out of memory (the nodes already taken go back with the pool)
+    }
+    if (node->left != NULL)
+    {
+        node->left->parent = node;
+    }
+    if (node->right != NULL)
+    {
+        node->right->parent = node;
+    }
+    refreshNode(node);
+    return node;
+}
+
+// Return a subtree's nodes to the pool
+static void freeTree(struct NodePool *nodes, struct IntervalNode *node)
+{
+    struct IntervalNode *right;
+
+    // Left spines are followed by iteration, so only right subtrees recurse
+    while (node != NULL)
+    {
+        freeTree(nodes, node->left);
+        right = node->right;
+        freeNode(nodes, node);
+        node = right;
+    }
+}
+
+//////////////////////////////////////
+// SCHEDULE FUNCTIONS
+//////////////////////////////////////
+
+// Set up an empty schedule for "resourceCount" resources whose nodes come from
+// "nodes" (returns 1 on success)
+int scheduleInit(struct Schedule *schedule, int resourceCount, struct NodePool *nodes)
+{
+    memset(schedule, 0, sizeof(*schedule));
+    schedule->resources = calloc(resourceCount ? resourceCount : 1,
+                                 sizeof(struct ResourceIntervals));
+    if (schedule->resources == NULL)
+    {
+        return 0;
+    }
+    schedule->resourceCount = resourceCount;
+    schedule->nodes = nodes;
+    schedule->random = 2463534242u;
+    return 1;
+}
+
+// Return the schedule's nodes to its pool and release the resource lists
+void scheduleFree(struct Schedule *schedule)
+{
+    int i;
+
+    for (i = 0; i < schedule->resourceCount; i++)
+    {
+        freeTree(schedule->nodes, schedule->resources[i].root);
+        free(schedule->resources[i].pending);
+    }
+    free(schedule->resources);
+    memset(schedule, 0, sizeof(*schedule));
+}
+
+// Add a booking to a resource's tree (returns 1 on success)
+int scheduleInsert(struct Schedule *schedule, int resource, long long start, long long end,
+                   int slot)
+{
+    struct ResourceIntervals *list;
+    struct IntervalNode *node, *parent = NULL, **link;
+
+    if (resource < 0 || resource >= schedule->resourceCount)
+    {
+        return 0;
+    }
+    list = &schedule->resources[resource];
+    node = allocNode(schedule->nodes);
+    if (node == NULL)
+    {
+        return 0;
+    }
+    node->interval.start = start;
+    node->interval.end = end;
+    node->interval.slot = slot;
+    node->maxEnd = end;
+    node->priority = nextPriority(schedule);
+
+    // Down to a leaf in start (then slot) order, then up while the priority allows
+    link = &list->root;
+    while (*link != NULL)
+    {
+        parent = *link;
+        link = compareIntervals(&node->interval, &parent->interval) < 0 ? &parent->left
+                                                                         : &parent->right;
+    }
+    *link = node;
+    node->parent = parent;
+    while (node->parent != NULL && node->priority > node->parent->priority)
+    {
+        rotateUp(list, node);
+    }
+    refreshPath(node->parent);
+    list->count++;
+    return 1;
+}
+
+// Queue a booking for a resource without ordering it yet
+// (bulk loads: call scheduleSort before any lookup; returns 1 on success)
+int scheduleAppend(struct Schedule *schedule, int resource, long long start, long long end,
+                   int slot)
+{
+    struct ResourceIntervals *list;
+    struct Interval *grown;
+    int capacity;
+
+    if (resource < 0 || resource >= schedule->resourceCount)
+    {
+        return 0;
+    }
+    list = &schedule->resources[resource];
+    if (list->pendingCount == list->pendingCapacity)
+    {
+        capacity = list->pendingCapacity ? list->pendingCapacity * 2 : 16;
+        grown = realloc(list->pending, sizeof(*grown) * capacity);
+        if (grown == NULL)
+        {
+            return 0;
+        }
+        list->pending = grown;
+        list->pendingCapacity = capacity;
+    }
+    list->pending[list->pendingCount].start = start;
+    list->pending[list->pendingCount].end = end;
+    list->pending[list->pendingCount].slot = slot;
+    list->pendingCount++;
+    return 1;
+}
+
+// Build every resource's tree from the bookings queued by scheduleAppend
+// (returns 0 on allocation failure)
+int scheduleSort(struct Schedule *schedule)
+{
+    struct ResourceIntervals *list;
+    int i, j, ok = 1;
+
+    for (i = 0; i < schedule->resourceCount; i++)
+    {
+        list = &schedule->resources[i];
+        if (list->pendingCount == 0)
+        {
+            continue;
+        }
+
+        // An empty tree is built balanced from the sorted bookings in O(n)
+        if (list->root == NULL)
+        {
+            qsort(list->pending, list->pendingCount, sizeof(struct Interval),
+                  compareIntervals);
+            list->root = buildTree(schedule->nodes, list->pending, 0, list->pendingCount, 0,
+                                   list->pendingCount);
+            if (list->root == NULL)
+            {
+                ok = 0;
+            }
+            else
+            {
+                list->count = list->pendingCount;
+            }
+        }
+        else
+        {
+            for (j = 0; j < list->pendingCount; j++)
+            {
+                ok &= scheduleInsert(schedule, i, list->pending[j].start, list->pending[j].end,
+                                     list->pending[j].slot);
+            }
+        }
+        free(list->pending);
+        list->pending = NULL;
+        list->pendingCount = list->pendingCapacity = 0;
+    }
+    return ok;
+}
+
+// Remove the booking of "slot" starting at "start" from a resource's tree
+// (returns 0 if the resource holds no such booking)
+int scheduleRemove(struct Schedule *schedule, int resource, long long start, int slot)
+{
+    struct ResourceIntervals *list;
+    struct IntervalNode *node, *child;
+    struct Interval key;
+    int order;
+
+    if (resource < 0 || resource >= schedule->resourceCount)
+    {
+        return 0;
+    }
+    list = &schedule->resources[resource];
+    key.start = start;
+    key.slot = slot;
+    node = list->root;
+    while (node != NULL && (order = compareIntervals(&key, &node->interval)) != 0)
+    {
+        node = order < 0 ? node->left : node->right;
+    }
+    if (node == NULL)
+    {
+        return 0;
+    }
+
+    // Rotate the node down below its higher priority child until it has at most one
+    while (node->left != NULL && node->right != NULL)
+    {
+        rotateUp(list, node->left->priority > node->right->priority ? node->left : node->right);
+    }
+    child = node->left != NULL ? node->left : node->right;
+    replaceChild(list, node, child);
+    refreshPath(node->parent);
+    freeNode(schedule->nodes, node);
+    list->count--;
+    return 1;
+}
+
+// Slot of the earliest booking on the resource overlapping [start, end) (returns -1 if none)
+int scheduleConflict(const struct Schedule *schedule, int resource, long long start,
+                     long long end)
+{
+    const struct IntervalNode *node;
+
+    if (resource < 0 || resource >= schedule->resourceCount)
+    {
+        return -1;
+    }
+
+    // If the left subtree reaches past "start", any overlap at all has one
+    // there: its latest ending booking starts no later than everything to
+    // the right, so if that one starts too late, so do they
+    node = schedule->resources[resource].root;
+    while (node != NULL)
+    {
+        if (node->left != NULL && node->left->maxEnd > start)
+        {
+            node = node->left;
+        }
+        else if (node->interval.start >= end)
+        {
+            return -1;
+        }
+        else if (node->interval.end > start)
+        {
+            return node->interval.slot;
+        }
+        else
+        {
+            node = node->right;
+        }
+    }
+    return -1;
+}
+
+// Lowest resource with [start, end) free (returns -1 if every resource is busy)
+int scheduleFreeResource(const struct Schedule *schedule, long long start, long long end)
+{
+    int resource;
+
+    for (resource = 0; resource < schedule->resourceCount; resource++)
+    {
+        if (scheduleConflict(schedule, resource, start, end) == -1)
+        {
+            return resource;
+        }
+    }
+    return -1;
+}
+
+// First booking of a resource starting at or after "from", in start (then slot)
+// order (returns NULL if there is none; walk on with scheduleNext)
+const struct Interval *scheduleFirst(const struct Schedule *schedule, int resource,
+                                     long long from)
+{
+    const struct IntervalNode *node, *found = NULL;
+
+    if (resource < 0 || resource >= schedule->resourceCount)
+    {
+        return NULL;
+    }
+    node = schedule->resources[resource].root;
+    while (node != NULL)
+    {
+        if (node->interval.start >= from)
+        {
+            found = node;
+            node = node->left;
+        }
+        else
+        {
+            node = node->right;
+        }
+    }
+    return found != NULL ? &found->interval : NULL;
+}
+
+// Booking following "item" on its resource (returns NULL after the last)
+const struct Interval *scheduleNext(const struct Interval *item)
+{
+    const struct IntervalNode *node = (const struct IntervalNode *)item;
+
+    // The leftmost node of the right subtree, else the first ancestor reached from its left
+    if (node->right != NULL)
+    {
+        node = node->right;
+        while (node->left != NULL)
+        {
+            node = node->left;
+        }
+        return &node->interval;
+    }
+    while (node->parent != NULL && node->parent->right == node)
+    {
+        node = node->parent;
+    }
+    return node->parent != NULL ? &node->parent->interval : NULL;
+}
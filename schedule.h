@@ -0,0 +1,96 @@
+// SAFE-GUARD:
+// It is good practice to apply safe-guards to header files
+// Safe-guard's ensures only 1 copy of the header file is used in the project build
+// The macro name should be mirroring the file name with _ for spaces, dots, etc.
+#ifndef SCHEDULE_H
+#define SCHEDULE_H
+
+#include "pool.h"
+
+//////////////////////////////////////
+// Structures
+//////////////////////////////////////
+
+// Data type: one booking on a resource, in minutes since 1970-01-01 00:00
+struct Interval
+{
+    long long start;
+    long long end; // exclusive
+    int slot;      // appointment store slot
+};
+
+// Data type: a booking in a resource's tree (a treap ordered by start, then slot)
+struct IntervalNode
+{
+    struct Interval interval; // first, so a node can be handed out as its interval
+    struct IntervalNode *left;
+    struct IntervalNode *right;
+    struct IntervalNode *parent;
+    long long maxEnd;      // latest end in this subtree (finds overlaps in O(log n))
+    unsigned int priority; // heap order: no child has a higher priority
+};
+
+// Data type: one resource's bookings (lookups, bookings and cancellations are
+// O(log n); overlapping bookings, e.g. from imported data, are still found)
+struct ResourceIntervals
+{
+    struct IntervalNode *root;
+    int count;
+    struct Interval *pending; // scheduleAppend bookings waiting for scheduleSort
+    int pendingCount;
+    int pendingCapacity;
+};
+
+// Data type: interval index of every bookable resource (vet or exam room)
+struct Schedule
+{
+    struct ResourceIntervals *resources;
+    int resourceCount;
+    struct NodePool *nodes; // where the tree nodes come from and go back to
+    unsigned int random;    // treap priorities
+};
+
+//////////////////////////////////////
+// SCHEDULE FUNCTIONS
+//////////////////////////////////////
+
+// Set up an empty schedule for "resourceCount" resources whose nodes come from
+// "nodes" (returns 1 on success)
+int scheduleInit(struct Schedule *schedule, int resourceCount, struct NodePool *nodes);
+
+// Return the schedule's nodes to its pool and release the resource lists
+void scheduleFree(struct Schedule *schedule);
+
+// Add a booking to a resource's tree (returns 1 on success)
+int scheduleInsert(struct Schedule *schedule, int resource, long long start, long long end,
+                   int slot);
+
+// Queue a booking for a resource without ordering it yet
+// (bulk loads: call scheduleSort before any lookup; returns 1 on success)
+int scheduleAppend(struct Schedule *schedule, int resource, long long start, long long end,
+                   int slot);
+
+// Build every resource's tree from the bookings queued by scheduleAppend
+// (returns 0 on allocation failure)
+int scheduleSort(struct Schedule *schedule);
+
+// Remove the booking of "slot" starting at "start" from a resource's tree
+// (returns 0 if the resource holds no such booking)
+int scheduleRemove(struct Schedule *schedule, int resource, long long start, int slot);
+
+// Slot of the earliest booking on the resource overlapping [start, end) (returns -1 if none)
+int scheduleConflict(const struct Schedule *schedule, int resource, long long start,
+                     long long end);
+
+// Lowest resource with [start, end) free (returns -1 if every resource is busy)
+int scheduleFreeResource(const struct Schedule *schedule, long long start, long long end);
+
+// First booking of a resource starting at or after "from", in start (then slot)
+// order (returns NULL if there is none; walk on with scheduleNext)
+const struct Interval *scheduleFirst(const struct Schedule *schedule, int resource,
+                                     long long from);
+
+// Booking following "item" on its resource (returns NULL after the last)
+const struct Interval *scheduleNext(const struct Interval *item);
+
+#endif // !SCHEDULE_H
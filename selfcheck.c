@@ -0,0 +1,420 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// include the user library "clinic" where the store functions are declared
+#include "clinic.h"
+// include the user library "changefeed" for the change records applied
+#include "changefeed.h"
+// include the user library "selfcheck" where the function prototypes are declared
+#include "selfcheck.h"
+
+// Operation kinds, in the order of the mix below
+#define CHECK_PUT_PATIENT 0
+#define CHECK_REMOVE_PATIENT 1
+#define CHECK_BOOK 2
+#define CHECK_CANCEL 3
+#define CHECK_FIND_PATIENT 4
+#define CHECK_FIND_APPOINTMENT 5
+#define CHECK_HOUSEHOLD 6
+#define CHECK_KINDS 7
+
+// Data type: the state of one run
+struct SelfCheck
+{
+    struct ClinicData data;
+    unsigned long long random;
+    long operation; // index of the operation being checked
+    long counts[CHECK_KINDS];
+    long sorts;
+    int *slots;     // householdMembers / reference results
+    int *expected;
+    struct Appointment *sorted;    // sortData result
+    struct Appointment *reference; // insertion sort result
+};
+
+static const char *const firstNames[] = {"Shaggy", "Pugsley", "Beans", "Banjo", "Lettuce",
+                                         "Bullet", "Nugget", "Bessie", "Potato", "Alfie"};
+static const char *const surnames[] = {"Yanson", "Maulin", "Codi", "Peas", "Lemme", "Smee"};
+static const char *const kindNames[] = {"put patient",      "remove patient",
+                                        "book",             "cancel",
+                                        "find patient",     "find appointment",
+                                        "household lookup"};
+
+//////////////////////////////////////
+// RANDOM HELPERS
+//////////////////////////////////////
+
+// Next random number (xorshift64*)
+static unsigned long long nextRandom(struct SelfCheck *check)
+{
+    check->random ^= check->random >> 12;
+    check->random ^= check->random << 25;
+    check->random ^= check->random >> 27;
+    return check->random * 0x2545F4914F6CDD1DULL;
+}
+
+// Random number in 0..n-1
+static int randomBelow(struct SelfCheck *check, int n)
+{
+    return (int)(nextRandom(check) % (unsigned long long)n);
+}
+
+// Random patient number: about half of them in use at any time
+static int randomPatientNumber(struct SelfCheck *check)
+{
+    return 1 + randomBelow(check, check->data.maxPatient);
+}
+
+// Random day of the booking window
+static void randomDate(struct SelfCheck *check, struct Date *date)
+{
+    struct Date first = {2024, 2, 20};
+
+    dayToDate(dateToDay(&first) + randomBelow(check, SELFCHECK_DAYS), date);
+}
+
+//////////////////////////////////////
+// REFERENCE IMPLEMENTATIONS
+//////////////////////////////////////
+
+// Order of two appointments by date and time, field by field
+static int compareByFields(const struct Appointment *a, const struct Appointment *b)
+{
+    if (a->date.year != b->date.year)
+    {
+        return a->date.year - b->date.year;
+    }
+    if (a->date.month != b->date.month)
+    {
+        return a->date.month - b->date.month;
+    }
+    if (a->date.day != b->date.day)
+    {
+        return a->date.day - b->date.day;
+    }
+    if (a->time.hour != b->time.hour)
+    {
+        return a->time.hour - b->time.hour;
+    }
+    return a->time.min - b->time.min;
+}
+
+// Stable insertion sort of the live appointments to the front, empty records after
+static void referenceSort(struct Appointment appoints[], int max)
+{
+    struct Appointment moving;
+    int i, j, count = 0;
+
+    for (i = 0; i < max; i++)
+    {
+        if (appoints[i].patientNumber > 0)
+        {
+            moving = appoints[i];
+            for (j = count; j > 0 && compareByFields(&appoints[j - 1], &moving) > 0; j--)
+            {
+                appoints[j] = appoints[j - 1];
+            }
+            appoints[j] = moving;
+            count++;
+        }
+    }
+    memset(&appoints[count], 0, sizeof(*appoints) * (max - count));
+}
+
+// Store slots of the patient's household by scanning the whole store: the patients
+// sharing its phone number and surname, in patient number order (returns the count)
+static int referenceHousehold(const struct ClinicData *data, int slot, int slots[])
+{
+    const struct Patient *patient = &data->patients[slot], *other;
+    const char *name = patientName(patient), *surname = strrchr(name, ' '), *otherSurname;
+    int i, j, count = 0, moving;
+
+    if (patientPhoneNumber(patient) == PHONE_NO_NUMBER)
+    {
+        slots[0] = slot;
+        return 1;
+    }
+    surname = surname != NULL ? surname + 1 : name;
+    for (i = 0; i < data->maxPatient; i++)
+    {
+        other = &data->patients[i];
+        if (other->patientNumber <= 0 || patientPhoneNumber(other) != patientPhoneNumber(patient))
+        {
+            continue;
+        }
+        otherSurname = strrchr(patientName(other), ' ');
+        otherSurname = otherSurname != NULL ? otherSurname + 1 : patientName(other);
+        if (strcmp(otherSurname, surname) == 0)
+        {
+            moving = i;
+            for (j = count; j > 0 && data->patients[slots[j - 1]].patientNumber >
+                                         other->patientNumber;
+                 j--)
+            {
+                slots[j] = slots[j - 1];
+            }
+            slots[j] = moving;
+            count++;
+        }
+    }
+    return count;
+}
+
+//////////////////////////////////////
+// CHECKS
+//////////////////////////////////////
+
+// Report a disagreement (returns 0 so callers can return it)
+static int disagree(struct SelfCheck *check, const char *what, long reference, long indexed)
+{
+    printf("MISMATCH at operation %ld (%s): reference %ld, index %ld\n", check->operation + 1,
+           what, reference, indexed);
+    return 0;
+}
+
+// Apply one random change (returns 1: changes are not checked themselves)
+static int randomChange(struct SelfCheck *check, int kind)
+{
+    struct ChangeRecord change;
+    struct Phone phone;
+    char name[NAME_LEN + 1];
+
+    memset(&change, 0, sizeof(change));
+    if (kind == CHECK_PUT_PATIENT)
+    {
+        change.kind = CHANGE_PATIENT_PUT;
+        change.patient.patientNumber = randomPatientNumber(check);
+        sprintf(name, "%s %s", firstNames[randomBelow(check, 10)],
+                surnames[randomBelow(check, 6)]);
+        setPatientName(&change.patient, name);
+        strcpy(phone.description, randomBelow(check, 2) ? "CELL" : "HOME");
+
+        // A small pool of numbers so households form; some patients have none
+        if (randomBelow(check, 8) == 0)
+        {
+            phone.number[0] = '\0';
+        }
+        else
+        {
+            snprintf(phone.number, sizeof(phone.number), "555%07d",
+                     randomBelow(check, check->data.maxPatient / 4 + 1));
+        }
+        setPatientPhone(&change.patient, &phone);
+    }
+    else if (kind == CHECK_REMOVE_PATIENT)
+    {
+        change.kind = CHANGE_PATIENT_REMOVE;
+        change.patient.patientNumber = randomPatientNumber(check);
+    }
+    else
+    {
+        change.kind = kind == CHECK_BOOK ? CHANGE_APPOINTMENT_ADD : CHANGE_APPOINTMENT_REMOVE;
+        change.appointment.patientNumber = randomPatientNumber(check);
+        randomDate(check, &change.appointment.date);
+        change.appointment.time.hour = START_HOUR + randomBelow(check, END_HOUR - START_HOUR);
+        change.appointment.time.min = randomBelow(check, 60 / MINUTE_INTERVAL) * MINUTE_INTERVAL;
+        change.appointment.resource = RESOURCE_ANY;
+        change.appointment.duration = MINUTE_INTERVAL * (1 + randomBelow(check, 2));
+    }
+    applyClinicChange(&check->data, &change);
+    return 1;
+}
+
+// Look up a random patient both ways (returns 0 on a disagreement)
+static int checkFindPatient(struct SelfCheck *check)
+{
+    int number = randomPatientNumber(check);
+    int reference = findPatientIndexByPatientNum(number, check->data.patients,
+                                                 check->data.maxPatient);
+    int indexed = findPatientSlot(&check->data, number);
+
+    return reference == indexed || disagree(check, "findPatientSlot", reference, indexed);
+}
+
+// Look up a random patient's appointment on a random day both ways (returns 0 on a
+// disagreement)
+static int checkFindAppointment(struct SelfCheck *check)
+{
+    struct Date date;
+    int number = randomPatientNumber(check), reference, indexed;
+
+    randomDate(check, &date);
+    reference = checkAppointment(number, date, check->data.appointments,
+                                 check->data.maxAppointments);
+    indexed = findPatientAppointment(&check->data, number, &date);
+    return reference == indexed || disagree(check, "findPatientAppointment", reference, indexed);
+}
+
+// Look up a random patient's household both ways (returns 0 on a disagreement)
+static int checkHousehold(struct SelfCheck *check)
+{
+    int number = randomPatientNumber(check);
+    int slot = findPatientSlot(&check->data, number), count, expected, i;
+
+    if (slot == -1)
+    {
+        count = findPatientHousehold(&check->data, number, check->slots, check->data.maxPatient);
+        return count == 0 || disagree(check, "findPatientHousehold (no patient)", 0, count);
+    }
+    expected = referenceHousehold(&check->data, slot, check->expected);
+    count = findPatientHousehold(&check->data, number, check->slots, check->data.maxPatient);
+    if (count != expected)
+    {
+        return disagree(check, "findPatientHousehold size", expected, count);
+    }
+    for (i = 0; i < count; i++)
+    {
+        if (check->slots[i] != check->expected[i])
+        {
+            return disagree(check, "findPatientHousehold member", check->expected[i],
+                            check->slots[i]);
+        }
+    }
+    return 1;
+}
+
+// Compare sortData with the reference sort, and the number index and next patient
+// number with the store (returns 0 on a disagreement)
+static int checkSortAndCounts(struct SelfCheck *check)
+{
+    const struct ClinicData *data = &check->data;
+    size_t size = sizeof(*data->appointments) * data->maxAppointments;
+    int i, live = 0, highest = 0, count;
+
+    memcpy(check->sorted, data->appointments, size);
+    memcpy(check->reference, data->appointments, size);
+    count = sortData(check->sorted, data->maxAppointments);
+    referenceSort(check->reference, data->maxAppointments);
+    if (count == -1)
+    {
+        printf("ERROR: Out of memory\n");
+        return 0;
+    }
+    for (i = 0; i < data->maxAppointments; i++)
+    {
+        if (memcmp(&check->sorted[i], &check->reference[i], sizeof(check->sorted[i])) != 0)
+        {
+            return disagree(check, "sortData record at position", i, i);
+        }
+        live += check->reference[i].patientNumber > 0;
+    }
+    if (count != live)
+    {
+        return disagree(check, "sortData count", live, count);
+    }
+
+    live = 0;
+    for (i = 0; i < data->maxPatient; i++)
+    {
+        if (data->patients[i].patientNumber > 0)
+        {
+            live++;
+            highest = data->patients[i].patientNumber > highest ? data->patients[i].patientNumber
+                                                                : highest;
+        }
+    }
+    if (live != data->patientCount)
+    {
+        return disagree(check, "patientCount", live, data->patientCount);
+    }
+    if (highest + 1 != nextPatientNumber(data))
+    {
+        return disagree(check, "nextPatientNumber", highest + 1, nextPatientNumber(data));
+    }
+    check->sorts++;
+    return 1;
+}
+
+//////////////////////////////////////
+// SELF-CHECK FUNCTIONS
+//////////////////////////////////////
+
+// Run "operations" random operations from "seed" on a clinic of "patients" slots,
+// stopping at the first disagreement (returns 0 if every check agreed)
+int runSelfCheck(long operations, unsigned long long seed, int patients)
+{
+    // Changes and queries in roughly equal parts
+    static const int mix[] = {CHECK_PUT_PATIENT,      CHECK_REMOVE_PATIENT, CHECK_BOOK,
+                              CHECK_BOOK,             CHECK_CANCEL,         CHECK_FIND_PATIENT,
+                              CHECK_FIND_APPOINTMENT, CHECK_HOUSEHOLD};
+    struct SelfCheck *check = calloc(1, sizeof(*check));
+    clock_t started = clock();
+    int kind, ok = 1, i;
+
+    if (check == NULL || patients < 1 ||
+        !createClinic(&check->data, patients, patients * 2))
+    {
+        printf("ERROR: Unable to create the clinic\n");
+        free(check);
+        return 1;
+    }
+    setClinicResources(&check->data, SELFCHECK_RESOURCES);
+    check->random = seed ? seed : 1;
+    check->slots = malloc(sizeof(*check->slots) * patients);
+    check->expected = malloc(sizeof(*check->expected) * patients);
+    check->sorted = malloc(sizeof(*check->sorted) * patients * 2);
+    check->reference = malloc(sizeof(*check->reference) * patients * 2);
+    if (check->slots == NULL || check->expected == NULL || check->sorted == NULL ||
+        check->reference == NULL)
+    {
+        printf("ERROR: Out of memory\n");
+        ok = 0;
+    }
+
+    printf("Self-check: %ld operations, seed %llu, %d patient and %d appointment slots\n",
+           operations, seed, patients, patients * 2);
+    for (check->operation = 0; ok && check->operation < operations; check->operation++)
+    {
+        kind = mix[randomBelow(check, sizeof(mix) / sizeof(mix[0]))];
+        switch (kind)
+        {
+        case CHECK_FIND_PATIENT:
+            ok = checkFindPatient(check);
+            break;
+        case CHECK_FIND_APPOINTMENT:
+            ok = checkFindAppointment(check);
+            break;
+        case CHECK_HOUSEHOLD:
+            ok = checkHousehold(check);
+            break;
+        default:
+            ok = randomChange(check, kind);
+            break;
+        }
+        check->counts[kind]++;
+        if (ok && (check->operation + 1) % SELFCHECK_SORT_EVERY == 0)
+        {
+            ok = checkSortAndCounts(check);
+        }
+    }
+    if (ok)
+    {
+        ok = checkSortAndCounts(check);
+    }
+
+    if (ok)
+    {
+        for (i = 0; i < CHECK_KINDS; i++)
+        {
+            printf("  %-18s %10ld\n", kindNames[i], check->counts[i]);
+        }
+        printf("  %-18s %10ld\n", "sort + counts", check->sorts);
+        printf("All checks agreed (%.2f s, %d patients and %d appointments at the end)\n",
+               (double)(clock() - started) / CLOCKS_PER_SEC, check->data.patientCount,
+               check->data.appointmentSlots.liveCount);
+    }
+    else
+    {
+        printf("Rerun with: --selfcheck %ld %llu %d\n", check->operation, seed, patients);
+    }
+
+    destroyClinic(&check->data);
+    free(check->slots);
+    free(check->expected);
+    free(check->sorted);
+    free(check->reference);
+    free(check);
+    return !ok;
+}
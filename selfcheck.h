@@ -0,0 +1,44 @@
+// SAFE-GUARD:
+// It is good practice to apply safe-guards to header files
+// Safe-guard's ensures only 1 copy of the header file is used in the project build
+// The macro name should be mirroring the file name with _ for spaces, dots, etc.
+#ifndef SELFCHECK_H
+#define SELFCHECK_H
+
+//////////////////////////////////////
+// Module macro's (usable by any file that includes this header)
+//////////////////////////////////////
+
+// Defaults: operations run, and patient slots (appointment slots are twice that)
+#define SELFCHECK_OPERATIONS 1000000
+#define SELFCHECK_PATIENTS 512
+
+// Resources the checked clinic schedules side by side
+#define SELFCHECK_RESOURCES 2
+
+// Days the random bookings fall on (few enough for bookings to collide)
+#define SELFCHECK_DAYS 20
+
+// Operations between full sort and index consistency checks
+#define SELFCHECK_SORT_EVERY 1000
+
+//////////////////////////////////////
+// SELF-CHECK FUNCTIONS
+//////////////////////////////////////
+//
+// Random patient puts and removals and appointment bookings and cancellations
+// are applied to one clinic through applyClinicChange, interleaved with queries
+// answered twice: by the reference linear scans over the stores and by the
+// indexes the menus use. Each pair must agree:
+//   findPatientIndexByPatientNum    findPatientSlot (number index)
+//   checkAppointment                findPatientAppointment (interval index)
+//   phone/surname scan of the store findPatientHousehold (household index)
+//   highest number in the store     nextPatientNumber
+//   stable insertion sort by field  sortData (keyed qsort)
+// Build with -fsanitize=address,undefined to check memory safety as well.
+
+// Run "operations" random operations from "seed" on a clinic of "patients" slots,
+// stopping at the first disagreement (returns 0 if every check agreed)
+int runSelfCheck(long operations, unsigned long long seed, int patients);
+
+#endif // !SELFCHECK_H
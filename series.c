@@ -0,0 +1,84 @@
+// include the user library "clinic" for the Series/Appointment types
+#include "clinic.h"
+// include the user library "series" where the function prototypes are declared
+#include "series.h"
+
+//////////////////////////////////////
+// SERIES FUNCTIONS
+//////////////////////////////////////
+
+// Day number of the first occurrence
+int seriesFirstDay(const struct Series *series)
+{
+    return dateToDay(&series->start);
+}
+
+// Day number of the last possible occurrence (SERIES_OPEN_END if unbounded)
+int seriesLastDay(const struct Series *series)
+{
+    if (series->count > 0)
+    {
+        return seriesFirstDay(series) + (series->count - 1) * series->everyDays;
+    }
+    if (series->until.year > 0)
+    {
+        return dateToDay(&series->until);
+    }
+    return SERIES_OPEN_END;
+}
+
+// Check if the series has an occurrence on a day number (returns 1 if it does)
+int seriesOccursOn(const struct Series *series, int day)
+{
+    int first = seriesFirstDay(series);
+
+    return day >= first && day <= seriesLastDay(series) &&
+           (day - first) % series->everyDays == 0;
+}
+
+// First occurrence on or after a day number (returns -1 if the series has ended)
+int seriesNextDay(const struct Series *series, int day)
+{
+    int first = seriesFirstDay(series);
+
+    if (day < first)
+    {
+        day = first;
+    }
+    else
+    {
+        day = first + (day - first + series->everyDays - 1) / series->everyDays * series->everyDays;
+    }
+    return day <= seriesLastDay(series) ? day : -1;
+}
+
+// First day on which both series have an occurrence (returns -1 if none)
+int seriesCommonDay(const struct Series *a, const struct Series *b)
+{
+    int day = seriesFirstDay(a) > seriesFirstDay(b) ? seriesFirstDay(a) : seriesFirstDay(b);
+    int last = seriesLastDay(a) < seriesLastDay(b) ? seriesLastDay(a) : seriesLastDay(b);
+    int steps;
+
+    // a's occurrences repeat modulo b's interval within b->everyDays steps,
+    // so if none of those lands on b, none ever will
+    day = seriesNextDay(a, day);
+    for (steps = 0; day != -1 && day <= last && steps < b->everyDays; steps++)
+    {
+        if (seriesOccursOn(b, day))
+        {
+            return day;
+        }
+        day = seriesNextDay(a, day + 1);
+    }
+    return -1;
+}
+
+// Materialize the occurrence on a day number as an appointment
+void seriesOccurrence(const struct Series *series, int day, struct Appointment *appoint)
+{
+    appoint->patientNumber = series->patientNumber;
+    dayToDate(day, &appoint->date);
+    appoint->time = series->time;
+    appoint->resource = series->resource;
+    appoint->duration = series->duration;
+}
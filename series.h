@@ -0,0 +1,46 @@
+// SAFE-GUARD:
+// It is good practice to apply safe-guards to header files
+// Safe-guard's ensures only 1 copy of the header file is used in the project build
+// The macro name should be mirroring the file name with _ for spaces, dots, etc.
+#ifndef SERIES_H
+#define SERIES_H
+
+struct Series;
+struct Appointment;
+
+//////////////////////////////////////
+// Module macro's (usable by any file that includes this header)
+//////////////////////////////////////
+
+// Last day of a series without a count or end date
+#define SERIES_OPEN_END (1 << 30)
+
+// Longest gap between occurrences (days)
+#define SERIES_MAX_EVERY 3660
+
+// Most occurrences of a counted series
+#define SERIES_MAX_COUNT 9999
+
+//////////////////////////////////////
+// SERIES FUNCTIONS
+//////////////////////////////////////
+
+// Day number of the first occurrence
+int seriesFirstDay(const struct Series *series);
+
+// Day number of the last possible occurrence (SERIES_OPEN_END if unbounded)
+int seriesLastDay(const struct Series *series);
+
+// Check if the series has an occurrence on a day number (returns 1 if it does)
+int seriesOccursOn(const struct Series *series, int day);
+
+// First occurrence on or after a day number (returns -1 if the series has ended)
+int seriesNextDay(const struct Series *series, int day);
+
+// First day on which both series have an occurrence (returns -1 if none)
+int seriesCommonDay(const struct Series *a, const struct Series *b);
+
+// Materialize the occurrence on a day number as an appointment
+void seriesOccurrence(const struct Series *series, int day, struct Appointment *appoint);
+
+#endif // !SERIES_H
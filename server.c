@@ -0,0 +1,1280 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <ctype.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+// include the user library "clinic" where the store functions are declared
+#include "clinic.h"
+// include the user library "shard" for the partitioned store
+#include "shard.h"
+// include the user library "metrics" for the operation timers
+#include "metrics.h"
+// include the user library "server" where the function prototypes are declared
+#include "server.h"
+
+//////////////////////////////////////
+// Internal structures
+//////////////////////////////////////
+
+// Growable byte buffer used for connection input and output
+struct Buffer
+{
+    char *data;
+    int len;
+    int cap;
+};
+
+// A client connection
+struct Connection
+{
+    int fd;
+    struct Buffer in;
+    struct Buffer out;
+    int outPos;
+    int readClosed;      // the client has sent everything (EOF read)
+    unsigned int events; // epoll events registered for the socket
+};
+
+// A background export (one at a time)
+struct ExportJob
+{
+    struct ClinicShards *shards;
+    char patientFile[sizeof(SERVER_EXPORT_DIR) + SERVER_MAX_LINE];
+    char appointmentFile[sizeof(SERVER_EXPORT_DIR) + SERVER_MAX_LINE];
+    pthread_t thread;
+    int started;
+    atomic_int running;
+};
+
+static volatile sig_atomic_t stopRequested = 0;
+static struct ExportJob exportJob;
+
+//////////////////////////////////////
+// BUFFER FUNCTIONS
+//////////////////////////////////////
+
+// Make room for at least "extra" more bytes (returns 0 on allocation failure)
+static int bufferReserve(struct Buffer *buf, int extra)
+{
+    char *grown;
+    int cap = buf->cap ? buf->cap : 1024;
+
+    if (buf->len + extra <= buf->cap)
+    {
+        return 1;
+    }
+    while (cap < buf->len + extra)
+    {
+        cap *= 2;
+    }
+    grown = realloc(buf->data, cap);
+    if (grown == NULL)
+    {
+        return 0;
+    }
+    buf->data = grown;
+    buf->cap = cap;
+    return 1;
+}
+
+// Append a formatted string to the buffer
+static void bufferPrintf(struct Buffer *buf, const char *fmt, ...)
+{
+    va_list args;
+    int written;
+
+    if (!bufferReserve(buf, SERVER_MAX_LINE))
+    {
+        return;
+    }
+    va_start(args, fmt);
+    written = vsnprintf(buf->data + buf->len, buf->cap - buf->len, fmt, args);
+    va_end(args);
+
+    if (written >= buf->cap - buf->len)
+    {
+        if (!bufferReserve(buf, written + 1))
+        {
+            return;
+        }
+        va_start(args, fmt);
+        vsnprintf(buf->data + buf->len, buf->cap - buf->len, fmt, args);
+        va_end(args);
+    }
+    buf->len += written;
+}
+
+//////////////////////////////////////
+// REQUEST FUNCTIONS
+//////////////////////////////////////
+
+// Append a patient record in the patientData.txt layout
+static void appendPatient(struct Buffer *out, const struct Patient *patient)
+{
+    struct Phone phone;
+
+    getPatientPhone(patient, &phone);
+    bufferPrintf(out, "%d|%s|%s|%s\n", patient->patientNumber, patientName(patient),
+                 phone.description, phone.number);
+}
+
+// Append an appointment record in the appointmentData.txt layout
+static void appendAppointment(struct Buffer *out, const struct Appointment *appoint)
+{
+    bufferPrintf(out, "%d,%d,%d,%d,%d,%d,%d,%d\n", appoint->patientNumber,
+                 appoint->date.year, appoint->date.month, appoint->date.day,
+                 appoint->time.hour, appoint->time.min,
+                 appoint->resource, appoint->duration);
+}
+
+// P <patient#>
+static void requestPatient(struct ClinicShards *shards, const char *args, struct Buffer *out)
+{
+    struct Patient patient;
+    int patientNumber;
+
+    if (sscanf(args, "%d", &patientNumber) != 1 || patientNumber <= 0)
+    {
+        bufferPrintf(out, "ERR Value must be > 0\n");
+        return;
+    }
+    if (findShardedPatient(shards, patientNumber, &patient) == -1)
+    {
+        bufferPrintf(out, "OK 0\n");
+    }
+    else
+    {
+        bufferPrintf(out, "OK 1\n");
+        appendPatient(out, &patient);
+    }
+}
+
+// F <phone#>
+static void requestPhone(struct ClinicShards *shards, const char *args, struct Buffer *out)
+{
+    char phone[PHONE_LEN + 1] = {0};
+    struct Patient local[SERVER_MAX_MATCHES], *matches = local;
+    int i, total;
+
+    if (sscanf(args, "%10s", phone) != 1 || strlen(phone) != PHONE_LEN)
+    {
+        bufferPrintf(out, "ERR Invalid %d-digit number!\n", PHONE_LEN);
+        return;
+    }
+
+    total = searchShardsByPhone(shards, phone, local, SERVER_MAX_MATCHES);
+    if (total > SERVER_MAX_MATCHES)
+    {
+        matches = malloc(sizeof(*matches) * total);
+        if (matches == NULL)
+        {
+            bufferPrintf(out, "ERR Out of memory\n");
+            return;
+        }
+        total = searchShardsByPhone(shards, phone, matches, total);
+    }
+
+    bufferPrintf(out, "OK %d\n", total);
+    for (i = 0; i < total; i++)
+    {
+        appendPatient(out, &matches[i]);
+    }
+    if (matches != local)
+    {
+        free(matches);
+    }
+}
+
+// Check a requested search start: a real date within the calendar's reach on
+// the appointment grid (returns 1 if usable, else appends the error and returns 0)
+static int checkSearchStart(const struct Date *date, const struct Time *time,
+                            struct Buffer *out)
+{
+    if (!isValidDate(date) || date->year > CALENDAR_MAX_YEAR)
+    {
+        bufferPrintf(out, "ERR Invalid date!\n");
+        return 0;
+    }
+    if (!isValidAppointmentTime(time))
+    {
+        bufferPrintf(out, "ERR Time must be between %02d:00 and %02d:00 in %02d minute intervals.\n",
+                     START_HOUR, END_HOUR, MINUTE_INTERVAL);
+        return 0;
+    }
+    return 1;
+}
+
+// D <year> <month> <day>
+static void requestDay(struct ClinicShards *shards, const char *args, struct Buffer *out)
+{
+    struct Appointment local[SERVER_MAX_MATCHES], *day = local;
+    struct Date date;
+    int i, total;
+
+    if (sscanf(args, "%d %d %d", &date.year, &date.month, &date.day) != 3)
+    {
+        bufferPrintf(out, "ERR Expected: D <year> <month> <day>\n");
+        return;
+    }
+    if (!isValidDate(&date))
+    {
+        bufferPrintf(out, "ERR Invalid date!\n");
+        return;
+    }
+
+    total = shardDaySchedule(shards, &date, local, SERVER_MAX_MATCHES);
+    if (total > SERVER_MAX_MATCHES)
+    {
+        day = malloc(sizeof(*day) * total);
+        if (day == NULL)
+        {
+            bufferPrintf(out, "ERR Out of memory\n");
+            return;
+        }
+        total = shardDaySchedule(shards, &date, day, total);
+    }
+
+    bufferPrintf(out, "OK %d\n", total);
+    for (i = 0; i < total; i++)
+    {
+        appendAppointment(out, &day[i]);
+    }
+    if (day != local)
+    {
+        free(day);
+    }
+}
+
+// B <patient#> <year> <month> <day> <hour> <min> [resource] [minutes]
+static void requestBook(struct ClinicShards *shards, const char *args, struct Buffer *out)
+{
+    struct Appointment appoint = {0};
+
+    appoint.resource = RESOURCE_ANY;
+    if (sscanf(args, "%d %d %d %d %d %d %d %d", &appoint.patientNumber,
+               &appoint.date.year, &appoint.date.month, &appoint.date.day,
+               &appoint.time.hour, &appoint.time.min,
+               &appoint.resource, &appoint.duration) < 6)
+    {
+        bufferPrintf(out, "ERR Expected: B <patient#> <y> <m> <d> <hh> <mm> [resource] [minutes]\n");
+        return;
+    }
+
+    switch (bookShardedAppointment(shards, &appoint))
+    {
+    case BOOK_OK:
+        bufferPrintf(out, "OK 0\n");
+        break;
+    case BOOK_NO_PATIENT:
+        bufferPrintf(out, "ERR Patient record not found!\n");
+        break;
+    case BOOK_BAD_TIME:
+        bufferPrintf(out, "ERR Time must be between %02d:00 and %02d:00 in %02d minute intervals.\n",
+                     START_HOUR, END_HOUR, MINUTE_INTERVAL);
+        break;
+    case BOOK_SLOT_TAKEN:
+        bufferPrintf(out, "ERR Appointment timeslot is not available!\n");
+        break;
+    case BOOK_BAD_DATE:
+        bufferPrintf(out, "ERR Invalid date!\n");
+        break;
+    case BOOK_BAD_RESOURCE:
+        bufferPrintf(out, "ERR Resource not found!\n");
+        break;
+    default:
+        bufferPrintf(out, "ERR Appointment listing is FULL!\n");
+        break;
+    }
+}
+
+// N <patient#> <year> <month> <day> <hour> <min> [slots]
+static void requestNextFree(struct ClinicShards *shards, const char *args, struct Buffer *out)
+{
+    struct Date date, found;
+    struct Time time, foundTime;
+    int patientNumber, count = 1;
+
+    if (sscanf(args, "%d %d %d %d %d %d %d", &patientNumber, &date.year, &date.month,
+               &date.day, &time.hour, &time.min, &count) < 6)
+    {
+        bufferPrintf(out, "ERR Expected: N <patient#> <y> <m> <d> <hh> <mm> [slots]\n");
+        return;
+    }
+    if (!checkSearchStart(&date, &time, out))
+    {
+        return;
+    }
+
+    switch (shardNextTimeslot(shards, patientNumber, &date, &time, count, &found, &foundTime))
+    {
+    case -1:
+        bufferPrintf(out, "ERR Patient record not found!\n");
+        break;
+    case 0:
+        bufferPrintf(out, "OK 0\n");
+        break;
+    default:
+        bufferPrintf(out, "OK 1\n%d,%d,%d,%d,%d\n", found.year, found.month, found.day,
+                     foundTime.hour, foundTime.min);
+        break;
+    }
+}
+
+// A <patient#> <year> <month> <day> <hour> <min> [minutes]
+static void requestFreeResource(struct ClinicShards *shards, const char *args,
+                                struct Buffer *out)
+{
+    struct Date date;
+    struct Time time;
+    int patientNumber, minutes = MINUTE_INTERVAL, resource;
+
+    if (sscanf(args, "%d %d %d %d %d %d %d", &patientNumber, &date.year, &date.month,
+               &date.day, &time.hour, &time.min, &minutes) < 6)
+    {
+        bufferPrintf(out, "ERR Expected: A <patient#> <y> <m> <d> <hh> <mm> [minutes]\n");
+        return;
+    }
+    if (!checkSearchStart(&date, &time, out))
+    {
+        return;
+    }
+
+    switch (shardFreeResource(shards, patientNumber, &date, &time, minutes, &resource))
+    {
+    case -1:
+        bufferPrintf(out, "ERR Patient record not found!\n");
+        break;
+    case 0:
+        bufferPrintf(out, "OK 0\n");
+        break;
+    default:
+        bufferPrintf(out, "OK 1\n%d\n", resource);
+        break;
+    }
+}
+
+// Clamp a listing page size to 1..SERVER_MAX_PAGE
+static int pageSize(int count)
+{
+    return count < 1 ? 1 : count > SERVER_MAX_PAGE ? SERVER_MAX_PAGE : count;
+}
+
+// L <after#> [count]
+static void requestPatientPage(struct ClinicShards *shards, const char *args,
+                               struct Buffer *out)
+{
+    struct Patient *page;
+    int i, n, after, count = SERVER_PAGE_SIZE;
+
+    if (sscanf(args, "%d %d", &after, &count) < 1 || after < 0)
+    {
+        bufferPrintf(out, "ERR Expected: L <after#> [count]\n");
+        return;
+    }
+    count = pageSize(count);
+    page = malloc(sizeof(*page) * count);
+    n = page != NULL ? shardPagePatients(shards, after, page, count) : -1;
+    if (n == -1)
+    {
+        bufferPrintf(out, "ERR Out of memory\n");
+    }
+    else
+    {
+        bufferPrintf(out, "OK %d %d\n", n, n ? page[n - 1].patientNumber : after);
+        for (i = 0; i < n; i++)
+        {
+            appendPatient(out, &page[i]);
+        }
+    }
+    free(page);
+}
+
+// V <token> [count]
+static void requestAppointmentPage(struct ClinicShards *shards, const char *args,
+                                   struct Buffer *out)
+{
+    struct Appointment *page;
+    struct ShardCursor cursor;
+    char token[SERVER_MAX_LINE] = {0};
+    int i, n, count = SERVER_PAGE_SIZE;
+
+    // The token is the last row's position: start:resource:shard:slot
+    startShardCursor(&cursor);
+    if (sscanf(args, "%255s %d", token, &count) < 1 ||
+        (strcmp(token, "-") != 0 &&
+         sscanf(token, "%lld:%d:%d:%d", &cursor.at.start, &cursor.at.resource,
+                &cursor.shard, &cursor.at.slot) != 4))
+    {
+        bufferPrintf(out, "ERR Expected: V <token> [count]\n");
+        return;
+    }
+    count = pageSize(count);
+    page = malloc(sizeof(*page) * count);
+    n = page != NULL ? shardPageAppointments(shards, &cursor, page, count) : -1;
+    if (n == -1)
+    {
+        bufferPrintf(out, "ERR Out of memory\n");
+    }
+    else
+    {
+        if (cursor.shard == -1)
+        {
+            bufferPrintf(out, "OK %d -\n", n);
+        }
+        else
+        {
+            bufferPrintf(out, "OK %d %lld:%d:%d:%d\n", n, cursor.at.start, cursor.at.resource,
+                         cursor.shard, cursor.at.slot);
+        }
+        for (i = 0; i < n; i++)
+        {
+            appendAppointment(out, &page[i]);
+        }
+    }
+    free(page);
+}
+
+// S D <y> <m> <d> | S M <y> <m> | S P <patient#>
+static void requestStats(struct ClinicShards *shards, const char *args, struct Buffer *out)
+{
+    struct Date date = {0};
+    char kind = 0;
+    int fields = sscanf(args, " %c %d %d %d", &kind, &date.year, &date.month, &date.day);
+
+    if (kind == 'D' && fields == 4)
+    {
+        bufferPrintf(out, "OK 1\n%lld\n",
+                     shardStatsCount(shards, statsDayCount, dateToDay(&date)));
+    }
+    else if (kind == 'M' && fields >= 3)
+    {
+        bufferPrintf(out, "OK 1\n%lld\n",
+                     shardStatsCount(shards, statsMonthCount,
+                                     STATS_MONTH(date.year, date.month)));
+    }
+    else if (kind == 'P' && fields >= 2)
+    {
+        bufferPrintf(out, "OK 1\n%lld\n", shardStatsCount(shards, statsPatientCount, date.year));
+    }
+    else
+    {
+        bufferPrintf(out, "ERR Expected: S D <y> <m> <d> | S M <y> <m> | S P <patient#>\n");
+    }
+}
+
+// Thread body: write the export files from the shards' snapshots
+static void *runExport(void *arg)
+{
+    struct ExportJob *job = arg;
+    int total;
+
+    // Without an appointment file the export is one pack file
+    if (job->appointmentFile[0] == '\0')
+    {
+        total = exportShardPack(job->shards, job->patientFile);
+    }
+    else
+    {
+        total = exportShardSnapshots(job->shards, job->patientFile, job->appointmentFile);
+    }
+    if (total == -1)
+    {
+        printf("ERROR: Export to %s%s%s failed\n", job->patientFile,
+               job->appointmentFile[0] ? " and " : "", job->appointmentFile);
+    }
+    else
+    {
+        printf("Exported %d patient(s) to %s%s%s\n", total, job->patientFile,
+               job->appointmentFile[0] ? " and " : "", job->appointmentFile);
+    }
+    fflush(stdout);
+    atomic_store(&job->running, 0);
+    return NULL;
+}
+
+// Wait for the last export to finish
+static void joinExport(struct ExportJob *job)
+{
+    if (job->started)
+    {
+        pthread_join(job->thread, NULL);
+        job->started = 0;
+    }
+}
+
+// Check that an export file name names a file directly in SERVER_EXPORT_DIR
+// (no directories, no "..", no hidden files; returns 1 if it does)
+static int isExportName(const char *name)
+{
+    int i;
+
+    if (name[0] == '\0' || name[0] == '.')
+    {
+        return 0;
+    }
+    for (i = 0; name[i] != '\0'; i++)
+    {
+        if (!isalnum((unsigned char)name[i]) && strchr("._-", name[i]) == NULL)
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// X <patientFile> <appointmentFile> | X <packFile>
+static void requestExport(struct ClinicShards *shards, const char *args, struct Buffer *out)
+{
+    struct ExportJob *job = &exportJob;
+    char patientName[SERVER_MAX_LINE], appointmentName[SERVER_MAX_LINE] = "";
+    int files;
+
+    if (atomic_load(&job->running))
+    {
+        bufferPrintf(out, "ERR Export already running\n");
+        return;
+    }
+    joinExport(job);
+    files = sscanf(args, " %255s %255s", patientName, appointmentName);
+    if (files < 1)
+    {
+        bufferPrintf(out, "ERR Expected: X <patientFile> <appointmentFile> | X <packFile>\n");
+        return;
+    }
+
+    // Any client may export, so it only names files inside the export directory
+    if (!isExportName(patientName) || (files == 2 && !isExportName(appointmentName)))
+    {
+        bufferPrintf(out, "ERR Export files must be plain names (letters, digits, '.', '_', '-')\n");
+        return;
+    }
+    if (mkdir(SERVER_EXPORT_DIR, 0755) != 0 && errno != EEXIST)
+    {
+        bufferPrintf(out, "ERR Unable to create the export directory\n");
+        return;
+    }
+    snprintf(job->patientFile, sizeof(job->patientFile), "%s/%s", SERVER_EXPORT_DIR,
+             patientName);
+    job->appointmentFile[0] = '\0';
+    if (files == 2)
+    {
+        snprintf(job->appointmentFile, sizeof(job->appointmentFile), "%s/%s",
+                 SERVER_EXPORT_DIR, appointmentName);
+    }
+
+    // The export reads snapshots on its own thread, so requests keep being served
+    job->shards = shards;
+    atomic_store(&job->running, 1);
+    job->started = pthread_create(&job->thread, NULL, runExport, job) == 0;
+    if (!job->started)
+    {
+        atomic_store(&job->running, 0);
+        bufferPrintf(out, "ERR Unable to start the export\n");
+        return;
+    }
+    bufferPrintf(out, "OK 0\n");
+}
+
+// Dispatch a single request line
+static void handleRequest(struct ClinicShards *shards, const char *line, struct Buffer *out)
+{
+    const char *args = line[0] ? line + 1 : line;
+    METRIC_START(started);
+
+    switch (line[0])
+    {
+    case 'P':
+        requestPatient(shards, args, out);
+        break;
+    case 'F':
+        requestPhone(shards, args, out);
+        break;
+    case 'D':
+        requestDay(shards, args, out);
+        break;
+    case 'B':
+        requestBook(shards, args, out);
+        break;
+    case 'N':
+        requestNextFree(shards, args, out);
+        break;
+    case 'A':
+        requestFreeResource(shards, args, out);
+        break;
+    case 'L':
+        requestPatientPage(shards, args, out);
+        break;
+    case 'V':
+        requestAppointmentPage(shards, args, out);
+        break;
+    case 'S':
+        requestStats(shards, args, out);
+        break;
+    case 'X':
+        requestExport(shards, args, out);
+        break;
+    default:
+        bufferPrintf(out, "ERR Unknown request\n");
+        break;
+    }
+    METRIC_STOP(METRIC_REQUEST, started);
+}
+
+//////////////////////////////////////
+// SOCKET FUNCTIONS
+//////////////////////////////////////
+
+// Create a socket bound (listen != 0) or connected to the address (returns fd or -1)
+static int openSocket(const char *address, int listening)
+{
+    int fd = -1, rc, one = 1;
+
+    if (address[0] == '/' || address[0] == '.')
+    {
+        struct sockaddr_un un = {0};
+
+        un.sun_family = AF_UNIX;
+        strncpy(un.sun_path, address, sizeof(un.sun_path) - 1);
+        fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd == -1)
+        {
+            return -1;
+        }
+        if (listening)
+        {
+            unlink(address);
+            rc = bind(fd, (struct sockaddr *)&un, sizeof(un));
+        }
+        else
+        {
+            rc = connect(fd, (struct sockaddr *)&un, sizeof(un));
+        }
+    }
+    else
+    {
+        struct sockaddr_in in = {0};
+
+        in.sin_family = AF_INET;
+        in.sin_port = htons((unsigned short)atoi(address));
+        in.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd == -1)
+        {
+            return -1;
+        }
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        if (listening)
+        {
+            setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+            rc = bind(fd, (struct sockaddr *)&in, sizeof(in));
+        }
+        else
+        {
+            rc = connect(fd, (struct sockaddr *)&in, sizeof(in));
+        }
+    }
+
+    if (rc == 0 && listening)
+    {
+        rc = listen(fd, SOMAXCONN);
+    }
+    if (rc != 0)
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Release a connection and its buffers
+static void closeConnection(int epfd, struct Connection *conn)
+{
+    epoll_ctl(epfd, EPOLL_CTL_DEL, conn->fd, NULL);
+    close(conn->fd);
+    free(conn->in.data);
+    free(conn->out.data);
+    free(conn);
+}
+
+// Output queued for a connection and not yet written
+static int pendingOutput(const struct Connection *conn)
+{
+    return conn->out.len - conn->outPos;
+}
+
+// Register the events the connection waits for: input while the client still sends
+// and its queued output is under SERVER_MAX_PENDING, output while some is queued
+static void watchConnection(int epfd, struct Connection *conn)
+{
+    struct epoll_event ev = {0};
+
+    if (!conn->readClosed && pendingOutput(conn) < SERVER_MAX_PENDING &&
+        conn->in.len < SERVER_MAX_PENDING)
+    {
+        ev.events |= EPOLLIN;
+    }
+    if (pendingOutput(conn) > 0)
+    {
+        ev.events |= EPOLLOUT;
+    }
+    if (ev.events != conn->events)
+    {
+        ev.data.ptr = conn;
+        epoll_ctl(epfd, EPOLL_CTL_MOD, conn->fd, &ev);
+        conn->events = ev.events;
+    }
+}
+
+// Write as much queued output as the socket accepts (returns 0 on error)
+static int flushConnection(struct Connection *conn)
+{
+    ssize_t n;
+
+    while (pendingOutput(conn) > 0)
+    {
+        n = write(conn->fd, conn->out.data + conn->outPos, pendingOutput(conn));
+        if (n > 0)
+        {
+            conn->outPos += (int)n;
+        }
+        else if (n == -1 && errno == EINTR)
+        {
+            continue;
+        }
+        else if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            break;
+        }
+        else
+        {
+            return 0;
+        }
+    }
+
+    // Keep the unsent output at the front so the buffer stays within its cap
+    // (nothing was sent, or even allocated, when outPos is 0)
+    if (conn->outPos > 0)
+    {
+        memmove(conn->out.data, conn->out.data + conn->outPos, pendingOutput(conn));
+        conn->out.len -= conn->outPos;
+        conn->outPos = 0;
+    }
+    return 1;
+}
+
+// Read what the client has sent while there is room for the answers (returns 0 on error)
+static int readConnection(struct Connection *conn)
+{
+    ssize_t n;
+
+    while (!conn->readClosed && pendingOutput(conn) < SERVER_MAX_PENDING &&
+           conn->in.len < SERVER_MAX_PENDING)
+    {
+        if (!bufferReserve(&conn->in, SERVER_READ_CHUNK))
+        {
+            return 0;
+        }
+        n = read(conn->fd, conn->in.data + conn->in.len, SERVER_READ_CHUNK);
+        if (n > 0)
+        {
+            conn->in.len += (int)n;
+        }
+        else if (n == 0)
+        {
+            conn->readClosed = 1;
+        }
+        else if (errno == EINTR)
+        {
+            continue;
+        }
+        else if (errno == EAGAIN || errno == EWOULDBLOCK)
+        {
+            break;
+        }
+        else
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// Answer the complete requests read so far, stopping once SERVER_MAX_PENDING output
+// is queued (returns the number answered, -1 if a request line is too long)
+static int answerRequests(struct ClinicShards *shards, struct Connection *conn)
+{
+    int start = 0, i, answered = 0;
+
+    // Pipelining: every complete line in the buffer is a request
+    for (i = 0; i < conn->in.len && pendingOutput(conn) < SERVER_MAX_PENDING; i++)
+    {
+        if (conn->in.data[i] == '\n')
+        {
+            conn->in.data[i] = '\0';
+            if (i > start && conn->in.data[i - 1] == '\r')
+            {
+                conn->in.data[i - 1] = '\0';
+            }
+            handleRequest(shards, conn->in.data + start, &conn->out);
+            start = i + 1;
+            answered++;
+        }
+    }
+    if (i == conn->in.len && conn->in.len - start > SERVER_MAX_LINE)
+    {
+        return -1;
+    }
+    memmove(conn->in.data, conn->in.data + start, conn->in.len - start);
+    conn->in.len -= start;
+    return answered;
+}
+
+// Read, answer and write as far as the client keeps up (returns 0 to close)
+static int serviceConnection(struct ClinicShards *shards, int epfd, struct Connection *conn)
+{
+    int answered;
+
+    // A client that sends but does not read stops being read once its
+    // answers fill SERVER_MAX_PENDING, until it drains them
+    do
+    {
+        // Answers are written first, so requests held back at the cap are
+        // answered as soon as the client drains them
+        if (!flushConnection(conn) || !readConnection(conn))
+        {
+            return 0;
+        }
+        answered = answerRequests(shards, conn);
+        if (answered == -1 || !flushConnection(conn))
+        {
+            return 0;
+        }
+    } while (answered > 0 && pendingOutput(conn) < SERVER_MAX_PENDING);
+
+    // After EOF only the queued answers are left to send
+    if (conn->readClosed && pendingOutput(conn) == 0)
+    {
+        return 0;
+    }
+    watchConnection(epfd, conn);
+    return 1;
+}
+
+static void onStopSignal(int sig)
+{
+    (void)sig;
+    stopRequested = 1;
+}
+
+// Serve the clinic data on the address until SIGINT/SIGTERM (returns 0 on clean exit)
+int runServer(struct ClinicShards *shards, const char *address)
+{
+    struct epoll_event ev = {0}, events[SERVER_MAX_EVENTS];
+    struct sigaction sa = {0};
+    int listenFd, epfd, ready, i;
+
+    listenFd = openSocket(address, 1);
+    if (listenFd == -1)
+    {
+        printf("ERROR: Unable to listen on %s (%s)\n", address, strerror(errno));
+        return 1;
+    }
+    fcntl(listenFd, F_SETFL, fcntl(listenFd, F_GETFL) | O_NONBLOCK);
+
+    epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (epfd == -1)
+    {
+        close(listenFd);
+        return 1;
+    }
+    ev.events = EPOLLIN;
+    ev.data.ptr = NULL; // NULL marks the listening socket
+    epoll_ctl(epfd, EPOLL_CTL_ADD, listenFd, &ev);
+
+    sa.sa_handler = onStopSignal;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    printf("Serving clinic data on %s (%d shard(s))...\n", address, shards->count);
+    fflush(stdout);
+
+    while (!stopRequested)
+    {
+        ready = epoll_wait(epfd, events, SERVER_MAX_EVENTS, -1);
+        if (ready == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            break;
+        }
+
+        for (i = 0; i < ready; i++)
+        {
+            struct Connection *conn = events[i].data.ptr;
+
+            if (conn == NULL)
+            {
+                int fd;
+
+                while ((fd = accept4(listenFd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC)) != -1)
+                {
+                    conn = calloc(1, sizeof(*conn));
+                    if (conn == NULL)
+                    {
+                        close(fd);
+                        continue;
+                    }
+                    conn->fd = fd;
+                    conn->events = ev.events = EPOLLIN;
+                    ev.data.ptr = conn;
+                    epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev);
+                }
+            }
+            else if (events[i].events & (EPOLLERR | EPOLLHUP) &&
+                     !(events[i].events & EPOLLIN))
+            {
+                closeConnection(epfd, conn);
+            }
+            else if (!serviceConnection(shards, epfd, conn))
+            {
+                closeConnection(epfd, conn);
+            }
+        }
+    }
+
+    close(epfd);
+    close(listenFd);
+    joinExport(&exportJob);
+    for (i = 0; i < shards->count; i++)
+    {
+        printf("Shard %d: ", i);
+        displayClinicMemory(&shards->shards[i].data);
+    }
+    metricsReport(stdout);
+    if (address[0] == '/' || address[0] == '.')
+    {
+        unlink(address);
+    }
+    printf("Server stopped.\n");
+    return 0;
+}
+
+//////////////////////////////////////
+// LOAD GENERATOR FUNCTIONS
+//////////////////////////////////////
+
+// Monotonic clock in nanoseconds
+static long long nowNanos(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// Compare function for qsort on latencies
+static int compareLatency(const void *a, const void *b)
+{
+    long long x = *(const long long *)a, y = *(const long long *)b;
+
+    return (x > y) - (x < y);
+}
+
+// A load generator client: its requests in flight and their send times
+struct LoadClient
+{
+    int fd;
+    struct Buffer out;
+    int outPos;
+    struct Buffer in;
+    int scanned;          // bytes of "in" already split into lines
+    int recordsLeft;      // record lines still due for the current response
+    long long *sentAt;    // ring of "depth" send times, oldest first
+    int oldest;
+    int inFlight;
+    unsigned int events;
+};
+
+// Queue one request of the read-only mix and note when it was sent
+static void queueLoadRequest(struct LoadClient *client, int depth, unsigned int *seed)
+{
+    unsigned int r = (*seed = *seed * 1103515245u + 12345u) >> 8;
+
+    // Mix: 70% patient lookups, 20% phone searches, 10% day schedules
+    if (r % 10 < 7)
+    {
+        bufferPrintf(&client->out, "P %u\n", 1024 + (r / 10) % 256 * 8);
+    }
+    else if (r % 10 < 9)
+    {
+        bufferPrintf(&client->out, "F %010u\n", 3048005191u - (r / 10) % 4);
+    }
+    else
+    {
+        bufferPrintf(&client->out, "D 2024 2 %u\n", 20 + (r / 10) % 10);
+    }
+    client->sentAt[(client->oldest + client->inFlight) % depth] = nowNanos();
+    client->inFlight++;
+}
+
+// Write as much queued output as the socket accepts (returns 0 on error)
+static int flushLoadClient(struct LoadClient *client)
+{
+    ssize_t n;
+
+    while (client->outPos < client->out.len)
+    {
+        n = write(client->fd, client->out.data + client->outPos,
+                  client->out.len - client->outPos);
+        if (n > 0)
+        {
+            client->outPos += (int)n;
+        }
+        else if (n == -1 && errno == EINTR)
+        {
+            continue;
+        }
+        else if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            return 1;
+        }
+        else
+        {
+            return 0;
+        }
+    }
+    client->out.len = client->outPos = 0;
+    return 1;
+}
+
+// Read the responses that have arrived, recording each one's latency
+// (returns # of responses completed, -1 if the connection was lost)
+static int readLoadResponses(struct LoadClient *client, int depth, long long latency[],
+                             int *recorded)
+{
+    int completed = 0, lineStart = 0, i;
+    ssize_t n;
+
+    for (;;)
+    {
+        if (!bufferReserve(&client->in, SERVER_READ_CHUNK))
+        {
+            return -1;
+        }
+        n = read(client->fd, client->in.data + client->in.len, SERVER_READ_CHUNK);
+        if (n > 0)
+        {
+            client->in.len += (int)n;
+        }
+        else if (n == -1 && errno == EINTR)
+        {
+            continue;
+        }
+        else if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            break;
+        }
+        else
+        {
+            return -1;
+        }
+    }
+
+    // A response is "OK <n>" plus n record lines, or one "ERR" line
+    for (i = client->scanned; i < client->in.len; i++)
+    {
+        if (client->in.data[i] != '\n')
+        {
+            continue;
+        }
+        if (client->recordsLeft > 0)
+        {
+            client->recordsLeft--;
+        }
+        else if (strncmp(client->in.data + lineStart, "OK ", 3) == 0)
+        {
+            client->recordsLeft = atoi(client->in.data + lineStart + 3);
+        }
+        if (client->recordsLeft == 0 && client->inFlight > 0)
+        {
+            latency[(*recorded)++] = nowNanos() - client->sentAt[client->oldest];
+            client->oldest = (client->oldest + 1) % depth;
+            client->inFlight--;
+            completed++;
+        }
+        lineStart = i + 1;
+    }
+    memmove(client->in.data, client->in.data + lineStart, client->in.len - lineStart);
+    client->in.len -= lineStart;
+    client->scanned = client->in.len;
+    return completed;
+}
+
+// Wait for output room only while requests are queued
+static void watchLoadClient(int epfd, struct LoadClient *client)
+{
+    struct epoll_event ev = {0};
+
+    ev.events = EPOLLIN | (client->outPos < client->out.len ? EPOLLOUT : 0);
+    if (ev.events != client->events)
+    {
+        ev.data.ptr = client;
+        epoll_ctl(epfd, EPOLL_CTL_MOD, client->fd, &ev);
+        client->events = ev.events;
+    }
+}
+
+// Drive read-only load against a running server from "connections" concurrent clients,
+// each keeping "pipelineDepth" requests in flight, and print latency/throughput
+int runLoadGenerator(const char *address, int connections, int requests,
+                     int pipelineDepth)
+{
+    struct epoll_event ev = {0}, events[SERVER_MAX_EVENTS];
+    struct LoadClient *clients;
+    long long *latency;
+    long long started, elapsed;
+    int c, i, ready, sent = 0, done = 0, recorded = 0, result = 0, epfd;
+    unsigned int seed = 12345;
+
+    if (connections < 1 || requests < 1 || pipelineDepth < 1)
+    {
+        printf("ERROR: connections, requests and depth must be > 0\n");
+        return 1;
+    }
+
+    epfd = epoll_create1(EPOLL_CLOEXEC);
+    clients = calloc(connections, sizeof(*clients));
+    latency = malloc(sizeof(*latency) * requests);
+    if (epfd == -1 || clients == NULL || latency == NULL)
+    {
+        if (epfd != -1)
+        {
+            close(epfd);
+        }
+        free(clients);
+        free(latency);
+        return 1;
+    }
+    for (c = 0; c < connections && result == 0; c++)
+    {
+        clients[c].sentAt = malloc(sizeof(*clients[c].sentAt) * pipelineDepth);
+        clients[c].fd = openSocket(address, 0);
+        if (clients[c].fd == -1 || clients[c].sentAt == NULL)
+        {
+            printf("ERROR: Unable to connect to %s (%s)\n", address, strerror(errno));
+            result = 1;
+            break;
+        }
+        fcntl(clients[c].fd, F_SETFL, fcntl(clients[c].fd, F_GETFL) | O_NONBLOCK);
+        clients[c].events = ev.events = EPOLLIN;
+        ev.data.ptr = &clients[c];
+        epoll_ctl(epfd, EPOLL_CTL_ADD, clients[c].fd, &ev);
+    }
+
+    // Every client starts with a full pipeline and tops it up as answers come back,
+    // so "connections" x "depth" requests are in flight at once
+    started = nowNanos();
+    for (c = 0; c < connections && result == 0; c++)
+    {
+        while (clients[c].inFlight < pipelineDepth && sent < requests)
+        {
+            queueLoadRequest(&clients[c], pipelineDepth, &seed);
+            sent++;
+        }
+        if (!flushLoadClient(&clients[c]))
+        {
+            result = 1;
+        }
+        watchLoadClient(epfd, &clients[c]);
+    }
+    while (done < requests && result == 0)
+    {
+        ready = epoll_wait(epfd, events, SERVER_MAX_EVENTS, SERVER_LOAD_TIMEOUT_MS);
+        if (ready == -1 && errno == EINTR)
+        {
+            continue;
+        }
+        if (ready <= 0)
+        {
+            result = 1;
+            break;
+        }
+        for (i = 0; i < ready && result == 0; i++)
+        {
+            struct LoadClient *client = events[i].data.ptr;
+            int completed = 0;
+
+            if (events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP))
+            {
+                completed = readLoadResponses(client, pipelineDepth, latency, &recorded);
+            }
+            if (completed == -1)
+            {
+                result = 1;
+                break;
+            }
+            done += completed;
+            while (client->inFlight < pipelineDepth && sent < requests)
+            {
+                queueLoadRequest(client, pipelineDepth, &seed);
+                sent++;
+            }
+            if (!flushLoadClient(client))
+            {
+                result = 1;
+                break;
+            }
+            watchLoadClient(epfd, client);
+        }
+    }
+    elapsed = nowNanos() - started;
+    if (result != 0 && c == connections)
+    {
+        printf("ERROR: Connection lost\n");
+    }
+
+    if (recorded > 0)
+    {
+        qsort(latency, recorded, sizeof(*latency), compareLatency);
+        printf("Requests   : %d over %d connection(s), pipeline depth %d\n",
+               done, connections, pipelineDepth);
+        printf("Throughput : %.0f requests/sec\n", done / (elapsed / 1e9));
+        printf("Latency/req: p50 %.1f us, p99 %.1f us, max %.1f us\n",
+               latency[recorded / 2] / 1e3, latency[(recorded * 99) / 100] / 1e3,
+               latency[recorded - 1] / 1e3);
+    }
+
+    for (c = 0; c < connections; c++)
+    {
+        if (clients[c].fd > 0)
+        {
+            close(clients[c].fd);
+        }
+        free(clients[c].sentAt);
+        free(clients[c].out.data);
+        free(clients[c].in.data);
+    }
+    close(epfd);
+    free(clients);
+    free(latency);
+    return result;
+}
@@ -0,0 +1,98 @@
+// SAFE-GUARD:
+// It is good practice to apply safe-guards to header files
+// Safe-guard's ensures only 1 copy of the header file is used in the project build
+// The macro name should be mirroring the file name with _ for spaces, dots, etc.
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "shard.h"
+
+//////////////////////////////////////
+// Module macro's (usable by any file that includes this header)
+//////////////////////////////////////
+
+// Default listening address (a path is a Unix socket, a number a TCP port)
+#define SERVER_DEFAULT_ADDRESS "/tmp/vetclinic.sock"
+
+// Connection limits
+#define SERVER_MAX_EVENTS 64
+#define SERVER_READ_CHUNK 16384
+#define SERVER_MAX_LINE 256
+#define SERVER_MAX_MATCHES 64
+
+// Answers queued for a client before its further requests wait (a client that
+// pipelines without reading is not read from until it catches up)
+#define SERVER_MAX_PENDING (256 * 1024)
+
+// Load generator: give up when no answer arrives for this long
+#define SERVER_LOAD_TIMEOUT_MS 10000
+
+// Directory (relative to the server's working directory) that exports are
+// written to; clients only name the files
+#define SERVER_EXPORT_DIR "exports"
+
+// Listing pages: rows per page when not given, and the most one request may ask for
+#define SERVER_PAGE_SIZE 100
+#define SERVER_MAX_PAGE 1000
+
+//////////////////////////////////////
+// Protocol
+//////////////////////////////////////
+//
+// One request per line, fields separated by single spaces:
+//   P <patient#>                         patient lookup
+//   F <phone#>                           patients by phone number
+//   D <year> <month> <day>               appointments for the day (time order)
+//   B <patient#> <y> <m> <d> <hh> <mm> [resource] [minutes]
+//                                        book an appointment (any free resource
+//                                        unless one is given; resource -1 = any)
+//   N <patient#> <y> <m> <d> <hh> <mm> [slots]
+//                                        earliest free slot(s) from that time
+//   A <patient#> <y> <m> <d> <hh> <mm> [minutes]
+//                                        lowest resource free for that time
+//   L <after#> [count]                   next page of patients in number order
+//                                        (after 0: from the first patient)
+//   V <token> [count]                    next page of appointments in date order
+//                                        (token -: from the first appointment)
+//   S D <y> <m> <d> | S M <y> <m> | S P <patient#>
+//                                        bookings on a day, in a month or of a
+//                                        patient (recurring series excluded)
+//   X <patientFile> <appointmentFile>    export every shard to the files in the
+//                                        import layouts, in the background from
+//                                        a snapshot taken now (one at a time)
+//   X <packFile>                         the same into one compressed pack file
+//                                        (see packfile.h)
+//                                        (plain file names of letters, digits,
+//                                        '.', '_' and '-', not starting with '.';
+//                                        written under SERVER_EXPORT_DIR)
+//
+// Each response starts with "OK <n>" followed by n record lines, or a single
+// "ERR <message>" line. Listing pages answer "OK <n> <token>": the token
+// resumes the listing after the page's last row, and a page shorter than
+// the count asked for is the last one. Patient records use the patientData.txt layout and
+// appointment records the appointmentData.txt layout with the resource and
+// minutes fields (N answers "year,month,day,hour,min", A the resource id,
+// S the count).
+// Requests may be
+// pipelined: responses are always returned in request order. Lookups and
+// bookings are routed to the patient's shard; phone searches and day
+// schedules are merged across every shard. Phone searches and exports read
+// the shards' snapshots, so they never hold up a booking.
+
+//////////////////////////////////////
+// SERVER FUNCTIONS
+//////////////////////////////////////
+
+// Serve the sharded clinic data on the address until SIGINT/SIGTERM (returns 0 on clean exit)
+int runServer(struct ClinicShards *shards, const char *address);
+
+//////////////////////////////////////
+// LOAD GENERATOR FUNCTIONS
+//////////////////////////////////////
+
+// Drive read-only load against a running server from "connections" concurrent clients,
+// each keeping "pipelineDepth" requests in flight, and print latency/throughput
+int runLoadGenerator(const char *address, int connections, int requests,
+                     int pipelineDepth);
+
+#endif // !SERVER_H
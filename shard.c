@@ -0,0 +1,831 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <pthread.h>
+
+// include the user library "clinic" where the store functions are declared
+#include "clinic.h"
+// include the user library "loader" for the parallel import
+#include "loader.h"
+// include the user library "packfile" for compressed exports
+#include "packfile.h"
+// include the user library "shard" where the function prototypes are declared
+#include "shard.h"
+
+//////////////////////////////////////
+// SETUP FUNCTIONS
+//////////////////////////////////////
+
+// Allocate "count" empty shards of the given capacity (returns 1 on success)
+int createShards(struct ClinicShards *shards, int count, int mode,
+                 int maxPatient, int maxAppointments)
+{
+    int i;
+
+    memset(shards, 0, sizeof(*shards));
+    shards->shards = calloc(count, sizeof(*shards->shards));
+    if (shards->shards == NULL)
+    {
+        return 0;
+    }
+    shards->count = count;
+    shards->mode = mode;
+    shards->rangeWidth = 1;
+
+    // Each shard gets its own arena so a busy clinic stays in its own cache lines
+    for (i = 0; i < count; i++)
+    {
+        struct ClinicShard *shard = &shards->shards[i];
+
+        pthread_mutex_init(&shard->lock, NULL);
+        snapshotInit(&shard->snapshots);
+        if (!createClinic(&shard->data, maxPatient, maxAppointments) ||
+            !attachClinicSnapshots(&shard->data, &shard->snapshots))
+        {
+            shards->count = i + 1;
+            destroyShards(shards);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// Release every shard
+void destroyShards(struct ClinicShards *shards)
+{
+    int i;
+
+    for (i = 0; i < shards->count; i++)
+    {
+        destroyClinic(&shards->shards[i].data);
+        snapshotFree(&shards->shards[i].snapshots);
+        pthread_mutex_destroy(&shards->shards[i].lock);
+    }
+    free(shards->shards);
+    memset(shards, 0, sizeof(*shards));
+}
+
+//////////////////////////////////////
+// ROUTING FUNCTIONS
+//////////////////////////////////////
+
+// Shard index for a patient number under SHARD_BY_RANGE (no presence check)
+static int rangeShard(const struct ClinicShards *shards, int patientNumber)
+{
+    long long index = ((long long)patientNumber - shards->shards[0].firstPatient) /
+                      shards->rangeWidth;
+
+    if (index < 0)
+    {
+        index = 0;
+    }
+    else if (index >= shards->count)
+    {
+        index = shards->count - 1;
+    }
+    return (int)index;
+}
+
+// Check a shard for the patient under its lock (returns patient array index or -1)
+static int lockedFind(struct ClinicShard *shard, int patientNumber, struct Patient *patient)
+{
+    int index;
+
+    pthread_mutex_lock(&shard->lock);
+    index = findPatientSlot(&shard->data, patientNumber);
+    if (index != -1 && patient != NULL)
+    {
+        *patient = shard->data.patients[index];
+    }
+    pthread_mutex_unlock(&shard->lock);
+    return index;
+}
+
+// Copy a patient record out of its shard (returns shard index or -1 if not found)
+int findShardedPatient(struct ClinicShards *shards, int patientNumber,
+                       struct Patient *patient)
+{
+    int i;
+
+    // Patient numbers start at 1, so nothing else is looked up (or routed)
+    if (patientNumber <= 0)
+    {
+        return -1;
+    }
+
+    // Ranges route straight to one shard, sites must be asked in turn
+    if (shards->mode == SHARD_BY_RANGE)
+    {
+        i = rangeShard(shards, patientNumber);
+        return lockedFind(&shards->shards[i], patientNumber, patient) == -1 ? -1 : i;
+    }
+    for (i = 0; i < shards->count; i++)
+    {
+        if (lockedFind(&shards->shards[i], patientNumber, patient) != -1)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Shard index holding the patient (returns -1 if not found)
+int shardIndexForPatient(struct ClinicShards *shards, int patientNumber)
+{
+    return findShardedPatient(shards, patientNumber, NULL);
+}
+
+// Cross-shard phone search: copies up to "max" matches (returns total matches)
+int searchShardsByPhone(struct ClinicShards *shards, const char *number,
+                        struct Patient matches[], int max)
+{
+    unsigned long long key = parsePhoneNumber(number);
+    struct SnapshotReader reader;
+    const struct Patient *patient;
+    int i, j, total = 0;
+
+    // A full scan: it reads the shard's snapshot so bookings need not wait for it
+    for (i = 0; i < shards->count && key != PHONE_NO_NUMBER; i++)
+    {
+        struct ClinicShard *shard = &shards->shards[i];
+        int pinned = snapshotBegin(&shard->snapshots, &reader);
+
+        if (!pinned)
+        {
+            pthread_mutex_lock(&shard->lock);
+        }
+        for (j = 0; j < shard->data.maxPatient; j++)
+        {
+            patient = pinned ? snapshotPatient(&reader, j) : &shard->data.patients[j];
+            if (patient->patientNumber && patientPhoneNumber(patient) == key)
+            {
+                if (total < max)
+                {
+                    matches[total] = *patient;
+                }
+                total++;
+            }
+        }
+        if (pinned)
+        {
+            snapshotEnd(&reader);
+        }
+        else
+        {
+            pthread_mutex_unlock(&shard->lock);
+        }
+    }
+    return total;
+}
+
+// Cross-shard day schedule: copies up to "max" bookings in time order (returns total)
+int shardDaySchedule(struct ClinicShards *shards, const struct Date *date,
+                     struct Appointment appoints[], int max)
+{
+    struct Appointment key;
+    int i, k, n, total = 0, kept = 0, merged;
+
+    for (i = 0; i < shards->count; i++)
+    {
+        struct ClinicShard *shard = &shards->shards[i];
+
+        pthread_mutex_lock(&shard->lock);
+        n = clinicDaySchedule(&shard->data, date, appoints + kept, max - kept);
+        pthread_mutex_unlock(&shard->lock);
+
+        // Merge the shard's time ordered run into the kept bookings
+        merged = kept + (n < max - kept ? n : max - kept);
+        for (; kept < merged; kept++)
+        {
+            key = appoints[kept];
+            for (k = kept; k > 0 &&
+                           (appoints[k - 1].time.hour * 60 + appoints[k - 1].time.min) >
+                               (key.time.hour * 60 + key.time.min);
+                 k--)
+            {
+                appoints[k] = appoints[k - 1];
+            }
+            appoints[k] = key;
+        }
+        total += n;
+    }
+    return total;
+}
+
+// Cross-shard patient page: copies up to "max" patients numbered above "after"
+// in number order (returns the number copied, -1 when out of memory)
+int shardPagePatients(struct ClinicShards *shards, int after, struct Patient patients[], int max)
+{
+    struct Patient *run, *merged;
+    int *slots;
+    int i, j, a, b, n, kept = 0, count;
+
+    run = malloc(sizeof(*run) * (max ? max : 1));
+    merged = malloc(sizeof(*merged) * (max ? max : 1));
+    slots = malloc(sizeof(*slots) * (max ? max : 1));
+    if (run == NULL || merged == NULL || slots == NULL)
+    {
+        free(run);
+        free(merged);
+        free(slots);
+        return -1;
+    }
+
+    for (i = 0; i < shards->count; i++)
+    {
+        struct ClinicShard *shard = &shards->shards[i];
+
+        pthread_mutex_lock(&shard->lock);
+        n = pagePatients(&shard->data, after, slots, max);
+        for (j = 0; j < n; j++)
+        {
+            run[j] = shard->data.patients[slots[j]];
+        }
+        pthread_mutex_unlock(&shard->lock);
+
+        // Merge the shard's number ordered run into the kept patients
+        for (a = 0, b = 0, count = 0; count < max && (a < kept || b < n); count++)
+        {
+            if (b == n || (a < kept && patients[a].patientNumber < run[b].patientNumber))
+            {
+                merged[count] = patients[a++];
+            }
+            else
+            {
+                merged[count] = run[b++];
+            }
+        }
+        memcpy(patients, merged, sizeof(*patients) * count);
+        kept = count;
+    }
+
+    free(run);
+    free(merged);
+    free(slots);
+    return kept;
+}
+
+// Order of two cross-shard listing positions
+static int compareShardCursors(const struct ShardCursor *x, const struct ShardCursor *y)
+{
+    if (x->at.start != y->at.start)
+    {
+        return x->at.start < y->at.start ? -1 : 1;
+    }
+    if (x->at.resource != y->at.resource)
+    {
+        return x->at.resource < y->at.resource ? -1 : 1;
+    }
+    if (x->shard != y->shard)
+    {
+        return x->shard < y->shard ? -1 : 1;
+    }
+    return (x->at.slot > y->at.slot) - (x->at.slot < y->at.slot);
+}
+
+// Position a cross-shard cursor before the first appointment
+void startShardCursor(struct ShardCursor *cursor)
+{
+    startAppointmentCursor(&cursor->at);
+    cursor->shard = -1;
+}
+
+// Cross-shard appointment page: copies up to "max" appointments following the cursor
+// in date order and advances the cursor (returns the number copied, -1 when out of memory)
+int shardPageAppointments(struct ClinicShards *shards, struct ShardCursor *cursor,
+                          struct Appointment appoints[], int max)
+{
+    struct Appointment *run, *merged;
+    struct ShardCursor *keys, *runKeys, *mergedKeys;
+    struct AppointmentCursor local;
+    int *slots;
+    int i, j, a, b, n, kept = 0, count;
+    size_t rows = max ? max : 1;
+
+    run = malloc(sizeof(*run) * rows);
+    merged = malloc(sizeof(*merged) * rows);
+    keys = malloc(sizeof(*keys) * rows);
+    runKeys = malloc(sizeof(*runKeys) * rows);
+    mergedKeys = malloc(sizeof(*mergedKeys) * rows);
+    slots = malloc(sizeof(*slots) * rows);
+    if (run == NULL || merged == NULL || keys == NULL || runKeys == NULL ||
+        mergedKeys == NULL || slots == NULL)
+    {
+        kept = -1;
+        max = 0;
+    }
+
+    for (i = 0; i < shards->count && max > 0; i++)
+    {
+        struct ClinicShard *shard = &shards->shards[i];
+
+        // Bookings at the cursor's start and resource were listed from the
+        // shards before the cursor's, not yet from the ones after it
+        local = cursor->at;
+        if (i < cursor->shard)
+        {
+            local.slot = INT_MAX;
+        }
+        else if (i > cursor->shard)
+        {
+            local.slot = -1;
+        }
+
+        pthread_mutex_lock(&shard->lock);
+        n = pageAppointments(&shard->data, &local, slots, max);
+        for (j = 0; j < n; j++)
+        {
+            run[j] = shard->data.appointments[slots[j]];
+            runKeys[j].at.start = dateTimeKey(&run[j].date, &run[j].time);
+            runKeys[j].at.resource = run[j].resource;
+            runKeys[j].at.slot = slots[j];
+            runKeys[j].shard = i;
+        }
+        pthread_mutex_unlock(&shard->lock);
+
+        // Merge the shard's date ordered run into the kept bookings
+        for (a = 0, b = 0, count = 0; count < max && (a < kept || b < n); count++)
+        {
+            if (b == n || (a < kept && compareShardCursors(&keys[a], &runKeys[b]) < 0))
+            {
+                mergedKeys[count] = keys[a];
+                merged[count] = appoints[a++];
+            }
+            else
+            {
+                mergedKeys[count] = runKeys[b];
+                merged[count] = run[b++];
+            }
+        }
+        memcpy(appoints, merged, sizeof(*appoints) * count);
+        memcpy(keys, mergedKeys, sizeof(*keys) * count);
+        kept = count;
+    }
+    if (kept > 0)
+    {
+        *cursor = keys[kept - 1];
+    }
+
+    free(run);
+    free(merged);
+    free(keys);
+    free(runKeys);
+    free(mergedKeys);
+    free(slots);
+    return kept;
+}
+
+// Cross-shard booking count read from each shard's statistics (statsDayCount,
+// statsMonthCount or statsPatientCount with its key)
+long long shardStatsCount(struct ClinicShards *shards,
+                          int (*count)(const struct ClinicStats *stats, int key), int key)
+{
+    long long total = 0;
+    int i;
+
+    for (i = 0; i < shards->count; i++)
+    {
+        pthread_mutex_lock(&shards->shards[i].lock);
+        total += count(&shards->shards[i].data.stats, key);
+        pthread_mutex_unlock(&shards->shards[i].lock);
+    }
+    return total;
+}
+
+// Book an appointment in the patient's shard (returns BOOK_OK or a BOOK_ error code)
+int bookShardedAppointment(struct ClinicShards *shards, const struct Appointment *appoint)
+{
+    struct ClinicShard *shard;
+    int index, result;
+
+    index = findShardedPatient(shards, appoint->patientNumber, NULL);
+    if (index == -1)
+    {
+        return BOOK_NO_PATIENT;
+    }
+
+    shard = &shards->shards[index];
+    pthread_mutex_lock(&shard->lock);
+    result = bookAppointment(&shard->data, appoint);
+    pthread_mutex_unlock(&shard->lock);
+    return result;
+}
+
+// Earliest free slot(s) in the patient's shard at or after date/time
+// (returns 1 if found, 0 if none is open, -1 if the patient is unknown)
+int shardNextTimeslot(struct ClinicShards *shards, int patientNumber,
+                      const struct Date *date, const struct Time *time, int count,
+                      struct Date *foundDate, struct Time *foundTime)
+{
+    struct ClinicShard *shard;
+    int index, found;
+
+    index = findShardedPatient(shards, patientNumber, NULL);
+    if (index == -1)
+    {
+        return -1;
+    }
+
+    shard = &shards->shards[index];
+    pthread_mutex_lock(&shard->lock);
+    found = findNextTimeslot(&shard->data, date, time, count, foundDate, foundTime);
+    pthread_mutex_unlock(&shard->lock);
+    return found;
+}
+
+// Lowest resource in the patient's shard free for "minutes" from date/time
+// (returns 1 and fills resource if found, 0 if all are busy, -1 if the patient is unknown)
+int shardFreeResource(struct ClinicShards *shards, int patientNumber,
+                      const struct Date *date, const struct Time *time, int minutes,
+                      int *resource)
+{
+    struct ClinicShard *shard;
+    int index;
+
+    index = findShardedPatient(shards, patientNumber, NULL);
+    if (index == -1)
+    {
+        return -1;
+    }
+
+    shard = &shards->shards[index];
+    pthread_mutex_lock(&shard->lock);
+    *resource = findFreeResource(&shard->data, date, time, minutes);
+    pthread_mutex_unlock(&shard->lock);
+    return *resource != -1;
+}
+
+//////////////////////////////////////
+// FILE FUNCTIONS
+//////////////////////////////////////
+
+// Import one clinic export and split it by patient-number range (returns # of
+// patients, -1 if any record did not fit its shard: nothing is dropped silently)
+int importShardedData(struct ClinicShards *shards, const char *patientFile,
+                      const char *appointmentFile)
+{
+    struct Patient *patients;
+    struct Appointment *appoints;
+    int *patientFill, *appointFill;
+    int patientCount, appointCount, low = 0, high = 0, total = 0;
+    int lostPatients = 0, lostAppoints = 0;
+    int i, s;
+
+    patientCount = countDataRecords(patientFile);
+    appointCount = countDataRecords(appointmentFile);
+    if (patientCount < 0 || appointCount < 0)
+    {
+        printf("ERROR: Unable to open %s\n", patientCount < 0 ? patientFile : appointmentFile);
+        return -1;
+    }
+    patients = calloc(patientCount ? patientCount : 1, sizeof(*patients));
+    appoints = calloc(appointCount ? appointCount : 1, sizeof(*appoints));
+    patientFill = calloc(shards->count, sizeof(int));
+    appointFill = calloc(shards->count, sizeof(int));
+    if (patients == NULL || appoints == NULL || patientFill == NULL || appointFill == NULL)
+    {
+        free(patients);
+        free(appoints);
+        free(patientFill);
+        free(appointFill);
+        printf("ERROR: Out of memory\n");
+        return -1;
+    }
+
+    // Stage the whole export, then derive equal-width number ranges from it
+    patientCount = importPatientsParallel(patientFile, patients, patientCount, 0);
+    appointCount = importAppointmentsParallel(appointmentFile, appoints, appointCount, 0);
+    for (i = 0; i < patientCount; i++)
+    {
+        if (patients[i].patientNumber)
+        {
+            if (low == 0 || patients[i].patientNumber < low)
+            {
+                low = patients[i].patientNumber;
+            }
+            if (patients[i].patientNumber > high)
+            {
+                high = patients[i].patientNumber;
+            }
+        }
+    }
+    shards->mode = SHARD_BY_RANGE;
+    shards->rangeWidth = (high - low) / shards->count + 1;
+    for (s = 0; s < shards->count; s++)
+    {
+        shards->shards[s].firstPatient = low + s * shards->rangeWidth;
+    }
+
+    for (i = 0; i < patientCount; i++)
+    {
+        if (patients[i].patientNumber)
+        {
+            s = rangeShard(shards, patients[i].patientNumber);
+            if (patientFill[s] < shards->shards[s].data.maxPatient)
+            {
+                shards->shards[s].data.patients[patientFill[s]++] = patients[i];
+                total++;
+            }
+            else
+            {
+                lostPatients++;
+            }
+        }
+    }
+
+    // Appointments follow their patient so no booking spans two shards
+    for (i = 0; i < appointCount; i++)
+    {
+        if (appoints[i].patientNumber)
+        {
+            s = rangeShard(shards, appoints[i].patientNumber);
+            if (appointFill[s] < shards->shards[s].data.maxAppointments)
+            {
+                shards->shards[s].data.appointments[appointFill[s]++] = appoints[i];
+            }
+            else
+            {
+                lostAppoints++;
+            }
+        }
+    }
+
+    for (s = 0; s < shards->count; s++)
+    {
+        syncClinicIndexes(&shards->shards[s].data);
+    }
+
+    free(patients);
+    free(appoints);
+    free(patientFill);
+    free(appointFill);
+    if (lostPatients > 0 || lostAppoints > 0)
+    {
+        printf("ERROR: %d patient(s) and %d appointment(s) of %s and %s do not fit the"
+               " shards of their number range\n",
+               lostPatients, lostAppoints, patientFile, appointmentFile);
+        return -1;
+    }
+    return total;
+}
+
+// Work item for one site import thread
+struct SiteImport
+{
+    struct ClinicShard *shard;
+    const char *patientFile;
+    const char *appointmentFile;
+    int count;
+    int missing;      // a file could not be opened
+    int lostPatients; // records past the shard's capacity
+    int lostAppoints;
+    int threaded;
+};
+
+// Thread body: load one site's files into its shard
+static void *importSite(void *arg)
+{
+    struct SiteImport *job = arg;
+    struct ClinicData *data = &job->shard->data;
+    int patientCount, appointCount, i;
+
+    // The files are counted first: the import readers stop at the capacity
+    patientCount = countDataRecords(job->patientFile);
+    appointCount = countDataRecords(job->appointmentFile);
+    job->missing = patientCount < 0 || appointCount < 0;
+    job->lostPatients = patientCount > data->maxPatient ? patientCount - data->maxPatient : 0;
+    job->lostAppoints =
+        appointCount > data->maxAppointments ? appointCount - data->maxAppointments : 0;
+    if (job->missing || job->lostPatients > 0 || job->lostAppoints > 0)
+    {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&job->shard->lock);
+    importPatients(job->patientFile, data->patients, data->maxPatient);
+    importAppointments(job->appointmentFile, data->appointments, data->maxAppointments);
+    syncClinicIndexes(data);
+    for (i = 0; i < data->maxPatient; i++)
+    {
+        if (data->patients[i].patientNumber)
+        {
+            job->count++;
+        }
+    }
+    pthread_mutex_unlock(&job->shard->lock);
+    return NULL;
+}
+
+// Import every site's files into its shard (shard i serves the i-th pair of files),
+// one thread per shard (returns # of patients, -1 if any record did not fit its shard)
+int importShardSites(struct ClinicShards *shards, const char *patientFiles[],
+                     const char *appointmentFiles[])
+{
+    struct SiteImport *jobs;
+    pthread_t *threads;
+    int i, total = 0;
+
+    jobs = calloc(shards->count, sizeof(*jobs));
+    threads = calloc(shards->count, sizeof(*threads));
+    if (jobs == NULL || threads == NULL)
+    {
+        free(jobs);
+        free(threads);
+        printf("ERROR: Out of memory\n");
+        return -1;
+    }
+
+    shards->mode = SHARD_BY_SITE;
+    for (i = 0; i < shards->count; i++)
+    {
+        jobs[i].shard = &shards->shards[i];
+        jobs[i].patientFile = patientFiles[i];
+        jobs[i].appointmentFile = appointmentFiles[i];
+        jobs[i].threaded = pthread_create(&threads[i], NULL, importSite, &jobs[i]) == 0;
+        if (!jobs[i].threaded)
+        {
+            importSite(&jobs[i]);
+        }
+    }
+    for (i = 0; i < shards->count; i++)
+    {
+        if (jobs[i].threaded)
+        {
+            pthread_join(threads[i], NULL);
+        }
+        if (jobs[i].missing)
+        {
+            printf("ERROR: Unable to open %s or %s\n", jobs[i].patientFile,
+                   jobs[i].appointmentFile);
+            total = -1;
+        }
+        else if (jobs[i].lostPatients > 0 || jobs[i].lostAppoints > 0)
+        {
+            printf("ERROR: %d patient(s) and %d appointment(s) of %s and %s do not fit"
+                   " site %d's shard\n",
+                   jobs[i].lostPatients, jobs[i].lostAppoints, jobs[i].patientFile,
+                   jobs[i].appointmentFile, i);
+            total = -1;
+        }
+        else if (total != -1)
+        {
+            total += jobs[i].count;
+        }
+    }
+
+    free(jobs);
+    free(threads);
+    return total;
+}
+
+// Pin a snapshot of every shard (returns the readers, NULL on failure)
+static struct SnapshotReader *pinShards(struct ClinicShards *shards)
+{
+    struct SnapshotReader *readers = calloc(shards->count, sizeof(*readers));
+    int i, pinned = readers != NULL;
+
+    // Every shard is pinned before any is written out: the files show each shard
+    // as of the request, not as of whenever the writing reached it
+    for (i = 0; pinned && i < shards->count; i++)
+    {
+        pinned = snapshotBegin(&shards->shards[i].snapshots, &readers[i]);
+    }
+    if (!pinned && readers != NULL)
+    {
+        while (--i >= 0)
+        {
+            snapshotEnd(&readers[i]);
+        }
+        free(readers);
+        readers = NULL;
+    }
+    return readers;
+}
+
+// Release the snapshots pinned by pinShards
+static void unpinShards(struct ClinicShards *shards, struct SnapshotReader *readers)
+{
+    int i;
+
+    for (i = 0; i < shards->count; i++)
+    {
+        snapshotEnd(&readers[i]);
+    }
+    free(readers);
+}
+
+// Write every shard's patients and appointments in the import layouts from a
+// snapshot of each shard taken up front, so bookings go on while it runs
+// (returns # of patients written, -1 if a file could not be written)
+int exportShardSnapshots(struct ClinicShards *shards, const char *patientFile,
+                         const char *appointmentFile)
+{
+    struct SnapshotReader *readers;
+    const struct Patient *patient;
+    const struct Appointment *appoint;
+    struct Phone phone;
+    FILE *patients, *appoints;
+    int i, j, total = 0;
+
+    readers = pinShards(shards);
+    patients = fopen(patientFile, "w");
+    appoints = fopen(appointmentFile, "w");
+    if (readers == NULL || patients == NULL || appoints == NULL)
+    {
+        if (readers != NULL)
+        {
+            unpinShards(shards, readers);
+        }
+        if (patients != NULL)
+        {
+            fclose(patients);
+        }
+        if (appoints != NULL)
+        {
+            fclose(appoints);
+        }
+        return -1;
+    }
+
+    for (i = 0; i < shards->count; i++)
+    {
+        for (j = 0; (patient = snapshotPatient(&readers[i], j)) != NULL; j++)
+        {
+            if (patient->patientNumber > 0)
+            {
+                getPatientPhone(patient, &phone);
+                fprintf(patients, "%d|%s|%s|%s\n", patient->patientNumber,
+                        patientName(patient), phone.description, phone.number);
+                total++;
+            }
+        }
+    }
+    for (i = 0; i < shards->count; i++)
+    {
+        for (j = 0; (appoint = snapshotAppointment(&readers[i], j)) != NULL; j++)
+        {
+            if (appoint->patientNumber > 0)
+            {
+                fprintf(appoints, "%d,%d,%d,%d,%d,%d,%d,%d\n", appoint->patientNumber,
+                        appoint->date.year, appoint->date.month, appoint->date.day,
+                        appoint->time.hour, appoint->time.min, appoint->resource,
+                        appoint->duration);
+            }
+        }
+    }
+
+    unpinShards(shards, readers);
+    if (fclose(patients) != 0 || fclose(appoints) != 0)
+    {
+        total = -1;
+    }
+    return total;
+}
+
+// Same as exportShardSnapshots, into one compressed pack file (see packfile.h)
+// (returns # of patients written, -1 if the file could not be written)
+int exportShardPack(struct ClinicShards *shards, const char *packFile)
+{
+    struct SnapshotReader *readers;
+    struct PackWriter writer;
+    const struct Patient *patient;
+    const struct Appointment *appoint;
+    int i, j, ok, total = 0;
+
+    readers = pinShards(shards);
+    if (readers == NULL)
+    {
+        return -1;
+    }
+    ok = packWriterOpen(&writer, packFile);
+    for (i = 0; ok && i < shards->count; i++)
+    {
+        for (j = 0; ok && (patient = snapshotPatient(&readers[i], j)) != NULL; j++)
+        {
+            if (patient->patientNumber > 0)
+            {
+                ok = packPatient(&writer, patient->patientNumber, patientName(patient),
+                                 patient->phone);
+                total++;
+            }
+        }
+    }
+    for (i = 0; ok && i < shards->count; i++)
+    {
+        for (j = 0; ok && (appoint = snapshotAppointment(&readers[i], j)) != NULL; j++)
+        {
+            if (appoint->patientNumber > 0)
+            {
+                ok = packAppointment(&writer, appoint);
+            }
+        }
+    }
+
+    unpinShards(shards, readers);
+    if (writer.fp != NULL && !packWriterClose(&writer))
+    {
+        ok = 0;
+    }
+    return ok ? total : -1;
+}
@@ -0,0 +1,139 @@
+// SAFE-GUARD:
+// It is good practice to apply safe-guards to header files
+// Safe-guard's ensures only 1 copy of the header file is used in the project build
+// The macro name should be mirroring the file name with _ for spaces, dots, etc.
+#ifndef SHARD_H
+#define SHARD_H
+
+#include <pthread.h>
+#include "clinic.h"
+
+//////////////////////////////////////
+// Module macro's (usable by any file that includes this header)
+//////////////////////////////////////
+
+// Partitioning schemes
+#define SHARD_BY_SITE 1
+#define SHARD_BY_RANGE 2
+
+// Free patient and appointment slots each shard keeps past its imported records
+#define SHARD_ROOM 1024
+
+//////////////////////////////////////
+// Structures
+//////////////////////////////////////
+
+// Data type: one independent clinic partition
+// (each shard keeps its own patients, schedule and lock)
+struct ClinicShard
+{
+    struct ClinicData data;
+    pthread_mutex_t lock;
+    struct SnapshotStore snapshots; // versions of the stores readable without the lock
+    int firstPatient; // SHARD_BY_RANGE: lowest patient number routed here
+};
+
+// Data type: N clinic partitions plus the routing rule
+struct ClinicShards
+{
+    struct ClinicShard *shards;
+    int count;
+    int mode;
+    int rangeWidth; // SHARD_BY_RANGE: patient numbers per shard
+};
+
+// Data type: resume point of a cross-shard appointment listing
+// (date order, then resource, then shard, then store slot)
+struct ShardCursor
+{
+    struct AppointmentCursor at;
+    int shard;
+};
+
+//////////////////////////////////////
+// SETUP FUNCTIONS
+//////////////////////////////////////
+
+// Allocate "count" empty shards of the given capacity (returns 1 on success)
+int createShards(struct ClinicShards *shards, int count, int mode,
+                 int maxPatient, int maxAppointments);
+
+// Release every shard
+void destroyShards(struct ClinicShards *shards);
+
+//////////////////////////////////////
+// ROUTING FUNCTIONS
+//////////////////////////////////////
+
+// Shard index holding the patient (returns -1 if not found)
+int shardIndexForPatient(struct ClinicShards *shards, int patientNumber);
+
+// Copy a patient record out of its shard (returns shard index or -1 if not found)
+int findShardedPatient(struct ClinicShards *shards, int patientNumber,
+                       struct Patient *patient);
+
+// Cross-shard phone search: copies up to "max" matches (returns total matches)
+int searchShardsByPhone(struct ClinicShards *shards, const char *number,
+                        struct Patient matches[], int max);
+
+// Cross-shard day schedule: copies up to "max" bookings in time order (returns total)
+int shardDaySchedule(struct ClinicShards *shards, const struct Date *date,
+                     struct Appointment appoints[], int max);
+
+// Cross-shard patient page: copies up to "max" patients numbered above "after"
+// in number order (returns the number copied, -1 when out of memory)
+int shardPagePatients(struct ClinicShards *shards, int after, struct Patient patients[], int max);
+
+// Position a cross-shard cursor before the first appointment
+void startShardCursor(struct ShardCursor *cursor);
+
+// Cross-shard appointment page: copies up to "max" appointments following the cursor
+// in date order and advances the cursor (returns the number copied, -1 when out of memory)
+int shardPageAppointments(struct ClinicShards *shards, struct ShardCursor *cursor,
+                          struct Appointment appoints[], int max);
+
+// Cross-shard booking count read from each shard's statistics (statsDayCount,
+// statsMonthCount or statsPatientCount with its key)
+long long shardStatsCount(struct ClinicShards *shards,
+                          int (*count)(const struct ClinicStats *stats, int key), int key);
+
+// Book an appointment in the patient's shard (returns BOOK_OK or a BOOK_ error code)
+int bookShardedAppointment(struct ClinicShards *shards, const struct Appointment *appoint);
+
+// Earliest free slot(s) in the patient's shard at or after date/time
+// (returns 1 if found, 0 if none is open, -1 if the patient is unknown)
+int shardNextTimeslot(struct ClinicShards *shards, int patientNumber,
+                      const struct Date *date, const struct Time *time, int count,
+                      struct Date *foundDate, struct Time *foundTime);
+
+// Lowest resource in the patient's shard free for "minutes" from date/time
+// (returns 1 and fills resource if found, 0 if all are busy, -1 if the patient is unknown)
+int shardFreeResource(struct ClinicShards *shards, int patientNumber,
+                      const struct Date *date, const struct Time *time, int minutes,
+                      int *resource);
+
+//////////////////////////////////////
+// FILE FUNCTIONS
+//////////////////////////////////////
+
+// Import one clinic export and split it by patient-number range (returns # of
+// patients, -1 if any record did not fit its shard: nothing is dropped silently)
+int importShardedData(struct ClinicShards *shards, const char *patientFile,
+                      const char *appointmentFile);
+
+// Import every site's files into its shard (shard i serves the i-th pair of files),
+// one thread per shard (returns # of patients, -1 if any record did not fit its shard)
+int importShardSites(struct ClinicShards *shards, const char *patientFiles[],
+                     const char *appointmentFiles[]);
+
+// Write every shard's patients and appointments in the import layouts from a
+// snapshot of each shard taken up front, so bookings go on while it runs
+// (returns # of patients written, -1 if a file could not be written)
+int exportShardSnapshots(struct ClinicShards *shards, const char *patientFile,
+                         const char *appointmentFile);
+
+// Same as exportShardSnapshots, into one compressed pack file (see packfile.h)
+// (returns # of patients written, -1 if the file could not be written)
+int exportShardPack(struct ClinicShards *shards, const char *packFile);
+
+#endif // !SHARD_H
@@ -0,0 +1,357 @@
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+// include the user library "clinic" for the record layouts
+#include "clinic.h"
+// include the user library "snapshot" where the function prototypes are declared
+#include "snapshot.h"
+
+//////////////////////////////////////
+// HELPERS
+//////////////////////////////////////
+
+// Pages needed for "count" records
+static int pagesFor(int count)
+{
+    return (count + SNAPSHOT_PAGE_SIZE - 1) >> SNAPSHOT_PAGE_BITS;
+}
+
+// Release a version and the pages only it still refers to
+static void freeVersion(struct SnapshotVersion *version)
+{
+    int i;
+
+    if (version->ownsPages)
+    {
+        for (i = 0; i < pagesFor(version->maxPatient); i++)
+        {
+            free(version->patientPages[i]);
+        }
+        for (i = 0; i < pagesFor(version->maxAppointments); i++)
+        {
+            free(version->appointmentPages[i]);
+        }
+    }
+    else
+    {
+        free(version->replacedPage);
+    }
+    free(version->patientPages);
+    free(version->appointmentPages);
+    free(version);
+}
+
+// Allocate a version sized like "from" sharing all of its pages (returns NULL when out of memory)
+static struct SnapshotVersion *copyVersion(const struct SnapshotVersion *from, int maxPatient,
+                                           int maxAppointments)
+{
+    struct SnapshotVersion *version = calloc(1, sizeof(*version));
+
+    if (version == NULL)
+    {
+        return NULL;
+    }
+    version->patientPages = calloc(pagesFor(maxPatient) + 1, sizeof(*version->patientPages));
+    version->appointmentPages = calloc(pagesFor(maxAppointments) + 1,
+                                       sizeof(*version->appointmentPages));
+    if (version->patientPages == NULL || version->appointmentPages == NULL)
+    {
+        free(version->patientPages);
+        free(version->appointmentPages);
+        free(version);
+        return NULL;
+    }
+    version->maxPatient = maxPatient;
+    version->maxAppointments = maxAppointments;
+    if (from != NULL)
+    {
+        memcpy(version->patientPages, from->patientPages,
+               sizeof(*version->patientPages) * pagesFor(maxPatient));
+        memcpy(version->appointmentPages, from->appointmentPages,
+               sizeof(*version->appointmentPages) * pagesFor(maxAppointments));
+        version->version = from->version + 1;
+    }
+    return version;
+}
+
+// Free the retired versions no reader can still hold: a reader only holds
+// versions retired at or after the epoch it entered at
+static void reclaimVersions(struct SnapshotStore *store)
+{
+    struct SnapshotVersion *oldest;
+    long long entered, lowest = LLONG_MAX;
+    int i;
+
+    for (i = 0; i < SNAPSHOT_MAX_READERS; i++)
+    {
+        entered = atomic_load(&store->readers[i]);
+        if (entered != 0 && entered < lowest)
+        {
+            lowest = entered;
+        }
+    }
+
+    // Versions retire in order, and each frees only the page its successor
+    // replaced, so they are freed oldest first
+    while (store->retired != NULL && store->retired->retiredAt < lowest)
+    {
+        oldest = store->retired;
+        store->retired = oldest->nextRetired;
+        freeVersion(oldest);
+    }
+    if (store->retired == NULL)
+    {
+        store->retiredTail = NULL;
+    }
+}
+
+// Make "next" the current version and retire the one it replaces (write lock held)
+static void publishVersion(struct SnapshotStore *store, struct SnapshotVersion *next)
+{
+    struct SnapshotVersion *previous = atomic_exchange(&store->current, next);
+
+    if (previous != NULL)
+    {
+        // A reader that entered before the epoch moves on may have pinned "previous"
+        previous->retiredAt = atomic_fetch_add(&store->epoch, 1);
+        previous->nextRetired = NULL;
+        if (store->retiredTail != NULL)
+        {
+            store->retiredTail->nextRetired = previous;
+        }
+        else
+        {
+            store->retired = previous;
+        }
+        store->retiredTail = previous;
+    }
+    reclaimVersions(store);
+}
+
+// Publish a new version with one record of "size" bytes rewritten in a page
+// table (returns 0 if the slot is out of range or memory ran out)
+static int setRecord(struct SnapshotStore *store, int isPatient, int slot, const void *record,
+                     size_t size)
+{
+    struct SnapshotVersion *current, *next;
+    void **pages;
+    char *page;
+    int max, written = 0;
+
+    pthread_mutex_lock(&store->writeLock);
+    current = atomic_load(&store->current);
+    max = current == NULL ? 0 : isPatient ? current->maxPatient : current->maxAppointments;
+    if (slot >= 0 && slot < max)
+    {
+        next = copyVersion(current, current->maxPatient, current->maxAppointments);
+        page = malloc(size * SNAPSHOT_PAGE_SIZE);
+        if (next != NULL && page != NULL)
+        {
+            pages = isPatient ? (void **)next->patientPages : (void **)next->appointmentPages;
+
+            // Copy on write: the page is copied once, the rest stay shared
+            memcpy(page, pages[slot >> SNAPSHOT_PAGE_BITS], size * SNAPSHOT_PAGE_SIZE);
+            memcpy(page + size * (slot & (SNAPSHOT_PAGE_SIZE - 1)), record, size);
+            current->replacedPage = pages[slot >> SNAPSHOT_PAGE_BITS];
+            pages[slot >> SNAPSHOT_PAGE_BITS] = page;
+            publishVersion(store, next);
+            written = 1;
+        }
+        else
+        {
+            free(page);
+            if (next != NULL)
+            {
+                freeVersion(next);
+            }
+        }
+    }
+    pthread_mutex_unlock(&store->writeLock);
+    return written;
+}
+
+//////////////////////////////////////
+// WRITER FUNCTIONS
+//////////////////////////////////////
+
+// Set up an empty store (returns 1 on success)
+int snapshotInit(struct SnapshotStore *store)
+{
+    int i;
+
+    memset(store, 0, sizeof(*store));
+    atomic_init(&store->current, NULL);
+    atomic_init(&store->epoch, 1);
+    for (i = 0; i < SNAPSHOT_MAX_READERS; i++)
+    {
+        atomic_init(&store->readers[i], 0);
+    }
+    return pthread_mutex_init(&store->writeLock, NULL) == 0;
+}
+
+// Publish a full copy of the stores, e.g. after an import (returns 0 when out of memory)
+int snapshotLoad(struct SnapshotStore *store, const struct Patient *patients, int maxPatient,
+                 const struct Appointment *appoints, int maxAppointments)
+{
+    struct SnapshotVersion *current, *next;
+    int i, count, loaded = 1;
+
+    pthread_mutex_lock(&store->writeLock);
+    current = atomic_load(&store->current);
+    next = copyVersion(NULL, maxPatient, maxAppointments);
+    if (next == NULL)
+    {
+        pthread_mutex_unlock(&store->writeLock);
+        return 0;
+    }
+    next->version = current != NULL ? current->version + 1 : 1;
+    for (i = 0; i < pagesFor(maxPatient) && loaded; i++)
+    {
+        count = maxPatient - (i << SNAPSHOT_PAGE_BITS);
+        count = count < SNAPSHOT_PAGE_SIZE ? count : SNAPSHOT_PAGE_SIZE;
+        next->patientPages[i] = calloc(SNAPSHOT_PAGE_SIZE, sizeof(struct Patient));
+        loaded = next->patientPages[i] != NULL;
+        if (loaded)
+        {
+            memcpy(next->patientPages[i], &patients[i << SNAPSHOT_PAGE_BITS],
+                   sizeof(struct Patient) * count);
+        }
+    }
+    for (i = 0; i < pagesFor(maxAppointments) && loaded; i++)
+    {
+        count = maxAppointments - (i << SNAPSHOT_PAGE_BITS);
+        count = count < SNAPSHOT_PAGE_SIZE ? count : SNAPSHOT_PAGE_SIZE;
+        next->appointmentPages[i] = calloc(SNAPSHOT_PAGE_SIZE, sizeof(struct Appointment));
+        loaded = next->appointmentPages[i] != NULL;
+        if (loaded)
+        {
+            memcpy(next->appointmentPages[i], &appoints[i << SNAPSHOT_PAGE_BITS],
+                   sizeof(struct Appointment) * count);
+        }
+    }
+    if (!loaded)
+    {
+        next->ownsPages = 1;
+        freeVersion(next);
+    }
+    else
+    {
+        // Nothing is shared with the old versions: the last one frees its own pages
+        if (current != NULL)
+        {
+            current->ownsPages = 1;
+        }
+        publishVersion(store, next);
+    }
+    pthread_mutex_unlock(&store->writeLock);
+    return loaded;
+}
+
+// Publish a new version with one patient slot rewritten
+// (returns 0 if the slot is out of range or memory ran out)
+int snapshotSetPatient(struct SnapshotStore *store, int slot, const struct Patient *patient)
+{
+    return setRecord(store, 1, slot, patient, sizeof(*patient));
+}
+
+// Publish a new version with one appointment slot rewritten
+// (returns 0 if the slot is out of range or memory ran out)
+int snapshotSetAppointment(struct SnapshotStore *store, int slot,
+                           const struct Appointment *appoint)
+{
+    return setRecord(store, 0, slot, appoint, sizeof(*appoint));
+}
+
+// Release every version (no reader may hold one)
+void snapshotFree(struct SnapshotStore *store)
+{
+    struct SnapshotVersion *current = atomic_load(&store->current);
+
+    while (store->retired != NULL)
+    {
+        struct SnapshotVersion *oldest = store->retired;
+
+        store->retired = oldest->nextRetired;
+        freeVersion(oldest);
+    }
+    if (current != NULL)
+    {
+        current->ownsPages = 1;
+        freeVersion(current);
+    }
+    pthread_mutex_destroy(&store->writeLock);
+    memset(store, 0, sizeof(*store));
+}
+
+//////////////////////////////////////
+// READER FUNCTIONS
+//////////////////////////////////////
+
+// Pin the current version: it stays readable and unchanged until snapshotEnd
+// (returns 0 if nothing was published yet or every reader slot is taken)
+int snapshotBegin(struct SnapshotStore *store, struct SnapshotReader *reader)
+{
+    long long vacant;
+    int i;
+
+    reader->store = store;
+    reader->version = NULL;
+    reader->slot = -1;
+
+    // Announce the epoch before loading the version: a writer that retires
+    // the loaded version afterwards sees the announcement and keeps it
+    for (i = 0; i < SNAPSHOT_MAX_READERS && reader->slot == -1; i++)
+    {
+        vacant = 0;
+        if (atomic_compare_exchange_strong(&store->readers[i], &vacant,
+                                           atomic_load(&store->epoch)))
+        {
+            reader->slot = i;
+        }
+    }
+    if (reader->slot == -1)
+    {
+        return 0;
+    }
+    reader->version = atomic_load(&store->current);
+    if (reader->version == NULL)
+    {
+        snapshotEnd(reader);
+        return 0;
+    }
+    return 1;
+}
+
+// Patient record of a slot in the pinned version (NULL if out of range)
+const struct Patient *snapshotPatient(const struct SnapshotReader *reader, int slot)
+{
+    if (slot < 0 || slot >= reader->version->maxPatient)
+    {
+        return NULL;
+    }
+    return &reader->version->patientPages[slot >> SNAPSHOT_PAGE_BITS]
+                                         [slot & (SNAPSHOT_PAGE_SIZE - 1)];
+}
+
+// Appointment record of a slot in the pinned version (NULL if out of range)
+const struct Appointment *snapshotAppointment(const struct SnapshotReader *reader, int slot)
+{
+    if (slot < 0 || slot >= reader->version->maxAppointments)
+    {
+        return NULL;
+    }
+    return &reader->version->appointmentPages[slot >> SNAPSHOT_PAGE_BITS]
+                                             [slot & (SNAPSHOT_PAGE_SIZE - 1)];
+}
+
+// Unpin the version (it may be reclaimed once no reader needs it)
+void snapshotEnd(struct SnapshotReader *reader)
+{
+    if (reader->slot != -1)
+    {
+        atomic_store(&reader->store->readers[reader->slot], 0);
+    }
+    reader->version = NULL;
+    reader->slot = -1;
+}
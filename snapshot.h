@@ -0,0 +1,104 @@
+// SAFE-GUARD:
+// It is good practice to apply safe-guards to header files
+// Safe-guard's ensures only 1 copy of the header file is used in the project build
+// The macro name should be mirroring the file name with _ for spaces, dots, etc.
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+struct Patient;
+struct Appointment;
+
+//////////////////////////////////////
+// Module macro's (usable by any file that includes this header)
+//////////////////////////////////////
+
+// Records per copy-on-write page (a write copies one page, not the store)
+#define SNAPSHOT_PAGE_BITS 10
+#define SNAPSHOT_PAGE_SIZE (1 << SNAPSHOT_PAGE_BITS)
+
+// Readers that may hold a snapshot at the same time
+#define SNAPSHOT_MAX_READERS 64
+
+//////////////////////////////////////
+// Structures
+//////////////////////////////////////
+
+// Data type: one immutable point-in-time version of the patient and appointment stores
+// (pages are shared with the versions before and after it until rewritten)
+struct SnapshotVersion
+{
+    long long version;
+    struct Patient **patientPages;
+    struct Appointment **appointmentPages;
+    int maxPatient;
+    int maxAppointments;
+    void *replacedPage;  // page of this version the next one rewrote (freed with it)
+    int ownsPages;       // every page is freed with this version (superseded by a reload)
+    long long retiredAt; // epoch when the next version replaced it
+    struct SnapshotVersion *nextRetired;
+};
+
+// Data type: versioned copy of a clinic's stores for readers that must not take its lock
+// (writers publish every change; old versions are reclaimed by epoch)
+struct SnapshotStore
+{
+    struct SnapshotVersion *_Atomic current;
+    atomic_llong epoch;
+    atomic_llong readers[SNAPSHOT_MAX_READERS]; // epoch each reader entered at (0: free)
+    pthread_mutex_t writeLock;                  // writers publish one at a time
+    struct SnapshotVersion *retired;            // replaced versions, oldest first
+    struct SnapshotVersion *retiredTail;
+};
+
+// Data type: a reader's pinned version (valid until snapshotEnd)
+struct SnapshotReader
+{
+    struct SnapshotStore *store;
+    const struct SnapshotVersion *version;
+    int slot;
+};
+
+//////////////////////////////////////
+// WRITER FUNCTIONS
+//////////////////////////////////////
+
+// Set up an empty store (returns 1 on success)
+int snapshotInit(struct SnapshotStore *store);
+
+// Publish a full copy of the stores, e.g. after an import (returns 0 when out of memory)
+int snapshotLoad(struct SnapshotStore *store, const struct Patient *patients, int maxPatient,
+                 const struct Appointment *appoints, int maxAppointments);
+
+// Publish a new version with one patient slot rewritten
+// (returns 0 if the slot is out of range or memory ran out)
+int snapshotSetPatient(struct SnapshotStore *store, int slot, const struct Patient *patient);
+
+// Publish a new version with one appointment slot rewritten
+// (returns 0 if the slot is out of range or memory ran out)
+int snapshotSetAppointment(struct SnapshotStore *store, int slot,
+                           const struct Appointment *appoint);
+
+// Release every version (no reader may hold one)
+void snapshotFree(struct SnapshotStore *store);
+
+//////////////////////////////////////
+// READER FUNCTIONS
+//////////////////////////////////////
+
+// Pin the current version: it stays readable and unchanged until snapshotEnd
+// (returns 0 if nothing was published yet or every reader slot is taken)
+int snapshotBegin(struct SnapshotStore *store, struct SnapshotReader *reader);
+
+// Patient record of a slot in the pinned version (NULL if out of range)
+const struct Patient *snapshotPatient(const struct SnapshotReader *reader, int slot);
+
+// Appointment record of a slot in the pinned version (NULL if out of range)
+const struct Appointment *snapshotAppointment(const struct SnapshotReader *reader, int slot);
+
+// Unpin the version (it may be reclaimed once no reader needs it)
+void snapshotEnd(struct SnapshotReader *reader);
+
+#endif // !SNAPSHOT_H
@@ -0,0 +1,410 @@
+#include <stdlib.h>
+#include <string.h>
+
+// include the user library "stats" where the function prototypes are declared
+#include "stats.h"
+
+//////////////////////////////////////
+// COUNTER TABLES
+//////////////////////////////////////
+
+// Bucket a key hashes to
+static int bucketOf(int key, int mask)
+{
+    return (int)((unsigned int)key * 2654435761u) & mask;
+}
+
+// Find a key's counter (returns NULL if the key was never counted)
+static struct StatsCounter *findCounter(const struct StatsTable *table, int key)
+{
+    int b;
+
+    if (table->items == NULL)
+    {
+        return NULL;
+    }
+    for (b = bucketOf(key, table->mask); table->items[b].used; b = (b + 1) & table->mask)
+    {
+        if (table->items[b].key == key)
+        {
+            return &table->items[b];
+        }
+    }
+    return NULL;
+}
+
+// Find or add a key's counter (returns NULL on allocation failure)
+static struct StatsCounter *addCounter(struct StatsTable *table, int key)
+{
+    struct StatsCounter *counter = findCounter(table, key);
+    int b, i;
+
+    if (counter != NULL)
+    {
+        return counter;
+    }
+
+    // Keep the table at most 3/4 full
+    if (table->items == NULL || (table->used + 1) * 4 > (table->mask + 1) * 3)
+    {
+        struct StatsCounter *old = table->items;
+        int oldSize = old ? table->mask + 1 : 0;
+        int size = oldSize ? oldSize * 2 : 64;
+
+        table->items = calloc(size, sizeof(*table->items));
+        if (table->items == NULL)
+        {
+            table->items = old;
+            return NULL;
+        }
+        table->mask = size - 1;
+        for (i = 0; i < oldSize; i++)
+        {
+            if (old[i].used)
+            {
+                for (b = bucketOf(old[i].key, table->mask); table->items[b].used;
+                     b = (b + 1) & table->mask)
+                {
+                    ; // linear probe
+                }
+                table->items[b] = old[i];
+            }
+        }
+        free(old);
+    }
+
+    for (b = bucketOf(key, table->mask); table->items[b].used; b = (b + 1) & table->mask)
+    {
+        ; // linear probe
+    }
+    table->items[b].key = key;
+    table->items[b].count = 0;
+    table->items[b].used = 1;
+    table->used++;
+    return &table->items[b];
+}
+
+//////////////////////////////////////
+// DAY COUNTS
+//////////////////////////////////////
+
+// Entry of a day (returns -1 if the day was never booked)
+static int findDay(const struct ClinicStats *stats, int day)
+{
+    int b;
+
+    if (stats->dayIndex == NULL)
+    {
+        return -1;
+    }
+    for (b = bucketOf(day, stats->dayIndexMask); stats->dayIndex[b];
+         b = (b + 1) & stats->dayIndexMask)
+    {
+        if (stats->days[stats->dayIndex[b] - 1].day == day)
+        {
+            return stats->dayIndex[b] - 1;
+        }
+    }
+    return -1;
+}
+
+// Find or add a day's entry (returns -1 on allocation failure)
+static int addDay(struct ClinicStats *stats, int day)
+{
+    int entry = findDay(stats, day), b, i;
+
+    if (entry != -1)
+    {
+        return entry;
+    }
+
+    if (stats->dayCount == stats->dayCapacity)
+    {
+        int capacity = stats->dayCapacity ? stats->dayCapacity * 2 : 64;
+        struct StatsDay *grown = realloc(stats->days, sizeof(*grown) * capacity);
+
+        if (grown == NULL)
+        {
+            return -1;
+        }
+        stats->days = grown;
+        stats->dayCapacity = capacity;
+    }
+
+    // The index is rebuilt from the entries when it passes 3/4 full
+    if (stats->dayIndex == NULL || (stats->dayCount + 1) * 4 > (stats->dayIndexMask + 1) * 3)
+    {
+        int size = stats->dayIndex ? (stats->dayIndexMask + 1) * 2 : 128;
+        int *index = calloc(size, sizeof(*index));
+
+        if (index == NULL)
+        {
+            return -1;
+        }
+        free(stats->dayIndex);
+        stats->dayIndex = index;
+        stats->dayIndexMask = size - 1;
+        for (i = 0; i < stats->dayCount; i++)
+        {
+            for (b = bucketOf(stats->days[i].day, stats->dayIndexMask); index[b];
+                 b = (b + 1) & stats->dayIndexMask)
+            {
+                ; // linear probe
+            }
+            index[b] = i + 1;
+        }
+    }
+
+    entry = stats->dayCount++;
+    stats->days[entry].day = day;
+    stats->days[entry].count = 0;
+    stats->days[entry].prev = -1;
+    stats->days[entry].next = -1;
+    for (b = bucketOf(day, stats->dayIndexMask); stats->dayIndex[b];
+         b = (b + 1) & stats->dayIndexMask)
+    {
+        ; // linear probe
+    }
+    stats->dayIndex[b] = entry + 1;
+    return entry;
+}
+
+// Take a day out of its count's list
+static void unlinkDay(struct ClinicStats *stats, int entry)
+{
+    struct StatsDay *day = &stats->days[entry];
+
+    if (day->prev != -1)
+    {
+        stats->days[day->prev].next = day->next;
+    }
+    else if (day->count > 0)
+    {
+        stats->countHeads[day->count] = day->next;
+    }
+    if (day->next != -1)
+    {
+        stats->days[day->next].prev = day->prev;
+    }
+    day->prev = -1;
+    day->next = -1;
+}
+
+// Put a day at the front of its count's list (days with no bookings are in no list)
+static void linkDay(struct ClinicStats *stats, int entry)
+{
+    struct StatsDay *day = &stats->days[entry];
+
+    if (day->count == 0)
+    {
+        return;
+    }
+    day->next = stats->countHeads[day->count];
+    if (day->next != -1)
+    {
+        stats->days[day->next].prev = entry;
+    }
+    stats->countHeads[day->count] = entry;
+}
+
+// Make room for a day with "count" bookings in the count lists (returns 0 on failure)
+static int reserveCount(struct ClinicStats *stats, int count)
+{
+    int capacity = stats->countCapacity ? stats->countCapacity : 64, i;
+    int *grown;
+
+    if (count < stats->countCapacity)
+    {
+        return 1;
+    }
+    while (capacity <= count)
+    {
+        capacity *= 2;
+    }
+    grown = realloc(stats->countHeads, sizeof(*grown) * capacity);
+    if (grown == NULL)
+    {
+        return 0;
+    }
+    for (i = stats->countCapacity; i < capacity; i++)
+    {
+        grown[i] = -1;
+    }
+    stats->countHeads = grown;
+    stats->countCapacity = capacity;
+    return 1;
+}
+
+// Move a day one booking up or down: a booking count only ever changes by one,
+// so the lists are relinked in O(1) and the busiest day stays known
+static void adjustDay(struct ClinicStats *stats, int entry, int delta)
+{
+    struct StatsDay *day = &stats->days[entry];
+
+    unlinkDay(stats, entry);
+    if (day->count == 0 && delta > 0)
+    {
+        stats->busyDays++;
+    }
+    day->count += delta;
+    if (day->count == 0)
+    {
+        stats->busyDays--;
+    }
+    linkDay(stats, entry);
+
+    if (day->count > stats->maxCount)
+    {
+        stats->maxCount = day->count;
+    }
+    while (stats->maxCount > 0 && stats->countHeads[stats->maxCount] == -1)
+    {
+        stats->maxCount--;
+    }
+}
+
+//////////////////////////////////////
+// STATS FUNCTIONS
+//////////////////////////////////////
+
+// Count a booking of "slots" grid slots from "firstSlot" (-1: off the grid)
+// (returns 0 if it could not be counted for lack of memory)
+int statsAdd(struct ClinicStats *stats, int patientNumber, int day, int month,
+             int firstSlot, int slots)
+{
+    struct StatsCounter *monthCounter, *patientCounter;
+    int entry, slot;
+
+    // Every table is grown before any count changes, so a failure leaves
+    // the aggregates consistent
+    entry = addDay(stats, day);
+    monthCounter = addCounter(&stats->months, month);
+    patientCounter = addCounter(&stats->patients, patientNumber);
+    if (entry == -1 || monthCounter == NULL || patientCounter == NULL ||
+        !reserveCount(stats, stats->days[entry].count + 1))
+    {
+        return 0;
+    }
+
+    adjustDay(stats, entry, 1);
+    monthCounter->count++;
+    patientCounter->count++;
+    for (slot = firstSlot; firstSlot != -1 && slot < firstSlot + slots && slot < STATS_MAX_SLOTS;
+         slot++)
+    {
+        stats->slotBookings[slot]++;
+    }
+    stats->bookings++;
+    return 1;
+}
+
+// Uncount a booking added with the same arguments
+void statsRemove(struct ClinicStats *stats, int patientNumber, int day, int month,
+                 int firstSlot, int slots)
+{
+    struct StatsCounter *monthCounter = findCounter(&stats->months, month);
+    struct StatsCounter *patientCounter = findCounter(&stats->patients, patientNumber);
+    int entry = findDay(stats, day), slot;
+
+    if (entry == -1 || stats->days[entry].count == 0)
+    {
+        return;
+    }
+    adjustDay(stats, entry, -1);
+    if (monthCounter != NULL && monthCounter->count > 0)
+    {
+        monthCounter->count--;
+    }
+    if (patientCounter != NULL && patientCounter->count > 0)
+    {
+        patientCounter->count--;
+    }
+    for (slot = firstSlot; firstSlot != -1 && slot < firstSlot + slots && slot < STATS_MAX_SLOTS;
+         slot++)
+    {
+        stats->slotBookings[slot]--;
+    }
+    stats->bookings--;
+}
+
+// Bookings on a day
+int statsDayCount(const struct ClinicStats *stats, int day)
+{
+    int entry = findDay(stats, day);
+
+    return entry == -1 ? 0 : stats->days[entry].count;
+}
+
+// Bookings in a month (see STATS_MONTH)
+int statsMonthCount(const struct ClinicStats *stats, int month)
+{
+    const struct StatsCounter *counter = findCounter(&stats->months, month);
+
+    return counter == NULL ? 0 : counter->count;
+}
+
+// Bookings of a patient
+int statsPatientCount(const struct ClinicStats *stats, int patientNumber)
+{
+    const struct StatsCounter *counter = findCounter(&stats->patients, patientNumber);
+
+    return counter == NULL ? 0 : counter->count;
+}
+
+// Copy the busiest "max" days, most bookings first (returns the number copied)
+int statsTopDays(const struct ClinicStats *stats, int days[], int counts[], int max)
+{
+    int count, entry, copied = 0;
+
+    for (count = stats->maxCount; count > 0 && copied < max; count--)
+    {
+        for (entry = stats->countHeads[count]; entry != -1 && copied < max;
+             entry = stats->days[entry].next)
+        {
+            days[copied] = stats->days[entry].day;
+            counts[copied++] = count;
+        }
+    }
+    return copied;
+}
+
+// Copy up to "max" booked months in month order with their counts (returns the number copied)
+int statsMonths(const struct ClinicStats *stats, int months[], int counts[], int max)
+{
+    int i, k, copied = 0, month, count;
+
+    // Insertion into month order: a clinic has few distinct months
+    for (i = 0; stats->months.items != NULL && i <= stats->months.mask; i++)
+    {
+        if (!stats->months.items[i].used || stats->months.items[i].count == 0)
+        {
+            continue;
+        }
+        month = stats->months.items[i].key;
+        count = stats->months.items[i].count;
+        if (copied == max && (max == 0 || months[max - 1] < month))
+        {
+            continue;
+        }
+        k = copied < max ? copied++ : max - 1;
+        for (; k > 0 && months[k - 1] > month; k--)
+        {
+            months[k] = months[k - 1];
+            counts[k] = counts[k - 1];
+        }
+        months[k] = month;
+        counts[k] = count;
+    }
+    return copied;
+}
+
+// Release the aggregates (everything reads as zero afterwards)
+void statsFree(struct ClinicStats *stats)
+{
+    free(stats->days);
+    free(stats->dayIndex);
+    free(stats->countHeads);
+    free(stats->months.items);
+    free(stats->patients.items);
+    memset(stats, 0, sizeof(*stats));
+}
@@ -0,0 +1,96 @@
+// SAFE-GUARD:
+// It is good practice to apply safe-guards to header files
+// Safe-guard's ensures only 1 copy of the header file is used in the project build
+// The macro name should be mirroring the file name with _ for spaces, dots, etc.
+#ifndef STATS_H
+#define STATS_H
+
+//////////////////////////////////////
+// Module macro's (usable by any file that includes this header)
+//////////////////////////////////////
+
+// Grid slots counted per day (matches CALENDAR_MAX_SLOTS)
+#define STATS_MAX_SLOTS 32
+
+// Month key of a year and month (1..12)
+#define STATS_MONTH(year, month) ((year) * 12 + (month) - 1)
+
+//////////////////////////////////////
+// Structures
+//////////////////////////////////////
+
+// Data type: bookings counted under one key
+struct StatsCounter
+{
+    int key;
+    int count;
+    int used;
+};
+
+// Data type: open-addressing table of counters
+struct StatsTable
+{
+    struct StatsCounter *items;
+    int mask;
+    int used;
+};
+
+// Data type: one day's booking count, linked into the list of days with the same count
+struct StatsDay
+{
+    int day; // day number (days since 1970-01-01)
+    int count;
+    int prev; // neighbours in the count's list (-1: none)
+    int next;
+};
+
+// Data type: booking aggregates kept up to date on every booking and cancellation
+struct ClinicStats
+{
+    struct StatsDay *days; // entries never move once added
+    int dayCount;
+    int dayCapacity;
+    int *dayIndex;          // open-addressing table: day number -> entry + 1 (0: empty)
+    int dayIndexMask;
+    int *countHeads;        // first day entry with each booking count (-1: none)
+    int countCapacity;
+    int maxCount;           // highest booking count of any day
+    struct StatsTable months;
+    struct StatsTable patients;
+    long long slotBookings[STATS_MAX_SLOTS]; // bookings holding each grid slot
+    long long bookings;
+    int busyDays; // days with at least one booking
+};
+
+//////////////////////////////////////
+// STATS FUNCTIONS
+//////////////////////////////////////
+
+// Count a booking of "slots" grid slots from "firstSlot" (-1: off the grid)
+// (returns 0 if it could not be counted for lack of memory)
+int statsAdd(struct ClinicStats *stats, int patientNumber, int day, int month,
+             int firstSlot, int slots);
+
+// Uncount a booking added with the same arguments
+void statsRemove(struct ClinicStats *stats, int patientNumber, int day, int month,
+                 int firstSlot, int slots);
+
+// Bookings on a day
+int statsDayCount(const struct ClinicStats *stats, int day);
+
+// Bookings in a month (see STATS_MONTH)
+int statsMonthCount(const struct ClinicStats *stats, int month);
+
+// Bookings of a patient
+int statsPatientCount(const struct ClinicStats *stats, int patientNumber);
+
+// Copy the busiest "max" days, most bookings first (returns the number copied)
+int statsTopDays(const struct ClinicStats *stats, int days[], int counts[], int max);
+
+// Copy up to "max" booked months in month order with their counts (returns the number copied)
+int statsMonths(const struct ClinicStats *stats, int months[], int counts[], int max);
+
+// Release the aggregates (everything reads as zero afterwards)
+void statsFree(struct ClinicStats *stats);
+
+#endif // !STATS_H
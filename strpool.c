@@ -0,0 +1,218 @@
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+// include the user library "pool" for the arena that holds the text
+#include "pool.h"
+// include the user library "strpool" where the function prototypes are declared
+#include "strpool.h"
+
+//////////////////////////////////////
+// Internal structures
+//////////////////////////////////////
+
+#define PAGE_SIZE (1u << STRPOOL_PAGE_BITS)
+
+// One stripe: an open-addressing table of ids whose text hashes here
+struct Stripe
+{
+    pthread_mutex_t lock;
+    unsigned int *ids;     // 0 marks an empty bucket
+    unsigned int *hashes;  // full hash of each bucket's string
+    unsigned int mask;
+    unsigned int count;
+    struct Arena text;
+};
+
+static struct Stripe stripes[STRPOOL_STRIPES];
+// Id -> text pages: written under idLock, read without a lock, so a page and
+// each entry are published with release stores and read with acquire loads
+static const char *_Atomic *_Atomic pages[STRPOOL_MAX_PAGES];
+static unsigned int nextId = 1;
+static pthread_mutex_t idLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t poolOnce = PTHREAD_ONCE_INIT;
+
+//////////////////////////////////////
+// HELPERS
+//////////////////////////////////////
+
+static void initPool(void)
+{
+    int i;
+
+    for (i = 0; i < STRPOOL_STRIPES; i++)
+    {
+        pthread_mutex_init(&stripes[i].lock, NULL);
+    }
+}
+
+// FNV-1a
+static unsigned int hashText(const char *text)
+{
+    unsigned int hash = 2166136261u;
+
+    while (*text)
+    {
+        hash = (hash ^ (unsigned char)*text++) * 16777619u;
+    }
+    return hash;
+}
+
+// Publish a new id for the text (returns 0 when the id space is exhausted)
+static unsigned int assignId(const char *text)
+{
+    const char *_Atomic *entries;
+    unsigned int id, page;
+
+    pthread_mutex_lock(&idLock);
+    id = nextId;
+    page = id >> STRPOOL_PAGE_BITS;
+    if (page >= STRPOOL_MAX_PAGES)
+    {
+        pthread_mutex_unlock(&idLock);
+        return 0;
+    }
+    entries = atomic_load_explicit(&pages[page], memory_order_relaxed);
+    if (entries == NULL)
+    {
+        entries = calloc(PAGE_SIZE, sizeof(*entries));
+        if (entries == NULL)
+        {
+            pthread_mutex_unlock(&idLock);
+            return 0;
+        }
+        atomic_store_explicit(&pages[page], entries, memory_order_release);
+    }
+    atomic_store_explicit(&entries[id & (PAGE_SIZE - 1)], text, memory_order_release);
+    nextId++;
+    pthread_mutex_unlock(&idLock);
+    return id;
+}
+
+// Double a stripe's table (returns 0 on allocation failure)
+static int growStripe(struct Stripe *stripe)
+{
+    unsigned int newMask = stripe->mask ? stripe->mask * 2 + 1 : 63;
+    unsigned int *ids = calloc(newMask + 1, sizeof(unsigned int));
+    unsigned int *hashes = calloc(newMask + 1, sizeof(unsigned int));
+    unsigned int i, b;
+
+    if (ids == NULL || hashes == NULL)
+    {
+        free(ids);
+        free(hashes);
+        return 0;
+    }
+    for (i = 0; stripe->ids != NULL && i <= stripe->mask; i++)
+    {
+        if (stripe->ids[i])
+        {
+            for (b = stripe->hashes[i] & newMask; ids[b]; b = (b + 1) & newMask)
+            {
+                ; // linear probe
+            }
+            ids[b] = stripe->ids[i];
+            hashes[b] = stripe->hashes[i];
+        }
+    }
+    free(stripe->ids);
+    free(stripe->hashes);
+    stripe->ids = ids;
+    stripe->hashes = hashes;
+    stripe->mask = newMask;
+    return 1;
+}
+
+//////////////////////////////////////
+// STRING POOL FUNCTIONS
+//////////////////////////////////////
+
+// Intern a string (returns its id, equal strings always share one id)
+unsigned int internString(const char *text)
+{
+    struct Stripe *stripe;
+    unsigned int hash, b, id = STRPOOL_EMPTY;
+    size_t len;
+    char *copy;
+
+    if (text == NULL || text[0] == '\0')
+    {
+        return STRPOOL_EMPTY;
+    }
+    pthread_once(&poolOnce, initPool);
+
+    hash = hashText(text);
+    stripe = &stripes[hash % STRPOOL_STRIPES];
+    pthread_mutex_lock(&stripe->lock);
+
+    if ((stripe->count + 1) * 4 > stripe->mask * 3 && !growStripe(stripe))
+    {
+        pthread_mutex_unlock(&stripe->lock);
+        return STRPOOL_EMPTY;
+    }
+    for (b = hash & stripe->mask; stripe->ids[b]; b = (b + 1) & stripe->mask)
+    {
+        if (stripe->hashes[b] == hash && strcmp(internedString(stripe->ids[b]), text) == 0)
+        {
+            id = stripe->ids[b];
+            break;
+        }
+    }
+
+    if (id == STRPOOL_EMPTY)
+    {
+        len = strlen(text);
+        copy = arenaAlloc(&stripe->text, len + 1);
+        if (copy != NULL)
+        {
+            memcpy(copy, text, len + 1);
+            id = assignId(copy);
+        }
+        if (id != STRPOOL_EMPTY)
+        {
+            stripe->ids[b] = id;
+            stripe->hashes[b] = hash;
+            stripe->count++;
+        }
+    }
+
+    pthread_mutex_unlock(&stripe->lock);
+    return id;
+}
+
+// Text of an interned string ("" for STRPOOL_EMPTY or an unknown id)
+const char *internedString(unsigned int id)
+{
+    const char *_Atomic *page;
+    const char *text;
+
+    if (id == STRPOOL_EMPTY || (id >> STRPOOL_PAGE_BITS) >= STRPOOL_MAX_PAGES)
+    {
+        return "";
+    }
+    page = atomic_load_explicit(&pages[id >> STRPOOL_PAGE_BITS], memory_order_acquire);
+    if (page == NULL)
+    {
+        return "";
+    }
+    text = atomic_load_explicit(&page[id & (PAGE_SIZE - 1)], memory_order_acquire);
+    return text != NULL ? text : "";
+}
+
+// Number of distinct strings and bytes of text held by the pool
+void internStats(unsigned int *strings, size_t *bytes)
+{
+    int i;
+
+    pthread_once(&poolOnce, initPool);
+    *strings = 0;
+    *bytes = 0;
+    for (i = 0; i < STRPOOL_STRIPES; i++)
+    {
+        pthread_mutex_lock(&stripes[i].lock);
+        *strings += stripes[i].count;
+        *bytes += stripes[i].text.requested;
+        pthread_mutex_unlock(&stripes[i].lock);
+    }
+}
@@ -0,0 +1,41 @@
+// SAFE-GUARD:
+// It is good practice to apply safe-guards to header files
+// Safe-guard's ensures only 1 copy of the header file is used in the project build
+// The macro name should be mirroring the file name with _ for spaces, dots, etc.
+#ifndef STRPOOL_H
+#define STRPOOL_H
+
+#include <stddef.h>
+
+//////////////////////////////////////
+// Module macro's (usable by any file that includes this header)
+//////////////////////////////////////
+
+// Independent hash stripes (interning threads only contend within a stripe)
+#define STRPOOL_STRIPES 64
+
+// Id -> string lookup pages
+#define STRPOOL_PAGE_BITS 12
+#define STRPOOL_MAX_PAGES 65536
+
+// Id of the empty string
+#define STRPOOL_EMPTY 0
+
+//////////////////////////////////////
+// STRING POOL FUNCTIONS
+//////////////////////////////////////
+//
+// The pool is shared by the whole process and strings are never freed, so an
+// id stays valid (and its text never moves) for the life of the program.
+// Interning is thread-safe; resolving an id takes no lock.
+
+// Intern a string (returns its id, equal strings always share one id)
+unsigned int internString(const char *text);
+
+// Text of an interned string ("" for STRPOOL_EMPTY or an unknown id)
+const char *internedString(unsigned int id);
+
+// Number of distinct strings and bytes of text held by the pool
+void internStats(unsigned int *strings, size_t *bytes);
+
+#endif // !STRPOOL_H
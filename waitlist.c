@@ -0,0 +1,240 @@
+#include <stdlib.h>
+#include <string.h>
+
+// include the user library "waitlist" where the function prototypes are declared
+#include "waitlist.h"
+
+//////////////////////////////////////
+// HELPERS
+//////////////////////////////////////
+
+// Bucket a day number hashes to
+static int bucketOf(int day, int mask)
+{
+    return (int)((unsigned int)day * 2654435761u) & mask;
+}
+
+// Check if waiter "a" is served before waiter "b" (urgency, then request order)
+static int servedBefore(const struct Waiter *a, const struct Waiter *b)
+{
+    if (a->urgency != b->urgency)
+    {
+        return a->urgency > b->urgency;
+    }
+    return a->sequence < b->sequence;
+}
+
+// Entry of a day (returns -1 if the day never had waiters)
+static int findDay(const struct Waitlist *list, int day)
+{
+    int b;
+
+    if (list->dayIndex == NULL)
+    {
+        return -1;
+    }
+    for (b = bucketOf(day, list->dayIndexMask); list->dayIndex[b];
+         b = (b + 1) & list->dayIndexMask)
+    {
+        if (list->days[list->dayIndex[b] - 1].day == day)
+        {
+            return list->dayIndex[b] - 1;
+        }
+    }
+    return -1;
+}
+
+// Find or add a day's entry (returns -1 on allocation failure)
+static int addDay(struct Waitlist *list, int day)
+{
+    int entry = findDay(list, day), b, i;
+
+    if (entry != -1)
+    {
+        return entry;
+    }
+
+    if (list->dayCount == list->dayCapacity)
+    {
+        int capacity = list->dayCapacity ? list->dayCapacity * 2 : 16;
+        struct WaitDay *grown = realloc(list->days, sizeof(*grown) * capacity);
+
+        if (grown == NULL)
+        {
+            return -1;
+        }
+        list->days = grown;
+        list->dayCapacity = capacity;
+    }
+
+    // The index is rebuilt from the entries when it passes 3/4 full
+    if (list->dayIndex == NULL || (list->dayCount + 1) * 4 > (list->dayIndexMask + 1) * 3)
+    {
+        int size = list->dayIndex ? (list->dayIndexMask + 1) * 2 : 32;
+        int *index = calloc(size, sizeof(*index));
+
+        if (index == NULL)
+        {
+            return -1;
+        }
+        free(list->dayIndex);
+        list->dayIndex = index;
+        list->dayIndexMask = size - 1;
+        for (i = 0; i < list->dayCount; i++)
+        {
+            for (b = bucketOf(list->days[i].day, list->dayIndexMask); index[b];
+                 b = (b + 1) & list->dayIndexMask)
+            {
+                ; // linear probe
+            }
+            index[b] = i + 1;
+        }
+    }
+
+    entry = list->dayCount++;
+    memset(&list->days[entry], 0, sizeof(list->days[entry]));
+    list->days[entry].day = day;
+    for (b = bucketOf(day, list->dayIndexMask); list->dayIndex[b];
+         b = (b + 1) & list->dayIndexMask)
+    {
+        ; // linear probe
+    }
+    list->dayIndex[b] = entry + 1;
+    return entry;
+}
+
+//////////////////////////////////////
+// WAITLIST FUNCTIONS
+//////////////////////////////////////
+
+// Queue a request for a day (returns the number now waiting for the day,
+// 0 if it could not be queued for lack of memory)
+int waitlistAdd(struct Waitlist *list, int day, int patientNumber, int urgency)
+{
+    struct WaitDay *wait;
+    struct Waiter waiter;
+    int entry = addDay(list, day), at, parent;
+
+    if (entry == -1)
+    {
+        return 0;
+    }
+    wait = &list->days[entry];
+    if (wait->count == wait->capacity)
+    {
+        int capacity = wait->capacity ? wait->capacity * 2 : 8;
+        struct Waiter *grown = realloc(wait->heap, sizeof(*grown) * capacity);
+
+        if (grown == NULL)
+        {
+            return 0;
+        }
+        wait->heap = grown;
+        wait->capacity = capacity;
+    }
+
+    waiter.patientNumber = patientNumber;
+    waiter.urgency = urgency;
+    waiter.sequence = list->nextSequence++;
+
+    // Sift up from the new leaf
+    for (at = wait->count++; at > 0; at = parent)
+    {
+        parent = (at - 1) / 2;
+        if (!servedBefore(&waiter, &wait->heap[parent]))
+        {
+            break;
+        }
+        wait->heap[at] = wait->heap[parent];
+    }
+    wait->heap[at] = waiter;
+    list->waiting++;
+    return wait->count;
+}
+
+// Copy the day's next waiter without removing it (returns 0 if nobody is waiting)
+int waitlistPeek(const struct Waitlist *list, int day, struct Waiter *waiter)
+{
+    int entry = findDay(list, day);
+
+    if (entry == -1 || list->days[entry].count == 0)
+    {
+        return 0;
+    }
+    *waiter = list->days[entry].heap[0];
+    return 1;
+}
+
+// Remove the day's next waiter (returns 0 if nobody is waiting)
+int waitlistPop(struct Waitlist *list, int day, struct Waiter *waiter)
+{
+    struct WaitDay *wait;
+    struct Waiter last;
+    int entry = findDay(list, day), at, child;
+
+    if (entry == -1 || list->days[entry].count == 0)
+    {
+        return 0;
+    }
+    wait = &list->days[entry];
+    *waiter = wait->heap[0];
+    last = wait->heap[--wait->count];
+
+    // Sift the last leaf down from the root
+    for (at = 0; (child = at * 2 + 1) < wait->count; at = child)
+    {
+        if (child + 1 < wait->count && servedBefore(&wait->heap[child + 1], &wait->heap[child]))
+        {
+            child++;
+        }
+        if (!servedBefore(&wait->heap[child], &last))
+        {
+            break;
+        }
+        wait->heap[at] = wait->heap[child];
+    }
+    wait->heap[at] = last;
+    list->waiting--;
+    return 1;
+}
+
+// Number of waiters for a day
+int waitlistCount(const struct Waitlist *list, int day)
+{
+    int entry = findDay(list, day);
+
+    return entry == -1 ? 0 : list->days[entry].count;
+}
+
+// Copy up to "max" day numbers that have waiters (returns the total)
+int waitlistDays(const struct Waitlist *list, int days[], int max)
+{
+    int i, total = 0;
+
+    for (i = 0; i < list->dayCount; i++)
+    {
+        if (list->days[i].count > 0)
+        {
+            if (total < max)
+            {
+                days[total] = list->days[i].day;
+            }
+            total++;
+        }
+    }
+    return total;
+}
+
+// Release the waitlists
+void waitlistFree(struct Waitlist *list)
+{
+    int i;
+
+    for (i = 0; i < list->dayCount; i++)
+    {
+        free(list->days[i].heap);
+    }
+    free(list->days);
+    free(list->dayIndex);
+    memset(list, 0, sizeof(*list));
+}
@@ -0,0 +1,72 @@
+// SAFE-GUARD:
+// It is good practice to apply safe-guards to header files
+// Safe-guard's ensures only 1 copy of the header file is used in the project build
+// The macro name should be mirroring the file name with _ for spaces, dots, etc.
+#ifndef WAITLIST_H
+#define WAITLIST_H
+
+//////////////////////////////////////
+// Module macro's (usable by any file that includes this header)
+//////////////////////////////////////
+
+// Waiter urgency (a higher urgency is served first)
+#define WAITLIST_ROUTINE 1
+#define WAITLIST_URGENT 3
+
+//////////////////////////////////////
+// Structures
+//////////////////////////////////////
+
+// Data type: a request waiting for a slot on a fully booked day
+struct Waiter
+{
+    int patientNumber;
+    int urgency;        // WAITLIST_ROUTINE .. WAITLIST_URGENT
+    long long sequence; // request order (earlier requests are served first)
+};
+
+// Data type: one day's waiters, a binary heap with the next one to serve on top
+struct WaitDay
+{
+    int day; // day number (days since 1970-01-01)
+    struct Waiter *heap;
+    int count;
+    int capacity;
+};
+
+// Data type: per-day waitlists
+struct Waitlist
+{
+    struct WaitDay *days; // entries never move once added
+    int dayCount;
+    int dayCapacity;
+    int *dayIndex;        // open-addressing table: day number -> entry + 1 (0: empty)
+    int dayIndexMask;
+    long long nextSequence;
+    int waiting;          // waiters on every day
+};
+
+//////////////////////////////////////
+// WAITLIST FUNCTIONS
+//////////////////////////////////////
+
+// Queue a request for a day (returns the number now waiting for the day,
+// 0 if it could not be queued for lack of memory)
+int waitlistAdd(struct Waitlist *list, int day, int patientNumber, int urgency);
+
+// Copy the day's next waiter without removing it (returns 0 if nobody is waiting)
+int waitlistPeek(const struct Waitlist *list, int day, struct Waiter *waiter);
+
+// Remove the day's next waiter (returns 0 if nobody is waiting)
+int waitlistPop(struct Waitlist *list, int day, struct Waiter *waiter);
+
+// Number of waiters for a day
+int waitlistCount(const struct Waitlist *list, int day);
+
+// Copy up to "max" day numbers that have waiters (returns the total)
+int waitlistDays(const struct Waitlist *list, int days[], int max);
+
+// Release the waitlists
+void waitlistFree(struct Waitlist *list);
+
+#endif // !WAITLIST_H